@@ -16,13 +16,22 @@
 # of the GNU-based Makefiles to be shared between operating systems.
 # The values currently accepted are "BeOS", "Unix", and "MacOSX".
 
+# On Unix, the variable WINSYS selects the window system:  "X11", or
+# "EGL" to render into EGL pbuffers without any display.
+
 # Major configuration options:
 #PLATFORM:=BeOS
 #PLATFORM:=MacOSX
 PLATFORM:=Unix
+WINSYS:=X11
+#WINSYS:=EGL
 
 ifeq ($(PLATFORM), Unix)
+ifeq ($(WINSYS), EGL)
+	CONFIG:=-D__UNIX__ -D__EGL__
+else
 	CONFIG:=-D__UNIX__ -D__X11__
+endif # EGL
 else
 ifeq ($(PLATFORM), BeOS)
 	CONFIG:=-D__UNIX__ -D__BEWIN__
@@ -0,0 +1,238 @@
+// BEGIN_COPYRIGHT -*- glean -*-
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+// binresults.cpp:  binary results files
+
+#include <cstdio>
+#include <cstring>
+#include "dsconfig.h"
+#include "binresults.h"
+
+#if defined(__UNIX__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+namespace GLEAN {
+
+namespace {
+
+const char magic[] = "GLEANRES";
+const unsigned int magicSize = 8;
+const unsigned int version = 1;
+const unsigned int headerSize = magicSize + 4 * 4;
+
+void
+putWord(string& s, unsigned int w) {
+	s += static_cast<char>(w & 0xFF);
+	s += static_cast<char>((w >> 8) & 0xFF);
+	s += static_cast<char>((w >> 16) & 0xFF);
+	s += static_cast<char>((w >> 24) & 0xFF);
+}
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// BinaryResultsWriter
+///////////////////////////////////////////////////////////////////////////////
+BinaryResultsWriter::BinaryResultsWriter(const string& name):
+    fileName(name) {
+} // BinaryResultsWriter::BinaryResultsWriter
+
+void
+BinaryResultsWriter::add(const string& configDesc, const string& results) {
+	map<string, unsigned int>::iterator p = configIndex.find(configDesc);
+	if (p == configIndex.end()) {
+		p = configIndex.insert(make_pair(configDesc,
+			static_cast<unsigned int>(configs.size()))).first;
+		configs.push_back(&p->first);
+	}
+	recordConfig.push_back(p->second);
+	recordData.push_back(results);
+} // BinaryResultsWriter::add
+
+void
+BinaryResultsWriter::close() {
+	// Tables first, with offsets into the string data that follows:
+	string tables;
+	unsigned int offset = headerSize + 8 * configs.size()
+		+ 12 * recordData.size();
+	for (size_t i = 0; i < configs.size(); ++i) {
+		putWord(tables, offset);
+		putWord(tables, configs[i]->size());
+		offset += configs[i]->size();
+	}
+	for (size_t i = 0; i < recordData.size(); ++i) {
+		putWord(tables, recordConfig[i]);
+		putWord(tables, offset);
+		putWord(tables, recordData[i].size());
+		offset += recordData[i].size();
+	}
+
+	string header(magic, magicSize);
+	putWord(header, version);
+	putWord(header, configs.size());
+	putWord(header, recordData.size());
+	putWord(header, 0);
+
+	FILE* f = fopen(fileName.c_str(), "wb");
+	if (!f)
+		throw CantWrite();
+	bool ok = fwrite(header.data(), 1, header.size(), f) == header.size()
+		&& fwrite(tables.data(), 1, tables.size(), f) == tables.size();
+	for (size_t i = 0; ok && i < configs.size(); ++i)
+		ok = fwrite(configs[i]->data(), 1, configs[i]->size(), f)
+			== configs[i]->size();
+	for (size_t i = 0; ok && i < recordData.size(); ++i)
+		ok = fwrite(recordData[i].data(), 1, recordData[i].size(), f)
+			== recordData[i].size();
+	if (fclose(f) || !ok)
+		throw CantWrite();
+} // BinaryResultsWriter::close
+
+///////////////////////////////////////////////////////////////////////////////
+// BinaryResultsReader
+///////////////////////////////////////////////////////////////////////////////
+BinaryResultsReader::BinaryResultsReader(const string& fileName) {
+	base = 0;
+	size = 0;
+
+#if defined(__UNIX__)
+	int fd = open(fileName.c_str(), O_RDONLY);
+	if (fd < 0)
+		throw BadFile();
+	struct stat st;
+	if (fstat(fd, &st) || st.st_size < static_cast<off_t>(headerSize)) {
+		::close(fd);
+		throw BadFile();
+	}
+	size = st.st_size;
+	void* p = mmap(0, size, PROT_READ, MAP_PRIVATE, fd, 0);
+	::close(fd);
+	if (p == MAP_FAILED)
+		throw BadFile();
+	base = static_cast<const unsigned char*>(p);
+#else
+	FILE* f = fopen(fileName.c_str(), "rb");
+	if (!f)
+		throw BadFile();
+	unsigned char buf[4096];
+	size_t n;
+	while ((n = fread(buf, 1, sizeof(buf), f)) > 0)
+		contents.insert(contents.end(), buf, buf + n);
+	fclose(f);
+	size = contents.size();
+	if (size < headerSize)
+		throw BadFile();
+	base = &contents[0];
+#endif
+
+	try {
+		if (memcmp(base, magic, magicSize)
+		    || word(base + magicSize) != version)
+			throw BadFile();
+		unsigned int nConf = word(base + magicSize + 4);
+		nRecs = word(base + magicSize + 8);
+		if (nConf > size / 8 || static_cast<unsigned int>(nRecs)
+		    > size / 12)
+			throw BadFile();
+		checkRange(headerSize, 8 * nConf);
+		checkRange(headerSize + 8 * nConf, 12 * nRecs);
+		records = base + headerSize + 8 * nConf;
+		for (unsigned int i = 0; i < nConf; ++i)
+			checkRange(word(base + headerSize + 8 * i),
+				word(base + headerSize + 8 * i + 4));
+		for (int i = 0; i < nRecs; ++i) {
+			if (word(records + 12 * i) >= nConf)
+				throw BadFile();
+			checkRange(word(records + 12 * i + 4),
+				word(records + 12 * i + 8));
+		}
+		configs.resize(nConf, 0);
+	}
+	catch (BadFile) {
+#if defined(__UNIX__)
+		munmap(const_cast<unsigned char*>(base), size);
+#endif
+		throw;
+	}
+} // BinaryResultsReader::BinaryResultsReader
+
+BinaryResultsReader::~BinaryResultsReader() {
+#if defined(__UNIX__)
+	munmap(const_cast<unsigned char*>(base), size);
+#endif
+} // BinaryResultsReader::~BinaryResultsReader
+
+bool
+BinaryResultsReader::exists(const string& fileName) {
+	FILE* f = fopen(fileName.c_str(), "rb");
+	if (!f)
+		return false;
+	fclose(f);
+	return true;
+} // BinaryResultsReader::exists
+
+unsigned int
+BinaryResultsReader::word(const unsigned char* p) const {
+	return p[0] | (p[1] << 8) | (p[2] << 16)
+		| (static_cast<unsigned int>(p[3]) << 24);
+} // BinaryResultsReader::word
+
+void
+BinaryResultsReader::checkRange(unsigned int offset, unsigned int length)
+    const {
+	if (offset > size || length > size - offset)
+		throw BadFile();
+} // BinaryResultsReader::checkRange
+
+DrawingSurfaceConfig*
+BinaryResultsReader::config(int i) {
+	if (!configs[i]) {
+		const unsigned char* entry = base + headerSize + 8 * i;
+		string desc(reinterpret_cast<const char*>(base + word(entry)),
+			word(entry + 4));
+		configs[i] = new DrawingSurfaceConfig(desc);
+	}
+	return configs[i];
+} // BinaryResultsReader::config
+
+int
+BinaryResultsReader::recordConfig(int i) const {
+	return word(records + 12 * i);
+} // BinaryResultsReader::recordConfig
+
+const char*
+BinaryResultsReader::recordData(int i, size_t* length) const {
+	*length = word(records + 12 * i + 8);
+	return reinterpret_cast<const char*>(base + word(records + 12 * i + 4));
+} // BinaryResultsReader::recordData
+
+} // namespace GLEAN
@@ -0,0 +1,134 @@
+// BEGIN_COPYRIGHT -*- glean -*-
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+// binresults.h:  binary results files
+
+// A test's results are normally stored as text:  for each result, the
+// canonical description of its drawing surface config on one line,
+// followed by whatever the result's putresults() writes.  Reading that
+// back means re-parsing the config description for every result, which
+// adds up when comparing many large databases.
+//
+// The binary format (selected with --binary) stores each distinct
+// config description once, in a table, and gives every result a fixed
+// size record holding the index of its config and the location of its
+// putresults() text.  A reader maps the file into memory, parses each
+// config once, and hands getresults() a stream over the mapped bytes,
+// so nothing is copied.
+//
+// Layout (all integers are 32-bit little-endian; offsets are from the
+// start of the file):
+//
+//	"GLEANRES"			magic number
+//	version, nConfigs, nRecords, 0	header
+//	nConfigs x {offset, length}	config descriptions
+//	nRecords x {config, offset, length}
+//					result records
+//	string data
+
+#ifndef __binresults_h__
+#define __binresults_h__
+
+#include <map>
+#include <streambuf>
+#include <string>
+#include <vector>
+
+using namespace std;
+
+namespace GLEAN {
+
+class DrawingSurfaceConfig;
+
+class BinaryResultsWriter {
+    public:
+	BinaryResultsWriter(const string& fileName);
+
+	void add(const string& configDesc, const string& results);
+	void close();		// Write the file.  Throws CantWrite.
+
+	struct CantWrite { };
+
+    private:
+	string fileName;
+	map<string, unsigned int> configIndex;
+	vector<const string*> configs;	// Keys of configIndex, in order
+	vector<unsigned int> recordConfig;
+	vector<string> recordData;
+}; // class BinaryResultsWriter
+
+class BinaryResultsReader {
+    public:
+	BinaryResultsReader(const string& fileName);
+	~BinaryResultsReader();
+
+	static bool exists(const string& fileName);
+
+	int nConfigs() const { return static_cast<int>(configs.size()); }
+	int nRecords() const { return nRecs; }
+
+	// The parsed config for a config-table entry.  Each is created
+	// once and shared by all of its results; like the configs read
+	// from text results, they're never freed.
+	DrawingSurfaceConfig* config(int i);
+
+	int recordConfig(int i) const;
+	const char* recordData(int i, size_t* length) const;
+
+	struct BadFile { };	// Missing, unreadable or corrupt.
+
+    private:
+	const unsigned char* base;
+	size_t size;
+#if !defined(__UNIX__)
+	vector<unsigned char> contents;	// No mmap; read the whole file
+#endif
+	int nRecs;
+	const unsigned char* records;
+	vector<DrawingSurfaceConfig*> configs;	// Parsed lazily
+
+	unsigned int word(const unsigned char* p) const;
+	void checkRange(unsigned int offset, unsigned int length) const;
+
+	BinaryResultsReader(const BinaryResultsReader&);	// not copyable
+	BinaryResultsReader& operator=(const BinaryResultsReader&);
+}; // class BinaryResultsReader
+
+// Stream buffer for reading directly from memory (such as a record in a
+// mapped results file), without copying:
+class MemoryBuf: public streambuf {
+    public:
+	MemoryBuf(const char* data, size_t length) {
+		char* p = const_cast<char*>(data);
+		setg(p, p, p + length);
+	}
+}; // class MemoryBuf
+
+} // namespace GLEAN
+
+#endif // __binresults_h__
@@ -121,6 +121,21 @@ legacyMethod:
 	}
 
 
+#elif defined(__EGL__)
+	(void) x;
+	(void) y;
+
+	// There's nothing to display on, so render into a pbuffer of the
+	// requested size instead.
+	EGLint attribs[] = {
+		EGL_WIDTH, w,
+		EGL_HEIGHT, h,
+		EGL_NONE
+	};
+	eglSurface = eglCreatePbufferSurface(winSys->dpy, config->eglConfig,
+		attribs);
+	// XXX As with X11, there's no error handling here.
+
 #elif defined(__WIN__)
 	// XXX There's basically no error-handling code here.
 	// create the window
@@ -190,6 +205,8 @@ Window::~Window() {
 
 #if defined(__X11__)
 	XDestroyWindow(winSys->dpy, xWindow);
+#elif defined(__EGL__)
+	eglDestroySurface(winSys->dpy, eglSurface);
 #elif defined(__WIN__)
 	ReleaseDC(hWindow,hDC);
 	DestroyWindow(hWindow);
@@ -212,6 +229,8 @@ void
 Window::swap() {
 #   if defined(__X11__)
 	glXSwapBuffers(winSys->dpy, xWindow);
+#   elif defined(__EGL__)
+	eglSwapBuffers(winSys->dpy, eglSurface);	// no-op for pbuffers
 #   elif defined(__WIN__)
 	SwapBuffers(hDC);
 #   elif defined(__BEWIN__)
@@ -84,6 +84,8 @@ class Window: public DrawingSurface {
 
 #	if defined(__X11__)
 		::Window xWindow;
+#	elif defined(__EGL__)
+		::EGLSurface eglSurface;	// A pbuffer, not a window.
 #	elif defined(__WIN__)
 		::HWND	 hWindow;
 		::HDC	 hDC;
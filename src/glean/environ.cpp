@@ -56,8 +56,49 @@ namespace GLEAN {
 Environment::Environment(Options& opt):
     options(opt),
     log(cout),
-    winSys(opt)
+    exporter(0),
+    ws(0)
 {
+	// Worker processes in a parallel run share a results database
+	// that the parent process has already set up.
+	if (!opt.worker)
+		openDatabases(opt);
+	if (opt.mode == Options::run && !opt.exportName.empty())
+		exporter = new ResultExporter(opt.exportName);
+} // Environment::Environment()
+
+Environment::Environment(Options& opt, ostream& logStream):
+    options(opt),
+    log(logStream),
+    exporter(0),
+    ws(0)
+{
+} // Environment::Environment()
+
+///////////////////////////////////////////////////////////////////////////////
+// Destructor
+///////////////////////////////////////////////////////////////////////////////
+Environment::~Environment() {
+	delete exporter;
+	delete ws;
+} // Environment::~Environment()
+
+///////////////////////////////////////////////////////////////////////////////
+// winSys:  open the window system on first use
+///////////////////////////////////////////////////////////////////////////////
+WindowSystem&
+Environment::winSys() {
+	if (!ws)
+		ws = new WindowSystem(options);
+	return *ws;
+} // Environment::winSys
+
+///////////////////////////////////////////////////////////////////////////////
+// openDatabases:  create the output database, or verify that the databases
+//	to be compared exist
+///////////////////////////////////////////////////////////////////////////////
+void
+Environment::openDatabases(Options& opt) {
 #   if defined(__UNIX__)
 
 	// If running tests, first create the results directory.
@@ -77,11 +118,19 @@ Environment::Environment(Options& opt):
 				throw DBCantOpen(opt.db1Name);
 		}
 	// If comparing previous runs, make a token attempt to verify
-	// that the two databases exist.
+	// that the databases exist.
+	} else if (opt.mode == Options::compareMany) {
+		struct stat s;
+		for (size_t i = 0; i < opt.dbNames.size(); ++i)
+			if (stat(opt.dbNames[i].c_str(), &s)
+			    || !S_ISDIR(s.st_mode))
+				throw DBCantOpen(opt.dbNames[i]);
 	} else {
 		struct stat s;
 		if (stat(opt.db1Name.c_str(), &s) || !S_ISDIR(s.st_mode))
 			throw DBCantOpen(opt.db1Name);
+		if (opt.mode == Options::convert)
+			return;
 		if (stat(opt.db2Name.c_str(), &s) || !S_ISDIR(s.st_mode))
 			throw DBCantOpen(opt.db2Name);
 	}
@@ -106,18 +155,31 @@ Environment::Environment(Options& opt):
 				throw DBCantOpen(opt.db1Name);
 		}
 	// If comparing previous runs, make a token attempt to verify
-	// that the two databases exist.
+	// that the databases exist.
+	} else if (opt.mode == Options::compareMany) {
+		struct _stat s;
+		for (size_t i = 0; i < opt.dbNames.size(); ++i)
+			if (_stat(opt.dbNames[i].c_str(), &s)
+			    || !(s.st_mode & _S_IFDIR))
+				throw DBCantOpen(opt.dbNames[i]);
 	} else {
 		struct _stat s; 
 
 		if (_stat(opt.db1Name.c_str(), &s) || !(s.st_mode & _S_IFDIR))
 			throw DBCantOpen(opt.db1Name);
+		if (opt.mode == Options::convert)
+			return;
 		if (_stat(opt.db2Name.c_str(), &s) || !(s.st_mode & _S_IFDIR))
 			throw DBCantOpen(opt.db2Name);
 	}
 
 #   endif
-} // Environment::Environment()
+
+	// Each environment in the run appends to the export file, so
+	// it's created here, once.
+	if (opt.mode == Options::run && !opt.exportName.empty())
+		ResultExporter::start(opt.exportName);
+} // Environment::openDatabases
 
 ///////////////////////////////////////////////////////////////////////////////
 // Results-file access utilities
@@ -142,6 +204,11 @@ Environment::resultFileName(string& dbName, string& testName) {
 	return fileName;
 } // Environment::resultFileName
 
+string
+Environment::binaryResultFileName(string& dbName, string& testName) {
+	return resultFileName(dbName, testName) + ".bin";
+} // Environment::binaryResultFileName
+
 string
 Environment::imageFileName(string& dbName, string& testName, int n) {
 	char sn[4];
@@ -159,7 +226,8 @@ Environment::imageFileName(string& dbName, string& testName, int n) {
 
 void
 Environment::quiesce() {
-	winSys.quiesce();
+	if (ws)
+		ws->quiesce();
 #   if defined(__UNIX__)
 	sync();
 #   elif defined(__MS__)
@@ -43,6 +43,7 @@
 #include <iostream>
 #include "options.h"
 #include "winsys.h"
+#include "export.h"
 
 namespace GLEAN {
 
@@ -52,6 +53,12 @@ class Environment {
     public:
     	// Constructors:
 	Environment(Options& opt);
+	Environment(Options& opt, ostream& logStream);
+				// Log to the given stream instead of
+				// cout, and leave the databases alone;
+				// for helper environments in a run that
+				// already has a main one.
+	~Environment();
 
 	// Exceptions:
 	struct Error { };	// Base class for all errors.
@@ -67,8 +74,16 @@ class Environment {
 
 	ostream& log;		// Output stream used for logging results.
 
-	WindowSystem winSys;	// The window system providing the OpenGL
-				// implementation under test.
+	ResultExporter* exporter;
+				// Destination for --export records, or
+				// null if there is none.
+
+	WindowSystem& winSys();	// The window system providing the OpenGL
+				// implementation under test.  It isn't
+				// opened until first used, so comparing
+				// results doesn't need a display.  Not
+				// thread-safe; open it before starting
+				// threads that share it.
 
 	string resultFileName(string& dbName, string& testName);
 				// Return name of results file for given
@@ -84,6 +99,8 @@ class Environment {
 	inline string result2FileName(string& testName) {
 		return resultFileName(options.db2Name, testName);
 	}
+	string binaryResultFileName(string& dbName, string& testName);
+				// Same, for the binary results format.
 
 	string imageFileName(string& dbName, string& testName, int n);
 				// Return name of image file number ``n''
@@ -104,6 +121,16 @@ class Environment {
 
 	void quiesce();		// Settle down before starting a benchmark.
 
+	static void openDatabases(Options& opt);
+				// Create the results database for a run,
+				// or check that the databases for a
+				// comparison exist, and start the export
+				// file.  Called by the constructor, except
+				// in worker processes.
+
+    private:
+	WindowSystem* ws;	// Null until winSys() is first called.
+
 }; // class Environment
 
 } // namespace GLEAN
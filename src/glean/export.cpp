@@ -0,0 +1,244 @@
+// BEGIN_COPYRIGHT -*- glean -*-
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+// export.cpp:  structured export of test results
+
+#include <ctime>
+#include <sstream>
+#include "glwrap.h"
+#include "timer.h"
+#include "export.h"
+
+#if defined(__UNIX__)
+#include <unistd.h>
+#endif
+
+namespace GLEAN {
+
+namespace {
+
+const char csvHeader[] = "test,config,measurement,unit,value,low,high,"
+	"samples,timer,renderer,version,time\n";
+
+bool
+isCSV(const string& fileName) {
+	return fileName.size() >= 4
+		&& fileName.compare(fileName.size() - 4, 4, ".csv") == 0;
+} // isCSV
+
+void
+putJSONString(ostream& s, const string& str) {
+	s << '"';
+	for (string::const_iterator p = str.begin(); p != str.end(); ++p) {
+		unsigned char c = *p;
+		if (c == '"' || c == '\\')
+			s << '\\' << c;
+		else if (c < 0x20) {
+			char buf[8];
+			sprintf(buf, "\\u%04x", c);
+			s << buf;
+		} else
+			s << c;
+	}
+	s << '"';
+} // putJSONString
+
+void
+putCSVString(ostream& s, const string& str) {
+	if (str.find_first_of(",\"\n\r") == string::npos) {
+		s << str;
+		return;
+	}
+	s << '"';
+	for (string::const_iterator p = str.begin(); p != str.end(); ++p) {
+		if (*p == '"')
+			s << '"';
+		s << *p;
+	}
+	s << '"';
+} // putCSVString
+
+// NaN and infinity have no JSON representation; write null (or an empty
+// CSV field) instead.
+void
+putNumber(ostream& s, double d, bool csv) {
+	if (d != d || d - d != 0.0) {
+		if (!csv)
+			s << "null";
+	} else
+		s << d;
+} // putNumber
+
+string
+timestamp() {
+	time_t now = time(0);
+	char buf[32];
+	strftime(buf, sizeof(buf), "%Y-%m-%dT%H:%M:%SZ", gmtime(&now));
+	return buf;
+} // timestamp
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor/Destructor
+///////////////////////////////////////////////////////////////////////////////
+ResultExporter::ResultExporter(const string& name):
+    fileName(name),
+    csv(isCSV(name))
+{
+	f = fopen(fileName.c_str(), "a");
+	if (!f)
+		throw CantOpen(fileName);
+#if defined(__UNIX__)
+	pthread_mutex_init(&lock, 0);
+#endif
+} // ResultExporter::ResultExporter
+
+ResultExporter::~ResultExporter() {
+	fclose(f);
+#if defined(__UNIX__)
+	pthread_mutex_destroy(&lock);
+#endif
+} // ResultExporter::~ResultExporter
+
+///////////////////////////////////////////////////////////////////////////////
+// start:  begin a new export file
+///////////////////////////////////////////////////////////////////////////////
+void
+ResultExporter::start(const string& name) {
+	FILE* f = fopen(name.c_str(), "w");
+	if (!f)
+		throw CantOpen(name);
+	bool ok = true;
+	if (isCSV(name))
+		ok = fputs(csvHeader, f) >= 0;
+	if (fclose(f) != 0 || !ok)
+		throw CantOpen(name);
+} // ResultExporter::start
+
+///////////////////////////////////////////////////////////////////////////////
+// noteContext:  record the strings identifying the GL under test
+///////////////////////////////////////////////////////////////////////////////
+void
+ResultExporter::noteContext() {
+#if defined(__UNIX__)
+	pthread_mutex_lock(&lock);
+#endif
+	if (renderer.empty()) {
+		const char* r = reinterpret_cast<const char*>
+			(glGetString(GL_RENDERER));
+		const char* v = reinterpret_cast<const char*>
+			(glGetString(GL_VERSION));
+		if (r && v) {
+			renderer = r;
+			version = v;
+		}
+	}
+#if defined(__UNIX__)
+	pthread_mutex_unlock(&lock);
+#endif
+} // ResultExporter::noteContext
+
+///////////////////////////////////////////////////////////////////////////////
+// write:  append one record for each measurement
+///////////////////////////////////////////////////////////////////////////////
+void
+ResultExporter::write(const string& test, const string& config,
+    const vector<Measurement>& m) {
+	if (m.empty())
+		return;
+#if defined(__UNIX__)
+	pthread_mutex_lock(&lock);
+#endif
+	string timer(Timer::clockSourceName(Timer::getClockSource()));
+	string now(timestamp());
+
+	// Format every record first, so the lot goes out in one write:
+	ostringstream s;
+	s.precision(10);
+	for (vector<Measurement>::const_iterator p = m.begin();
+	    p != m.end(); ++p) {
+		if (csv) {
+			putCSVString(s, test);		s << ',';
+			putCSVString(s, config);	s << ',';
+			putCSVString(s, p->name);	s << ',';
+			putCSVString(s, p->unit);	s << ',';
+			putNumber(s, p->value, true);	s << ',';
+			putNumber(s, p->low, true);	s << ',';
+			putNumber(s, p->high, true);	s << ',';
+			s << p->samples << ',';
+			putCSVString(s, timer);		s << ',';
+			putCSVString(s, renderer);	s << ',';
+			putCSVString(s, version);	s << ',';
+			s << now << '\n';
+		} else {
+			s << "{\"test\":";	putJSONString(s, test);
+			s << ",\"config\":";	putJSONString(s, config);
+			s << ",\"measurement\":"; putJSONString(s, p->name);
+			s << ",\"unit\":";	putJSONString(s, p->unit);
+			s << ",\"value\":";	putNumber(s, p->value, false);
+			s << ",\"low\":";	putNumber(s, p->low, false);
+			s << ",\"high\":";	putNumber(s, p->high, false);
+			s << ",\"samples\":" << p->samples;
+			s << ",\"timer\":";	putJSONString(s, timer);
+			s << ",\"renderer\":";	putJSONString(s, renderer);
+			s << ",\"version\":";	putJSONString(s, version);
+			s << ",\"time\":\"" << now << "\"}\n";
+		}
+	}
+
+	// Bypass stdio, whose buffer could split the records into several
+	// writes that other processes might interleave with:
+	const string& out = s.str();
+	bool ok = true;
+#if defined(__UNIX__)
+	const char* p = out.data();
+	size_t left = out.size();
+	while (left > 0) {
+		ssize_t n = ::write(fileno(f), p, left);
+		if (n < 0 && errno == EINTR)
+			continue;
+		if (n <= 0) {
+			ok = false;
+			break;
+		}
+		p += n;
+		left -= n;
+	}
+#else
+	ok = fwrite(out.data(), 1, out.size(), f) == out.size()
+		&& fflush(f) == 0;
+#endif
+#if defined(__UNIX__)
+	pthread_mutex_unlock(&lock);
+#endif
+	if (!ok)
+		throw CantWrite(fileName);
+} // ResultExporter::write
+
+} // namespace GLEAN
@@ -0,0 +1,133 @@
+// BEGIN_COPYRIGHT -*- glean -*-
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+// export.h:  structured export of test results
+
+// With --export, every result is also written, as it's produced, to a
+// file that dashboards and scripts can read without parsing the log.
+// Each record is one measurement of one test on one drawing surface
+// config, and carries:
+//
+//	test, config		test name and concise config description
+//	measurement, unit	what was measured, e.g. "daTri" in "tri/s"
+//	value, low, high	the value and its 95% confidence interval
+//				(low == high == value if there's none)
+//	samples			number of samples behind the value (0 if
+//				unknown)
+//	timer			clock source used by the performance tests
+//	renderer, version	GL_RENDERER and GL_VERSION strings
+//	time			when the record was written (UTC, ISO 8601)
+//
+// A file whose name ends in ".csv" gets comma-separated values with a
+// header line; anything else gets JSON Lines (one object per line).
+//
+// Results supply their measurements through BaseResult::measurements().
+// Tests that don't override it produce no records.
+//
+// Every record is written and flushed with a single write to a file
+// opened for appending, so the worker processes of a parallel run (and
+// the threads of a config-parallel test) can share one file.
+
+#ifndef __export_h__
+#define __export_h__
+
+#include <cstdio>
+#include <string>
+#include <vector>
+
+#if defined(__UNIX__)
+#include <pthread.h>
+#endif
+
+using namespace std;
+
+namespace GLEAN {
+
+struct Measurement {
+	string name;
+	string unit;
+	double value;
+	double low, high;	// 95% confidence interval
+	int samples;		// 0 if unknown
+
+	Measurement(const string& aName, const string& aUnit, double v,
+	    int n = 0):
+		name(aName), unit(aUnit), value(v), low(v), high(v),
+		samples(n) { }
+	Measurement(const string& aName, const string& aUnit, double v,
+	    double lo, double hi, int n):
+		name(aName), unit(aUnit), value(v), low(lo), high(hi),
+		samples(n) { }
+}; // struct Measurement
+
+class ResultExporter {
+    public:
+	ResultExporter(const string& fileName);
+				// Open for appending.  Throws CantOpen.
+	~ResultExporter();
+
+	static void start(const string& fileName);
+				// Create (or empty) the file, and write the
+				// CSV header if there is one.  Called once
+				// per run, before any exporters are opened.
+				// Throws CantOpen.
+
+	void noteContext();	// Pick up the renderer and version strings
+				// from the current context, if they haven't
+				// been seen yet.
+
+	void write(const string& test, const string& config,
+	    const vector<Measurement>& m);
+				// Throws CantWrite.
+
+	struct CantOpen {
+		string fileName;
+		CantOpen(const string& s): fileName(s) { }
+	};
+	struct CantWrite {
+		string fileName;
+		CantWrite(const string& s): fileName(s) { }
+	};
+
+    private:
+	string fileName;
+	bool csv;
+	FILE* f;
+	string renderer;
+	string version;
+#if defined(__UNIX__)
+	pthread_mutex_t lock;
+#endif
+
+	ResultExporter(const ResultExporter&);		// not copyable
+	ResultExporter& operator=(const ResultExporter&);
+}; // class ResultExporter
+
+} // namespace GLEAN
+
+#endif // __export_h__
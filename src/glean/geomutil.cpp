@@ -79,6 +79,32 @@ RandomMesh2D::~RandomMesh2D() {
 	delete[] m;
 } // RandomMesh2D::~RandomMesh2D
 
+///////////////////////////////////////////////////////////////////////////////
+// gridIndices:  Triangulate a row-major grid of points, in the naive order
+//	(cell by cell along each row), with counterclockwise winding when
+//	y increases from row to row.
+///////////////////////////////////////////////////////////////////////////////
+void
+gridIndices(int xPoints, int yPoints, vector<unsigned int>& indices) {
+	indices.clear();
+	indices.reserve(6 * (xPoints - 1) * (yPoints - 1));
+	for (int iy = 0; iy < yPoints - 1; ++iy)
+		for (int ix = 0; ix < xPoints - 1; ++ix) {
+			unsigned int v0 = iy * xPoints + ix;
+			unsigned int v1 = v0 + 1;
+			unsigned int v2 = v0 + xPoints;
+			unsigned int v3 = v2 + 1;
+
+			indices.push_back(v0);
+			indices.push_back(v1);
+			indices.push_back(v3);
+
+			indices.push_back(v3);
+			indices.push_back(v2);
+			indices.push_back(v0);
+		}
+} // gridIndices
+
 
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -357,4 +383,128 @@ const unsigned int* Sphere3D::getIndices() const { return &(indices[0]); }
 int Sphere3D::getNumIndices() const { return numIndices; }
 
 
+///////////////////////////////////////////////////////////////////////////////
+// vertexCacheACMR:  Simulate a FIFO post-transform vertex cache, and
+//	return the average number of cache misses per triangle.  1.0 or
+//	more is typical of naive orders; 0.5 is the limit for large regular
+//	meshes.
+///////////////////////////////////////////////////////////////////////////////
+double
+vertexCacheACMR(const unsigned int* indices, int nIndices, int cacheSize) {
+	if (nIndices < 3)
+		return 0.0;
+
+	// A vertex is in the cache if it was loaded within the last
+	// cacheSize misses:
+	const unsigned int nVertices =
+		*max_element(indices, indices + nIndices) + 1;
+	vector<int> loadedAt(nVertices, -1);
+	int misses = 0;
+	for (int i = 0; i < nIndices; ++i) {
+		int& t = loadedAt[indices[i]];
+		if (t < 0 || misses - t >= cacheSize)
+			t = misses++;
+	}
+	return static_cast<double>(misses) / (nIndices / 3);
+} // vertexCacheACMR
+
+///////////////////////////////////////////////////////////////////////////////
+// optimizeVertexCache:  Reorder triangles with Tipsify.
+//
+//	Tipsify fans out around one vertex at a time, emitting all of its
+//	remaining triangles.  The next fanning vertex is chosen among the
+//	vertices just emitted:  the one that has been in the cache longest
+//	but will still be there after its own remaining triangles are
+//	emitted.  When no such vertex exists, it backtracks to the most
+//	recently emitted vertex that still has triangles (a ``dead end''),
+//	and failing that, to the next such vertex in input order.  The
+//	running time is linear in the size of the mesh.
+///////////////////////////////////////////////////////////////////////////////
+namespace {
+
+int
+skipDeadEnd(const vector<int>& live, vector<unsigned int>& deadEnds,
+    int& cursor, int nVertices) {
+	while (!deadEnds.empty()) {
+		unsigned int d = deadEnds.back();
+		deadEnds.pop_back();
+		if (live[d] > 0)
+			return d;
+	}
+	for (; cursor < nVertices; ++cursor)
+		if (live[cursor] > 0)
+			return cursor++;
+	return -1;
+} // skipDeadEnd
+
+} // anonymous namespace
+
+void
+optimizeVertexCache(const unsigned int* indices, int nIndices, int nVertices,
+    int cacheSize, unsigned int* out) {
+	const int nTris = nIndices / 3;
+
+	// Vertex-to-triangle adjacency, in compressed form:  the triangles
+	// using vertex v are adjacency[first[v]] .. adjacency[first[v+1]-1].
+	vector<int> live(nVertices, 0);	// Unemitted triangles per vertex
+	int i;
+	for (i = 0; i < 3 * nTris; ++i)
+		++live[indices[i]];
+	vector<int> first(nVertices + 1, 0);
+	for (i = 0; i < nVertices; ++i)
+		first[i + 1] = first[i] + live[i];
+	vector<int> adjacency(3 * nTris);
+	vector<int> fill(first.begin(), first.end() - 1);
+	for (i = 0; i < 3 * nTris; ++i)
+		adjacency[fill[indices[i]]++] = i / 3;
+
+	vector<int> cacheTime(nVertices, 0);
+	vector<bool> emitted(nTris, false);
+	vector<unsigned int> deadEnds;
+	vector<unsigned int> candidates;
+	int time = cacheSize + 1;	// Stamps older than this are evicted
+	int cursor = 1;
+	unsigned int* o = out;
+
+	int fanning = nVertices > 0? 0: -1;
+	while (fanning >= 0) {
+		candidates.clear();
+		for (int a = first[fanning]; a < first[fanning + 1]; ++a) {
+			const int t = adjacency[a];
+			if (emitted[t])
+				continue;
+			emitted[t] = true;
+			for (int k = 0; k < 3; ++k) {
+				const unsigned int v = indices[3 * t + k];
+				*o++ = v;
+				deadEnds.push_back(v);
+				candidates.push_back(v);
+				--live[v];
+				if (time - cacheTime[v] > cacheSize)
+					cacheTime[v] = time++;
+			}
+		}
+
+		// Pick the next fanning vertex:
+		int best = -1;
+		int bestPriority = -1;
+		for (size_t c = 0; c < candidates.size(); ++c) {
+			const unsigned int v = candidates[c];
+			if (live[v] <= 0)
+				continue;
+			int priority = 0;
+			if (time - cacheTime[v] + 2 * live[v] <= cacheSize)
+				priority = time - cacheTime[v];
+			if (priority > bestPriority) {
+				bestPriority = priority;
+				best = v;
+			}
+		}
+		if (best < 0)
+			best = skipDeadEnd(live, deadEnds, cursor, nVertices);
+		fanning = best;
+	}
+} // optimizeVertexCache
+
+
 } // namespace GLEAN
@@ -52,6 +52,10 @@ class RandomMesh2D {
 		{ return m + 2 * (y * rowLength + x); }
 }; // RandomMesh2D
 
+// Indices of independent triangles covering a grid of points stored in
+// row-major order (as in RandomMesh2D), two per cell, row by row:
+void gridIndices(int xPoints, int yPoints, std::vector<unsigned int>& indices);
+
 class SpiralStrip2D {
 	float* v;
     public:
@@ -95,6 +99,21 @@ class Sphere3D {
     int getNumIndices() const;
 };
 
+// Post-transform vertex cache utilities, for indexed independent
+// triangles:
+
+// Average cache miss ratio (vertices transformed per triangle) of a FIFO
+// vertex cache with cacheSize entries:
+double vertexCacheACMR(const unsigned int* indices, int nIndices,
+	int cacheSize);
+
+// Reorder the triangles for locality in a vertex cache of cacheSize
+// entries, using Tipsify (Sander, Nehab, and Barczak, "Fast Triangle
+// Reordering for Vertex Locality and Reduced Overdraw," SIGGRAPH 2007).
+// Each triangle keeps its winding; ``out'' holds nIndices indices.
+void optimizeVertexCache(const unsigned int* indices, int nIndices,
+	int nVertices, int cacheSize, unsigned int* out);
+
 } // namespace GLEAN
 
 #endif // __geomutil_h__
@@ -133,6 +133,8 @@ void
 	} else
 		return 0;
 #   endif
+#elif defined(__EGL__)
+	return eglGetProcAddress(name);
 #elif defined(__WIN__)
 	// Gotta be a little more explicit about the cast to please MSVC.
 	typedef void (__cdecl* VOID_FUNC_VOID) ();
@@ -145,6 +147,37 @@ void
 #endif
 } // getProcAddress
 
+///////////////////////////////////////////////////////////////////////////////
+// BufferFuncs:  Look up the buffer-object entry points
+///////////////////////////////////////////////////////////////////////////////
+BufferFuncs::BufferFuncs() {
+	have = false;
+	GenBuffers = 0;
+	DeleteBuffers = 0;
+	BindBuffer = 0;
+	BufferData = 0;
+	MapBuffer = 0;
+	UnmapBuffer = 0;
+
+	const bool core = getVersion() >= 1.5;
+	if (!core && !haveExtension("GL_ARB_vertex_buffer_object"))
+		return;
+	GenBuffers = reinterpret_cast<PFNGLGENBUFFERSARBPROC>
+		(getProcAddress(core? "glGenBuffers": "glGenBuffersARB"));
+	DeleteBuffers = reinterpret_cast<PFNGLDELETEBUFFERSARBPROC>
+		(getProcAddress(core? "glDeleteBuffers":
+			"glDeleteBuffersARB"));
+	BindBuffer = reinterpret_cast<PFNGLBINDBUFFERARBPROC>
+		(getProcAddress(core? "glBindBuffer": "glBindBufferARB"));
+	BufferData = reinterpret_cast<PFNGLBUFFERDATAARBPROC>
+		(getProcAddress(core? "glBufferData": "glBufferDataARB"));
+	MapBuffer = reinterpret_cast<PFNGLMAPBUFFERARBPROC>
+		(getProcAddress(core? "glMapBuffer": "glMapBufferARB"));
+	UnmapBuffer = reinterpret_cast<PFNGLUNMAPBUFFERARBPROC>
+		(getProcAddress(core? "glUnmapBuffer": "glUnmapBufferARB"));
+	have = GenBuffers && DeleteBuffers && BindBuffer && BufferData;
+} // BufferFuncs::BufferFuncs
+
 ///////////////////////////////////////////////////////////////////////////////
 // logGLErrors: Check for OpenGL errors and log any that have occurred.
 ///////////////////////////////////////////////////////////////////////////////
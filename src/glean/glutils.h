@@ -62,6 +62,28 @@ void (*getProcAddress(const char* name))();
 // Return GL renderer version as a float (1.1, 2.0, etc)
 float getVersion();
 
+// Buffer-object entry points for the current context, from OpenGL 1.5
+// or GL_ARB_vertex_buffer_object.  ``have'' is false if the context
+// lacks any of the first four; the mapping entry points are looked up
+// too, but are only needed by some users, so check them separately.
+struct BufferFuncs {
+	bool have;
+	PFNGLGENBUFFERSARBPROC GenBuffers;
+	PFNGLDELETEBUFFERSARBPROC DeleteBuffers;
+	PFNGLBINDBUFFERARBPROC BindBuffer;
+	PFNGLBUFFERDATAARBPROC BufferData;
+	PFNGLMAPBUFFERARBPROC MapBuffer;
+	PFNGLUNMAPBUFFERARBPROC UnmapBuffer;
+
+	BufferFuncs();
+}; // BufferFuncs
+
+// Convert an offset into the bound buffer object to the pointer form
+// taken by gl*Pointer and glDrawElements:
+inline const GLvoid* bufferOffset(size_t offset) {
+	return reinterpret_cast<const GLvoid*>(offset);
+}
+
 // Check for OpenGL errors and log any that have occurred:
 void logGLErrors(Environment& env);
 
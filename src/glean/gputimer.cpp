@@ -0,0 +1,174 @@
+// BEGIN_COPYRIGHT -*- glean -*-
+// 
+// Copyright (C) 1999, 2000  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+
+
+
+
+// gputimer.cpp:  Timer that also measures GPU execution time
+
+#include "gputimer.h"
+#include "glutils.h"
+
+namespace GLEAN {
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor/Destructor
+///////////////////////////////////////////////////////////////////////////////
+GPUTimer::GPUTimer() {
+	initialized = useTimestamps = haveQueries = false;
+	next = 0;
+	last = -1;
+	finished = 0;
+	GenQueries = 0;
+	DeleteQueries = 0;
+	BeginQuery = 0;
+	EndQuery = 0;
+	QueryCounter = 0;
+	GetQueryObjectui64v = 0;
+} // GPUTimer::GPUTimer
+
+GPUTimer::~GPUTimer() {
+	if (haveQueries)
+		DeleteQueries(2 * ringSize, queries);
+} // GPUTimer::~GPUTimer
+
+///////////////////////////////////////////////////////////////////////////////
+// init:  Look up the timer query entry points in the current context
+///////////////////////////////////////////////////////////////////////////////
+void
+GPUTimer::init() {
+	initialized = true;
+
+	if (GLUtils::haveExtension("GL_ARB_timer_query")) {
+		useTimestamps = true;
+		QueryCounter = reinterpret_cast<PFNGLQUERYCOUNTERPROC>
+			(GLUtils::getProcAddress("glQueryCounter"));
+		GetQueryObjectui64v =
+			reinterpret_cast<PFNGLGETQUERYOBJECTUI64VPROC>
+			(GLUtils::getProcAddress("glGetQueryObjectui64v"));
+	} else if (GLUtils::haveExtension("GL_EXT_timer_query")) {
+		GetQueryObjectui64v =
+			reinterpret_cast<PFNGLGETQUERYOBJECTUI64VPROC>
+			(GLUtils::getProcAddress("glGetQueryObjectui64vEXT"));
+	} else
+		return;
+
+	// Both extensions build on the query object interface from
+	// OpenGL 1.5 or GL_ARB_occlusion_query:
+	const bool core = GLUtils::getVersion() >= 1.5;
+	GenQueries = reinterpret_cast<PFNGLGENQUERIESARBPROC>
+		(GLUtils::getProcAddress(core? "glGenQueries":
+			"glGenQueriesARB"));
+	DeleteQueries = reinterpret_cast<PFNGLDELETEQUERIESARBPROC>
+		(GLUtils::getProcAddress(core? "glDeleteQueries":
+			"glDeleteQueriesARB"));
+	BeginQuery = reinterpret_cast<PFNGLBEGINQUERYARBPROC>
+		(GLUtils::getProcAddress(core? "glBeginQuery":
+			"glBeginQueryARB"));
+	EndQuery = reinterpret_cast<PFNGLENDQUERYARBPROC>
+		(GLUtils::getProcAddress(core? "glEndQuery": "glEndQueryARB"));
+
+	if (!GenQueries || !DeleteQueries || !GetQueryObjectui64v)
+		return;
+	if (useTimestamps? !QueryCounter: (!BeginQuery || !EndQuery))
+		return;
+
+	GenQueries(2 * ringSize, queries);
+	haveQueries = true;
+} // GPUTimer::init
+
+///////////////////////////////////////////////////////////////////////////////
+// available:  Report whether GPU times will be measured
+///////////////////////////////////////////////////////////////////////////////
+bool
+GPUTimer::available() {
+	if (!initialized)
+		init();
+	return haveQueries;
+} // GPUTimer::available
+
+///////////////////////////////////////////////////////////////////////////////
+// startBatch, finishBatch:  Bracket one batch of ops with queries
+///////////////////////////////////////////////////////////////////////////////
+void
+GPUTimer::startBatch() {
+	if (!available())
+		return;
+	if (useTimestamps)
+		QueryCounter(queries[2 * next], GL_TIMESTAMP);
+	else
+		BeginQuery(GL_TIME_ELAPSED_EXT, queries[2 * next]);
+} // GPUTimer::startBatch
+
+void
+GPUTimer::finishBatch() {
+	if (!haveQueries)
+		return;
+	if (useTimestamps)
+		QueryCounter(queries[2 * next + 1], GL_TIMESTAMP);
+	else
+		EndQuery(GL_TIME_ELAPSED_EXT);
+	last = next;
+	next = (next + 1) % ringSize;
+	++finished;
+} // GPUTimer::finishBatch
+
+///////////////////////////////////////////////////////////////////////////////
+// batchTime:  GPU time (in seconds) for the last finished batch
+///////////////////////////////////////////////////////////////////////////////
+double
+GPUTimer::batchTime() {
+	return laggedBatchTime(0);
+} // GPUTimer::batchTime
+
+///////////////////////////////////////////////////////////////////////////////
+// laggedBatchTime:  GPU time (in seconds) for an earlier finished batch
+///////////////////////////////////////////////////////////////////////////////
+double
+GPUTimer::laggedBatchTime(int age) {
+	if (!haveQueries || age < 0 || age >= ringSize || age >= finished)
+		return 0.0;
+	const int slot = (last - age + ringSize) % ringSize;
+
+	GLuint64EXT elapsed;
+	if (useTimestamps) {
+		GLuint64EXT begin, end;
+		GetQueryObjectui64v(queries[2 * slot], GL_QUERY_RESULT_ARB,
+			&begin);
+		GetQueryObjectui64v(queries[2 * slot + 1], GL_QUERY_RESULT_ARB,
+			&end);
+		elapsed = (end > begin)? end - begin: 0;
+	} else
+		GetQueryObjectui64v(queries[2 * slot], GL_QUERY_RESULT_ARB,
+			&elapsed);
+
+	return static_cast<double>(elapsed) * 1.0E-9;
+} // GPUTimer::laggedBatchTime
+
+} // namespace GLEAN
@@ -0,0 +1,108 @@
+// BEGIN_COPYRIGHT -*- glean -*-
+// 
+// Copyright (C) 1999, 2000  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+
+
+
+
+// gputimer.h:  Timer that also measures GPU execution time
+
+// A GPUTimer brackets each batch of operations in Timer::time() with
+// GL timer queries, so perf tests can report how long the GPU spent
+// executing a batch alongside how long the CPU spent issuing it.
+//
+// Queries are drawn from a small ring.  Only the final batch of each
+// time() call is read back, after postop() has drained the pipeline, so
+// the earlier (discarded) batches never force a wait on the GPU.
+//
+// GL_ARB_timer_query timestamps are preferred, since they don't occupy
+// the single GL_TIME_ELAPSED query target that the operations being
+// timed might want to use.  GL_EXT_timer_query is used otherwise.  If
+// neither is present, batchTime() returns zero.
+//
+// Timer queries must be issued with a rendering context current, so
+// the query objects are created on first use rather than at
+// construction time, and the destructor must run while the same
+// context is still current.
+//
+// Callers that time a stream of batches themselves (frames, say) can
+// read each batch's time a few batches late with laggedBatchTime(), so
+// that reading a query rarely has to wait for the GPU to catch up.
+
+#ifndef __gputimer_h__
+#define __gputimer_h__
+
+#include "glwrap.h"
+#include "timer.h"
+
+namespace GLEAN {
+
+class GPUTimer: public Timer {
+public:
+	GPUTimer();
+	virtual ~GPUTimer();
+
+	virtual void   startBatch();
+	virtual void   finishBatch();
+	virtual double batchTime();
+
+	bool available();	// Can GPU time be measured in this context?
+
+	enum { ringSize = 4 };
+
+	// GPU time (in seconds) for the batch finished age batches
+	// before the last one, where 0 <= age < ringSize.  Returns zero
+	// if there's no such batch.
+	double laggedBatchTime(int age);
+
+private:
+
+	bool   initialized;
+	bool   useTimestamps;	// ARB_timer_query rather than EXT
+	bool   haveQueries;
+	GLuint queries[2 * ringSize];	// begin/end pair per ring slot
+	int    next;		// Ring slot for the next batch
+	int    last;		// Ring slot of the last finished batch, or -1
+	int    finished;	// Number of batches finished so far
+
+	PFNGLGENQUERIESARBPROC       GenQueries;
+	PFNGLDELETEQUERIESARBPROC    DeleteQueries;
+	PFNGLBEGINQUERYARBPROC       BeginQuery;
+	PFNGLENDQUERYARBPROC         EndQuery;
+	PFNGLQUERYCOUNTERPROC        QueryCounter;
+	PFNGLGETQUERYOBJECTUI64VPROC GetQueryObjectui64v;
+
+	void init();
+
+	GPUTimer(const GPUTimer&);		// not copyable
+	GPUTimer& operator=(const GPUTimer&);
+}; // class GPUTimer
+
+} // namespace GLEAN
+
+#endif // __gputimer_h__
@@ -32,6 +32,7 @@
 // main.cpp:  main program for Glean
 
 #include <cassert>
+#include <cstdlib>
 #include <cstring>
 #include <iostream>
 #include <string>
@@ -43,6 +44,10 @@
 #include "version.h"
 #include "lex.h"
 #include "dsfilt.h"
+#include "parallel.h"
+#include "series.h"
+#include "image.h"
+#include "timer.h"
 
 using namespace std;
 
@@ -91,6 +96,65 @@ main(int argc, char* argv[]) {
 			o.db1Name = mandatoryArg(argc, argv, i);
 			++i;
 			o.db2Name = mandatoryArg(argc, argv, i);
+		} else if (!strcmp(argv[i], "--compare-many")) {
+			o.mode = Options::compareMany;
+			while (i + 1 < argc && argv[i + 1][0] != '-')
+				o.dbNames.push_back(argv[++i]);
+			if (o.dbNames.size() < 2)
+				usage(argv[0]);
+		} else if (!strcmp(argv[i], "--convert")) {
+			o.mode = Options::convert;
+			++i;
+			o.db1Name = mandatoryArg(argc, argv, i);
+		} else if (!strcmp(argv[i], "--binary")) {
+			o.binaryResults = true;
+		} else if (!strcmp(argv[i], "--export")) {
+			++i;
+			o.exportName = mandatoryArg(argc, argv, i);
+		} else if (!strcmp(argv[i], "--tiff-compression")) {
+			++i;
+			const char* name = mandatoryArg(argc, argv, i);
+			Image::TIFFCompression c = Image::tiffLZW;
+			if (!strcmp(name, "none"))
+				c = Image::tiffNone;
+			else if (!strcmp(name, "lzw"))
+				c = Image::tiffLZW;
+			else if (!strcmp(name, "deflate"))
+				c = Image::tiffDeflate;
+			else
+				usage(argv[0]);
+			if (!Image::setTIFFCompression(c)) {
+				cerr << "TIFF compression " << name
+					<< " isn't available in this build\n";
+				exit(1);
+			}
+		} else if (!strcmp(argv[i], "--tiff-tiles")) {
+			++i;
+			const char* arg = mandatoryArg(argc, argv, i);
+			char* end;
+			long size = strtol(arg, &end, 10);
+			if (end == arg || *end || size < 0 || size > 65536)
+				usage(argv[0]);
+			Image::setTIFFTileSize(size);
+		} else if (!strcmp(argv[i], "--readback-rows")) {
+			++i;
+			o.readbackRows = atoi(mandatoryArg(argc, argv, i));
+			if (o.readbackRows < 1)
+				usage(argv[0]);
+		} else if (!strcmp(argv[i], "--draw-paths")) {
+			++i;
+			string list = mandatoryArg(argc, argv, i);
+			o.drawPaths.clear();
+			for (size_t b = 0, e; b <= list.size(); b = e + 1) {
+				e = list.find(',', b);
+				if (e == string::npos)
+					e = list.size();
+				string p = list.substr(b, e - b);
+				if (p != "immediate" && p != "arrays"
+				    && p != "vbo")
+					usage(argv[0]);
+				o.drawPaths.push_back(p);
+			}
 		} else if (!strcmp(argv[i], "--visuals")) {
 			visFilter = true;
 			++i;
@@ -101,6 +165,30 @@ main(int argc, char* argv[]) {
 			selectTests(o, allTestNames, argc, argv, i);
 		} else if (!strcmp(argv[i], "--listtests")) {
 			o.mode = Options::listtests;
+		} else if (!strcmp(argv[i], "--timer")) {
+			++i;
+			Timer::ClockSource source;
+			if (!Timer::clockSourceFromName(
+			    mandatoryArg(argc, argv, i), &source))
+				usage(argv[0]);
+			if (!Timer::setClockSource(source)) {
+				cerr << "Timer " << argv[i]
+					<< " isn't available on this system\n";
+				exit(1);
+			}
+#	    if defined(__UNIX__)
+		} else if (!strcmp(argv[i], "-j")
+		    || !strcmp(argv[i], "--jobs")) {
+			++i;
+			o.jobs = atoi(mandatoryArg(argc, argv, i));
+			if (o.jobs < 1)
+				usage(argv[0]);
+		} else if (!strcmp(argv[i], "--threads")) {
+			++i;
+			o.threads = atoi(mandatoryArg(argc, argv, i));
+			if (o.threads < 1)
+				usage(argv[0]);
+#	    endif
 #	    if defined(__X11__)
 		} else if (!strcmp(argv[i], "-display")
 		    || !strcmp(argv[i], "--display")) {
@@ -127,9 +215,32 @@ main(int argc, char* argv[]) {
 		o.maxVisuals = 1;
 	}
 
+	if (o.mode == Options::run && o.verbosity)
+		cout << "Timer: " << Timer::clockSourceName(
+				Timer::getClockSource())
+			<< ", resolution " << Timer::clockResolution() * 1E9
+			<< " ns, overhead " << Timer::clockOverhead() * 1E9
+			<< " ns per reading\n";
+
 	// Create the test environment, then invoke each test to generate
 	// results or compare two previous runs.
 	try {
+#	    if defined(__UNIX__)
+		// A parallel run creates an environment in each worker
+		// process instead.
+		if (o.mode == Options::run && o.jobs > 1) {
+			if (!runParallel(o))
+				exit(1);
+			return 0;
+		}
+#	    endif
+		// Series comparisons also set up their own environments,
+		// one per comparison thread.
+		if (o.mode == Options::compareMany) {
+			if (!compareSeries(o))
+				exit(1);
+			return 0;
+		}
 		Environment e(o);
 		switch (o.mode) {
 		case Options::run:
@@ -164,6 +275,25 @@ main(int argc, char* argv[]) {
 					}
 			break;
 		}
+		case Options::convert:
+		{
+			for (Test* t = Test::testList; t; t = t->nextTest)
+				if (binary_search(o.selectedTests.begin(),
+				    o.selectedTests.end(), t->name))
+					try {
+						t->convert(e);
+					}
+					catch (Test::CantOpenResultsFile e) {
+						// As for comparisons, carry
+						// on with the other tests.
+						cerr << "Can't convert results file for test "
+							<< e.testName
+							<< " in database "
+							<< e.dbName
+							<< '\n';
+					}
+			break;
+		}
 		default:
 			cerr << "Bad run mode in main()\n";
 			break;
@@ -174,6 +304,11 @@ main(int argc, char* argv[]) {
 		cerr << "can't open display " << o.dpyName << "\n";
 		exit(1);
 	}
+#elif defined(__EGL__)
+	catch (WindowSystem::CantOpenDisplay) {
+		cerr << "can't initialize EGL display\n";
+		exit(1);
+	}
 #endif
 	catch (WindowSystem::NoOpenGL) {
 		cerr << "display doesn't support OpenGL\n";
@@ -201,6 +336,14 @@ main(int argc, char* argv[]) {
 			<< " in database " << e.dbName << '\n';
 		exit(1);
 	}
+	catch (ResultExporter::CantOpen e) {
+		cerr << "Can't open export file " << e.fileName << "\n";
+		exit(1);
+	}
+	catch (ResultExporter::CantWrite e) {
+		cerr << "Can't write export file " << e.fileName << "\n";
+		exit(1);
+	}
 	catch (...) {
 		cerr << "caught an unexpected error in main()\n";
 		exit(1);
@@ -325,6 +468,11 @@ usage(char* command) {
 "mode:\n"
 "       (-r|--run) results-directory\n"
 "   or  (-c|--compare) old-results-dir new-results-dir\n"
+"   or  --compare-many results-dir results-dir ...\n"
+"                                  # compare each run with the one\n"
+"                                  # before it, oldest first\n"
+"   or  --convert results-dir      # rewrite results as text, or as\n"
+"                                  # binary with --binary\n"
 "\n"
 "options:\n"
 "       (-v|--verbose)             # each occurrence increases\n"
@@ -334,7 +482,37 @@ usage(char* command) {
 "                                  # pixel formats) to test\n"
 "       (-t|--tests) {(+|-)test}   # choose tests to include (+) or exclude (-)\n"
 "       --quick                    # run fewer tests to reduce test time\n"
+"       --binary                   # store results in the binary format,\n"
+"                                  # which is faster to compare\n"
+"       --export file              # also write each measurement to file,\n"
+"                                  # as CSV if its name ends in .csv,\n"
+"                                  # otherwise as JSON Lines\n"
+"       --tiff-compression (none|lzw|deflate)\n"
+"                                  # compression for result images\n"
+"                                  # (default lzw; before this option\n"
+"                                  # existed, images were uncompressed)\n"
+"       --tiff-tiles N             # store result images in N-by-N\n"
+"                                  # tiles rather than strips (N is\n"
+"                                  # rounded up to a multiple of 16;\n"
+"                                  # 0 means strips)\n"
+"       --readback-rows N          # read result images from the\n"
+"                                  # framebuffer N rows at a time\n"
+"                                  # (default 256)\n"
+"       --draw-paths list          # comma-separated submission paths\n"
+"                                  # (immediate, arrays, vbo) timed by\n"
+"                                  # frame benchmarks (default all)\n"
 "       --listtests                # list test names and exit\n"
+"       --timer (monotonic|tsc|system)\n"
+"                                  # clock used by performance tests\n"
+"                                  # (default monotonic)\n"
+#if defined(__UNIX__)
+"       (-j|--jobs) N              # run tests in N worker processes;\n"
+"                                  # benchmarks still run one at a time;\n"
+"                                  # with --compare-many, compare N\n"
+"                                  # tests at once\n"
+"       --threads N                # test up to N visuals at once, in\n"
+"                                  # tests that support it\n"
+#endif
 "       --help                     # display usage information\n"
 #if defined(__X11__)
 "       -display X11-display-name  # select X11 display to use\n"
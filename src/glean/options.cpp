@@ -50,6 +50,12 @@ Options::Options() {
 	selectedTests.resize(0);
 	overwrite = false;
 	quick = false;
+	binaryResults = false;
+	exportName = "";
+	jobs = 1;
+	worker = false;
+	threads = 1;
+	readbackRows = 256;
 #   if defined(__X11__)
 	{
 	char* display = getenv("DISPLAY");
@@ -57,9 +57,12 @@ namespace GLEAN {
 
 class Options {
     public:
-	typedef enum {notSet, run, compare, listtests} RunMode;
+	typedef enum {notSet, run, compare, listtests, convert, compareMany}
+		RunMode;
 	RunMode mode;		// Indicates whether we're generating
-				// results, or comparing two previous runs.
+				// results, comparing two or more previous
+				// runs, or converting a results database
+				// between text and binary formats.
 
 	int verbosity;		// Verbosity level.  0 == concise; larger
 				// values imply more verbose output.
@@ -72,6 +75,9 @@ class Options {
 	string db2Name;		// Name of the second database being
 				// compared.
 
+	vector<string> dbNames;	// Databases for compareMany mode, oldest
+				// first.
+
 	string visFilter;	// Filter constraining the set of visuals
 				// (FBConfigs, pixel formats) that will be
 				// available for test.  See
@@ -87,6 +93,35 @@ class Options {
 
 	bool quick;		// run fewer/quicker tests when possible
 
+	bool binaryResults;	// Write results in the binary format
+				// (see binresults.h) rather than as text.
+				// Either format can be read.
+
+	string exportName;	// File receiving a structured copy of the
+				// results as they're produced (see
+				// export.h), or empty for none.
+
+	int jobs;		// Number of worker processes used to run
+				// tests concurrently.  1 means run every
+				// test in this process.
+
+	bool worker;		// True in a worker process started by
+				// a parallel run; the results database
+				// has already been created by the parent.
+
+	int threads;		// Number of threads used to test drawing
+				// surface configs concurrently, for tests
+				// that allow it.  1 means test them in
+				// turn on the main thread.
+
+	int readbackRows;	// Height of the bands in which large
+				// result images are read from the
+				// framebuffer (see readback.h).
+	vector<string> drawPaths;
+				// Submission paths (immediate, arrays,
+				// vbo) measured by frame-time benchmarks
+				// such as teapot.  Empty means all.
+
 #if defined(__X11__)
 	string dpyName;		// Name of the X11 display providing the
 				// OpenGL implementation to be tested.
@@ -0,0 +1,396 @@
+// BEGIN_COPYRIGHT -*- glean -*-
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+
+
+
+
+// parallel.cpp:  implementation of the parallel test scheduler
+
+#include "parallel.h"
+
+#if defined(__UNIX__)
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <sstream>
+#include <string>
+#include <vector>
+#include <pthread.h>
+#include <sys/types.h>
+#include <sys/wait.h>
+#include <unistd.h>
+#include "environ.h"
+#include "test.h"
+#include "dsfilt.h"
+#include "dsurf.h"
+#include "rc.h"
+
+namespace GLEAN {
+
+namespace {
+
+// A unit is a set of tests that must run in the same process.
+struct Unit {
+	vector<Test*> tests;	// Selected tests, in testList order.
+	bool exclusive;		// Contains a benchmark.
+	string logName;		// Temporary file holding the worker's log.
+	pid_t pid;		// Worker process, or 0 if not started.
+	bool done;		// Worker has exited.
+	Unit(): exclusive(false), pid(0), done(false) { }
+};
+
+int
+findRoot(vector<int>& parent, int i) {
+	while (parent[i] != i)
+		i = parent[i] = parent[parent[i]];
+	return i;
+} // findRoot
+
+bool
+isSelected(Options& o, Test* t) {
+	return binary_search(o.selectedTests.begin(), o.selectedTests.end(),
+		t->name);
+} // isSelected
+
+///////////////////////////////////////////////////////////////////////////////
+// buildUnits:  partition the selected tests, and the prerequisites they
+//	will invoke, into units that can run independently
+///////////////////////////////////////////////////////////////////////////////
+void
+buildUnits(Options& o, vector<Unit>& units) {
+	vector<Test*> tests;
+	map<Test*, int> index;
+	for (Test* t = Test::testList; t; t = t->nextTest) {
+		index[t] = tests.size();
+		tests.push_back(t);
+	}
+
+	// Mark every test that will run, and join each test with its
+	// prerequisites.
+	vector<int> parent(tests.size());
+	vector<bool> used(tests.size(), false);
+	for (size_t i = 0; i < tests.size(); ++i)
+		parent[i] = i;
+	vector<Test*> work;
+	for (size_t i = 0; i < tests.size(); ++i)
+		if (isSelected(o, tests[i]))
+			work.push_back(tests[i]);
+	while (!work.empty()) {
+		Test* t = work.back();
+		work.pop_back();
+		int ti = index[t];
+		if (used[ti])
+			continue;
+		used[ti] = true;
+		for (Test** p = t->prereqs; p != 0 && *p != 0; ++p) {
+			parent[findRoot(parent, index[*p])] =
+				findRoot(parent, ti);
+			work.push_back(*p);
+		}
+	}
+
+	// Collect units in the order their first test appears in testList.
+	map<int, int> unitOf;
+	for (size_t i = 0; i < tests.size(); ++i) {
+		if (!used[i])
+			continue;
+		int root = findRoot(parent, i);
+		if (unitOf.find(root) == unitOf.end()) {
+			unitOf[root] = units.size();
+			units.push_back(Unit());
+		}
+		Unit& u = units[unitOf[root]];
+		if (isSelected(o, tests[i]))
+			u.tests.push_back(tests[i]);
+		if (tests[i]->isBenchmark())
+			u.exclusive = true;
+	}
+} // buildUnits
+
+///////////////////////////////////////////////////////////////////////////////
+// runUnit:  body of a worker process
+///////////////////////////////////////////////////////////////////////////////
+int
+runUnit(Options& o, Unit& u) {
+	Options wo(o);
+	wo.worker = true;
+
+	ofstream logFile(u.logName.c_str());
+	streambuf* saved = cout.rdbuf(logFile.rdbuf());
+	int status = 0;
+	try {
+		Environment e(wo);
+		for (size_t i = 0; i < u.tests.size(); ++i)
+			u.tests[i]->run(e);
+	}
+#if defined(__X11__)
+	catch (WindowSystem::CantOpenDisplay) {
+		cerr << "can't open display " << o.dpyName << "\n";
+		status = 1;
+	}
+#elif defined(__EGL__)
+	catch (WindowSystem::CantOpenDisplay) {
+		cerr << "can't initialize EGL display\n";
+		status = 1;
+	}
+#endif
+	catch (WindowSystem::NoOpenGL) {
+		cerr << "display doesn't support OpenGL\n";
+		status = 1;
+	}
+	catch (Environment::DBCantOpen e) {
+		cerr << "Can't open database directory " << *e.db << "\n";
+		status = 1;
+	}
+	catch (Test::CantOpenResultsFile e) {
+		cerr << "Can't open results file for test " << e.testName
+			<< " in database " << e.dbName << '\n';
+		status = 1;
+	}
+	catch (ResultExporter::CantWrite e) {
+		cerr << "Can't write export file " << e.fileName << "\n";
+		status = 1;
+	}
+	catch (...) {
+		cerr << "caught an unexpected error in worker for test "
+			<< u.tests.front()->name << "\n";
+		status = 1;
+	}
+	cout.flush();
+	cout.rdbuf(saved);
+	return status;
+} // runUnit
+
+///////////////////////////////////////////////////////////////////////////////
+// replayLog:  copy a finished worker's log to the standard output
+///////////////////////////////////////////////////////////////////////////////
+void
+replayLog(Unit& u) {
+	ifstream in(u.logName.c_str());
+	if (in && in.peek() != EOF)
+		cout << in.rdbuf();
+	cout.flush();
+	in.close();
+	remove(u.logName.c_str());
+} // replayLog
+
+// Each config job thread keeps a pointer to its job here, so that
+// jobLog() can find the job's own log stream.
+pthread_key_t jobKey;
+pthread_once_t jobKeyOnce = PTHREAD_ONCE_INIT;
+
+void
+makeJobKey() {
+	pthread_key_create(&jobKey, 0);
+}
+
+struct JobThread {
+	ConfigJob* job;
+	WindowSystem* ws;
+};
+
+void*
+runJobThread(void* arg) {
+	JobThread* t = static_cast<JobThread*>(arg);
+	if (!t->ws->makeCurrent(*t->job->rc, *t->job->w)) {
+		t->job->log << "Could not bind a rendering context\n";
+		t->job->failed = true;
+		return 0;
+	}
+	pthread_setspecific(jobKey, t->job);
+	try {
+		t->job->run();
+	}
+	catch (...) {
+		t->job->failed = true;
+	}
+	pthread_setspecific(jobKey, 0);
+	t->ws->makeCurrent();
+	return 0;
+} // runJobThread
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// runParallel:  run the selected tests in up to o.jobs worker processes
+///////////////////////////////////////////////////////////////////////////////
+bool
+runParallel(Options& o) {
+	// Catch problems that would otherwise be reported once per worker.
+	DrawingSurfaceFilter filter(o.visFilter);
+	Environment::openDatabases(o);
+
+	vector<Unit> units;
+	buildUnits(o, units);
+
+	// Independent units run first; benchmarks follow, one at a time.
+	vector<int> plan;
+	for (size_t i = 0; i < units.size(); ++i)
+		if (!units[i].exclusive)
+			plan.push_back(i);
+	for (size_t i = 0; i < units.size(); ++i)
+		if (units[i].exclusive)
+			plan.push_back(i);
+
+	for (size_t i = 0; i < plan.size(); ++i) {
+		ostringstream name;
+		name << o.db1Name << "/.worker" << i << ".log";
+		units[plan[i]].logName = name.str();
+	}
+
+	bool ok = true;
+	size_t next = 0;	// Next unit in the plan to start.
+	size_t shown = 0;	// Next unit in the plan whose log is shown.
+	int running = 0;
+	bool exclusiveRunning = false;
+	while (shown < plan.size()) {
+		while (next < plan.size() && running < o.jobs
+		    && !exclusiveRunning) {
+			Unit& u = units[plan[next]];
+			if (u.exclusive && running > 0)
+				break;
+
+			cout.flush();
+			cerr.flush();
+			pid_t pid = fork();
+			if (pid == 0)
+				_exit(runUnit(o, u));
+			if (pid < 0) {
+				// Couldn't start a worker; run the unit here.
+				u.done = true;
+				if (runUnit(o, u))
+					ok = false;
+			} else {
+				u.pid = pid;
+				++running;
+				exclusiveRunning = u.exclusive;
+			}
+			++next;
+		}
+
+		if (running > 0) {
+			int status;
+			pid_t pid = waitpid(-1, &status, 0);
+			if (pid < 0 && errno == EINTR)
+				continue;
+			if (pid < 0) {
+				// We can't learn how the remaining workers
+				// fare, so count them all as failed.
+				cerr << "waitpid failed: " << strerror(errno)
+					<< '\n';
+				for (; shown < plan.size(); ++shown) {
+					Unit& u = units[plan[shown]];
+					if (!u.done)
+						cerr << "worker for test "
+							<< u.tests.front()->name
+							<< " failed\n";
+					replayLog(u);
+				}
+				return false;
+			}
+			for (size_t i = 0; i < plan.size(); ++i) {
+				Unit& u = units[plan[i]];
+				if (u.pid != pid)
+					continue;
+				u.done = true;
+				--running;
+				if (u.exclusive)
+					exclusiveRunning = false;
+				if (!WIFEXITED(status)
+				    || WEXITSTATUS(status) != 0) {
+					cerr << "worker for test "
+						<< u.tests.front()->name
+						<< " failed\n";
+					ok = false;
+				}
+			}
+		}
+
+		while (shown < plan.size() && units[plan[shown]].done)
+			replayLog(units[plan[shown++]]);
+	}
+
+	return ok;
+} // runParallel
+
+///////////////////////////////////////////////////////////////////////////////
+// runConfigJobs:  run a batch of config jobs concurrently
+///////////////////////////////////////////////////////////////////////////////
+void
+runConfigJobs(Environment& env, vector<ConfigJob*>& jobs) {
+	pthread_once(&jobKeyOnce, makeJobKey);
+
+	vector<JobThread> threads(jobs.size());
+	vector<pthread_t> ids(jobs.size());
+	vector<bool> started(jobs.size(), false);
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		threads[i].job = jobs[i];
+		threads[i].ws = &env.winSys();
+		started[i] = pthread_create(&ids[i], 0, runJobThread,
+			&threads[i]) == 0;
+	}
+	for (size_t i = 0; i < jobs.size(); ++i) {
+		if (started[i])
+			pthread_join(ids[i], 0);
+		else	// Out of threads; run this one here.
+			runJobThread(&threads[i]);
+	}
+} // runConfigJobs
+
+///////////////////////////////////////////////////////////////////////////////
+// jobLog:  log stream for the calling thread
+///////////////////////////////////////////////////////////////////////////////
+ostream&
+jobLog(Environment& env) {
+	pthread_once(&jobKeyOnce, makeJobKey);
+	ConfigJob* job = static_cast<ConfigJob*>(pthread_getspecific(jobKey));
+	return job? job->log: env.log;
+} // jobLog
+
+} // namespace GLEAN
+
+#else // !__UNIX__
+
+#include "environ.h"
+
+namespace GLEAN {
+
+ostream&
+jobLog(Environment& env) {
+	return env.log;
+} // jobLog
+
+} // namespace GLEAN
+
+#endif // __UNIX__
@@ -0,0 +1,106 @@
+// BEGIN_COPYRIGHT -*- glean -*-
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+
+
+
+
+// parallel.h:  run tests concurrently in worker processes
+
+// When glean is asked to run with more than one job, the selected
+// tests are divided into independent units and each unit is run in a
+// separate child process with its own window-system connection.  Tests
+// that share prerequisites are kept in the same unit, since they rely
+// on each other's in-memory results.  Units containing benchmarks are
+// held back until everything else has finished, and are then run one
+// at a time so that their timings aren't disturbed.
+//
+// Each worker's log is captured in a temporary file in the results
+// database and copied to the standard output once the worker exits,
+// so that the log for a unit is never interleaved with another's.
+//
+// Within a single test, BaseTest can also test several drawing surface
+// configs at once, one thread and rendering context per config.  That
+// is controlled by the --threads option and is only done for tests
+// whose isConfigParallel() returns true.  Such tests must log through
+// jobLog() rather than env->log while testing a config; each thread then
+// writes to its own job's stream, which is held until all threads have
+// finished and then written out in config order, so the log reads the
+// same as for a serial run.
+
+
+#ifndef __parallel_h__
+#define __parallel_h__
+
+#include <sstream>
+#include <vector>
+#include "options.h"
+
+using namespace std;
+
+namespace GLEAN {
+
+class Environment;		// Forward references.
+class Window;
+class RenderingContext;
+
+#if defined(__UNIX__)
+bool runParallel(Options& o);
+				// Run the selected tests using up to
+				// o.jobs worker processes.  Returns false
+				// if any worker failed.
+
+// One drawing surface config's share of a config-parallel test run.
+class ConfigJob {
+    public:
+	ConfigJob(): w(0), rc(0), failed(false) { }
+	virtual ~ConfigJob() { }
+
+	virtual void run() = 0;	// Test the config.  Called on a worker
+				// thread with rc bound to w.
+
+	Window* w;		// Window and context for this config,
+	RenderingContext* rc;	// created by the main thread.
+	ostringstream log;	// This job's own log stream; see jobLog().
+	bool failed;		// run() threw an exception, or rc
+				// couldn't be bound to w.
+};
+
+void runConfigJobs(Environment& env, vector<ConfigJob*>& jobs);
+				// Run each job on its own thread and wait
+				// for all of them to finish.
+#endif
+
+ostream& jobLog(Environment& env);
+				// The log stream for the calling thread:
+				// the running ConfigJob's log on a config
+				// job thread, otherwise env.log.
+
+} // namespace GLEAN
+
+#endif // __parallel_h__
@@ -122,6 +122,15 @@ legacyMethod:
 	// XXX Ideally, we would deal with X11 and GLX errors here, too
 	// (Badmatch, BadValue, GLXBadContext, BadAlloc)
 
+#   elif defined(__EGL__)
+
+	// EGL contexts are always direct.
+	(void) direct;
+	rc = eglCreateContext(winSys->dpy, c.eglConfig,
+		(share? share->rc: EGL_NO_CONTEXT), 0);
+	if (rc == EGL_NO_CONTEXT)
+		throw Error();
+
 #   elif defined(__WIN__)
 
 	rc = create_context(c);
@@ -150,6 +159,8 @@ RenderingContext::~RenderingContext() {
 #       endif
 legacyMethod:
 		glXDestroyContext(winSys->dpy, rc);
+#   elif defined(__EGL__)
+		eglDestroyContext(winSys->dpy, rc);
 #   elif defined(__WIN__)
 		wglDeleteContext(rc);
 #   endif
@@ -55,6 +55,8 @@ class RenderingContext {
 
 #   if defined(__X11__)
 	GLXContext rc;
+#   elif defined(__EGL__)
+	::EGLContext rc;
 #   elif defined(__WIN__)
 	::HGLRC rc;
 #   elif defined(__AGL__)
@@ -0,0 +1,344 @@
+// BEGIN_COPYRIGHT -*- glean -*-
+// 
+// Copyright (C) 1999, 2000  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+
+
+
+// readback.cpp:  Read images from the framebuffer a band of rows at a time
+
+#include <algorithm>
+#include <deque>
+#include <string.h>
+#include "readback.h"
+#include "glutils.h"
+
+#if defined(__UNIX__)
+#include <pthread.h>
+#endif
+
+using namespace std;
+
+namespace GLEAN {
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+// Layout:  the rectangle being read, and its division into bands.  Band 0
+//	is the top one.
+///////////////////////////////////////////////////////////////////////////////
+struct Layout {
+	GLint x, y;
+	GLsizei width, height;
+	GLsizei bandRows;
+	GLenum format, type;
+
+	GLsizei bands() const {
+		return (height + bandRows - 1) / bandRows;
+	}
+	GLsizei bottom(GLsizei k) const {
+		return max(0, height - (k + 1) * bandRows);
+	}
+	GLsizei rows(GLsizei k) const {
+		return height - k * bandRows - bottom(k);
+	}
+	void read(GLsizei k, GLvoid* pixels) const {
+		glReadPixels(x, y + bottom(k), width, rows(k), format, type,
+			pixels);
+	}
+};
+
+struct Band {
+	GLsizei y;		// Bottom row, in the whole image
+	Image rows;
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// SinkQueue:  bands on their way from the reading thread to the sinks.
+//	On Unix a thread of its own passes them to the sinks; elsewhere, or
+//	if the thread can't be started, they're passed on as they arrive.
+//	A sink that throws an exception gets no more bands.
+///////////////////////////////////////////////////////////////////////////////
+class SinkQueue {
+public:
+	SinkQueue(vector<BandSink*>& s);
+	~SinkQueue();
+
+	void put(Band* b);	// Takes ownership; waits for room
+	bool finish();		// Waits for the sinks.  False if any
+				// of them failed.
+
+private:
+	vector<BandSink*>& sinks;
+	deque<Band*> bands;
+	bool done;
+	bool failed;
+	void process(Band* b);
+#if defined(__UNIX__)
+	bool threaded;
+	pthread_t thread;
+	pthread_mutex_t lock;
+	pthread_cond_t changed;
+	static void* run(void* arg);
+#endif
+};
+
+SinkQueue::SinkQueue(vector<BandSink*>& s): sinks(s), done(false),
+    failed(false) {
+#if defined(__UNIX__)
+	pthread_mutex_init(&lock, 0);
+	pthread_cond_init(&changed, 0);
+	threaded = pthread_create(&thread, 0, run, this) == 0;
+#endif
+} // SinkQueue::SinkQueue
+
+SinkQueue::~SinkQueue() {
+	finish();
+#if defined(__UNIX__)
+	pthread_cond_destroy(&changed);
+	pthread_mutex_destroy(&lock);
+#endif
+} // SinkQueue::~SinkQueue
+
+void
+SinkQueue::process(Band* b) {
+	if (!failed)
+		try {
+			for (size_t i = 0; i < sinks.size(); ++i)
+				sinks[i]->band(b->y, b->rows);
+		}
+		catch (...) {
+			failed = true;
+		}
+	delete b;
+} // SinkQueue::process
+
+void
+SinkQueue::put(Band* b) {
+#if defined(__UNIX__)
+	if (threaded) {
+		pthread_mutex_lock(&lock);
+		while (bands.size() >= BandedReadback::queueDepth)
+			pthread_cond_wait(&changed, &lock);
+		bands.push_back(b);
+		pthread_cond_broadcast(&changed);
+		pthread_mutex_unlock(&lock);
+		return;
+	}
+#endif
+	process(b);
+} // SinkQueue::put
+
+bool
+SinkQueue::finish() {
+#if defined(__UNIX__)
+	if (threaded) {
+		pthread_mutex_lock(&lock);
+		done = true;
+		pthread_cond_broadcast(&changed);
+		pthread_mutex_unlock(&lock);
+		pthread_join(thread, 0);
+		threaded = false;
+	}
+#endif
+	return !failed;
+} // SinkQueue::finish
+
+#if defined(__UNIX__)
+void*
+SinkQueue::run(void* arg) {
+	SinkQueue& q = *static_cast<SinkQueue*>(arg);
+	pthread_mutex_lock(&q.lock);
+	for (;;) {
+		while (q.bands.empty() && !q.done)
+			pthread_cond_wait(&q.changed, &q.lock);
+		if (q.bands.empty())
+			break;
+		Band* b = q.bands.front();
+		q.bands.pop_front();
+		pthread_cond_broadcast(&q.changed);	// There's room
+		pthread_mutex_unlock(&q.lock);
+		q.process(b);
+		pthread_mutex_lock(&q.lock);
+	}
+	pthread_mutex_unlock(&q.lock);
+	return 0;
+} // SinkQueue::run
+#endif
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// Constructor/Destructor
+///////////////////////////////////////////////////////////////////////////////
+BandedReadback::BandedReadback(GLsizei rows) {
+	bandRows = max(rows, 1);
+	initialized = havePBOs = false;
+	buffers[0] = buffers[1] = 0;
+	bufferSize = 0;
+	gl = 0;
+} // BandedReadback::BandedReadback
+
+BandedReadback::~BandedReadback() {
+	if (havePBOs)
+		gl->DeleteBuffers(2, buffers);
+	delete gl;
+} // BandedReadback::~BandedReadback
+
+///////////////////////////////////////////////////////////////////////////////
+// init:  Look up the buffer object entry points in the current context
+///////////////////////////////////////////////////////////////////////////////
+void
+BandedReadback::init() {
+	initialized = true;
+
+	bool core = GLUtils::getVersion() >= 2.1;
+	if (!core && !GLUtils::haveExtension("GL_ARB_pixel_buffer_object"))
+		return;
+
+	gl = new GLUtils::BufferFuncs;
+	if (!gl->have || !gl->MapBuffer || !gl->UnmapBuffer)
+		return;
+
+	gl->GenBuffers(2, buffers);
+	havePBOs = true;
+} // BandedReadback::init
+
+///////////////////////////////////////////////////////////////////////////////
+// add:  Add a sink, to receive the bands of every image read
+///////////////////////////////////////////////////////////////////////////////
+void
+BandedReadback::add(BandSink& sink) {
+	sinks.push_back(&sink);
+} // BandedReadback::add
+
+///////////////////////////////////////////////////////////////////////////////
+// usingPBOs:  Report whether pixel buffer objects are used
+///////////////////////////////////////////////////////////////////////////////
+bool
+BandedReadback::usingPBOs() {
+	if (!initialized)
+		init();
+	return havePBOs;
+} // BandedReadback::usingPBOs
+
+///////////////////////////////////////////////////////////////////////////////
+// read:  Read an image, and pass it to the sinks a band at a time
+///////////////////////////////////////////////////////////////////////////////
+void
+BandedReadback::read(GLint x, GLint y, GLsizei w, GLsizei h, GLenum format,
+    GLenum type) {
+	Image whole;
+	whole.width(w);
+	whole.height(h);
+	whole.format(format);
+	whole.type(type);
+	for (size_t i = 0; i < sinks.size(); ++i)
+		sinks[i]->begin(whole);
+
+	glPixelStorei(GL_PACK_SWAP_BYTES, GL_FALSE);
+	glPixelStorei(GL_PACK_LSB_FIRST, GL_FALSE);
+	glPixelStorei(GL_PACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_PACK_SKIP_ROWS, 0);
+	glPixelStorei(GL_PACK_SKIP_PIXELS, 0);
+	glPixelStorei(GL_PACK_ALIGNMENT, whole.alignment());
+
+	Layout l;
+	l.x = x;
+	l.y = y;
+	l.width = w;
+	l.height = h;
+	l.bandRows = bandRows;
+	l.format = format;
+	l.type = type;
+	GLsizei bands = (w > 0)? l.bands(): 0;
+
+	SinkQueue queue(sinks);
+	if (bands > 0 && usingPBOs()) {
+		GLsizeiptrARB size = static_cast<GLsizeiptrARB>
+			(whole.rowSizeInBytes()) * l.rows(0);
+		if (size > bufferSize) {
+			for (int i = 0; i < 2; ++i) {
+				gl->BindBuffer(GL_PIXEL_PACK_BUFFER_ARB,
+					buffers[i]);
+				gl->BufferData(GL_PIXEL_PACK_BUFFER_ARB, size,
+					0, GL_STREAM_READ_ARB);
+			}
+			bufferSize = size;
+		}
+
+		// Keep two readbacks in flight:
+		for (GLsizei k = 0; k < bands && k < 2; ++k) {
+			gl->BindBuffer(GL_PIXEL_PACK_BUFFER_ARB, buffers[k]);
+			l.read(k, 0);
+		}
+		for (GLsizei k = 0; k < bands; ++k) {
+			Band* b = new Band;
+			b->y = l.bottom(k);
+			Image rows(w, l.rows(k), format, type);
+			b->rows.swap(rows);
+
+			gl->BindBuffer(GL_PIXEL_PACK_BUFFER_ARB,
+				buffers[k % 2]);
+			void* p = gl->MapBuffer(GL_PIXEL_PACK_BUFFER_ARB,
+				GL_READ_ONLY_ARB);
+			if (p) {
+				memcpy(b->rows.pixels(), p, static_cast<size_t>
+					(l.rows(k)) * whole.rowSizeInBytes());
+				gl->UnmapBuffer(GL_PIXEL_PACK_BUFFER_ARB);
+			} else {
+				// Mapping failed; read it again, directly.
+				gl->BindBuffer(GL_PIXEL_PACK_BUFFER_ARB, 0);
+				l.read(k, b->rows.pixels());
+			}
+
+			if (k + 2 < bands) {
+				gl->BindBuffer(GL_PIXEL_PACK_BUFFER_ARB,
+					buffers[k % 2]);
+				l.read(k + 2, 0);
+			}
+			queue.put(b);
+		}
+		gl->BindBuffer(GL_PIXEL_PACK_BUFFER_ARB, 0);
+	} else
+		for (GLsizei k = 0; k < bands; ++k) {
+			Band* b = new Band;
+			b->y = l.bottom(k);
+			Image rows(w, l.rows(k), format, type);
+			b->rows.swap(rows);
+			l.read(k, b->rows.pixels());
+			queue.put(b);
+		}
+
+	bool ok = queue.finish();
+	for (size_t i = 0; i < sinks.size(); ++i)
+		sinks[i]->end();
+	if (!ok)
+		throw SinkFailed();
+} // BandedReadback::read
+
+} // namespace GLEAN
@@ -0,0 +1,100 @@
+// BEGIN_COPYRIGHT -*- glean -*-
+// 
+// Copyright (C) 1999, 2000  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+
+
+
+// readback.h:  Read images from the framebuffer a band of rows at a time
+
+// Image::read() reads a whole image into one buffer before anything can
+// be done with it.  BandedReadback reads the image in bands of rows
+// instead, and hands each band to a list of BandSinks (see bands.h),
+// which might write it to a TIFF file or compare it with a reference;
+// so only a few bands are ever in memory, however large the image.
+//
+// With pixel buffer objects (OpenGL 2.1 or GL_ARB_pixel_buffer_object),
+// the readback of each band is started two bands ahead, into one of a
+// pair of buffers, so the transfer of one band overlaps the copying out
+// of the one before.  On Unix the sinks also run in a thread of their
+// own, fed through a short queue, so they work on one band while the
+// next is read.  Memory use is bounded by the band height:  two pixel
+// buffers, plus at most queueDepth + 2 bands.
+//
+// Like GPUTimer, a BandedReadback looks up its entry points on first
+// use, and must be used and destroyed with the same rendering context
+// current, on the thread that made it current.  The sinks' begin() and
+// end() are called on that thread too.
+
+#ifndef __readback_h__
+#define __readback_h__
+
+#include <vector>
+#include "glwrap.h"
+#include "bands.h"
+#include "glutils.h"
+
+namespace GLEAN {
+
+class BandedReadback {
+public:
+	BandedReadback(GLsizei bandRows = 256);
+	~BandedReadback();
+
+	struct SinkFailed { };	// A sink threw an exception from band()
+
+	void add(BandSink& sink);
+
+	// Read the w-by-h rectangle with lower left corner (x, y) from
+	// the current read buffer, as glReadPixels() would:
+	void read(GLint x, GLint y, GLsizei w, GLsizei h, GLenum format,
+		GLenum type);
+
+	bool usingPBOs();	// Are pixel buffer objects used here?
+
+	enum { queueDepth = 2 };
+
+private:
+	GLsizei bandRows;
+	std::vector<BandSink*> sinks;
+
+	bool   initialized;
+	bool   havePBOs;
+	GLuint buffers[2];
+	GLsizeiptrARB bufferSize;	// Current size of each buffer
+
+	GLUtils::BufferFuncs* gl;	// Looked up by init()
+
+	void init();
+
+	BandedReadback(const BandedReadback&);		// not copyable
+	BandedReadback& operator=(const BandedReadback&);
+}; // class BandedReadback
+
+} // namespace GLEAN
+
+#endif // __readback_h__
@@ -0,0 +1,207 @@
+// BEGIN_COPYRIGHT -*- glean -*-
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+// series.cpp:  compare a series of results databases
+
+#include <algorithm>
+#include <iostream>
+#include <sstream>
+#include "dsconfig.h"
+#include "environ.h"
+#include "test.h"
+#include "series.h"
+
+#if defined(__UNIX__)
+#include <pthread.h>
+#endif
+
+namespace GLEAN {
+
+namespace {
+
+// Work shared by the comparison threads:
+struct SeriesWork {
+	Options* options;
+	vector<Test*> tests;
+	vector<TestSeries> series;
+	size_t next;		// Next test to compare
+#if defined(__UNIX__)
+	pthread_mutex_t lock;
+#endif
+};
+
+bool
+takeTest(SeriesWork& w, size_t& i) {
+#if defined(__UNIX__)
+	pthread_mutex_lock(&w.lock);
+#endif
+	i = w.next++;
+#if defined(__UNIX__)
+	pthread_mutex_unlock(&w.lock);
+#endif
+	return i < w.tests.size();
+} // takeTest
+
+///////////////////////////////////////////////////////////////////////////////
+// compareTests:  body of a comparison thread.  Each thread has its own
+//	Environment, so tests can change its options and log freely.
+///////////////////////////////////////////////////////////////////////////////
+void*
+compareTests(void* arg) {
+	SeriesWork& w = *static_cast<SeriesWork*>(arg);
+	Options o(*w.options);
+	o.verbosity = 0;	// So that compareOne() is silent unless
+				// the results differ.
+	ostringstream log;	// Anything logged outside compareOne()
+	Environment env(o, log);
+
+	size_t i;
+	while (takeTest(w, i)) {
+		TestSeries& s = w.series[i];
+		s.test = w.tests[i]->name;
+		try {
+			w.tests[i]->compareSeries(env, s);
+		}
+		catch (Environment::DBCantOpen e) {
+			s.error = "can't open " + *e.db;
+		}
+		catch (...) {
+			s.error = "comparison failed";
+		}
+		log.str("");
+	}
+	return 0;
+} // compareTests
+
+bool
+byName(Test* a, Test* b) {
+	return a->name < b->name;
+} // byName
+
+void
+logReport(ostream& out, Options& o, vector<TestSeries>& series) {
+	const vector<string>& dbs = o.dbNames;
+	out << "Comparison of " << dbs.size() << " results databases:\n";
+	for (size_t i = 0; i < dbs.size(); ++i)
+		out << '\t' << (i + 1) << "  " << dbs[i] << '\n';
+	out << "Each row is a drawing surface config, and each column a"
+		" database:\n"
+	    << '\t' << seriesFirst << " first result     "
+	    << seriesSame << " same as previous  "
+	    << seriesMissing << " no results\n"
+	    << '\t' << seriesChanged << " result changed   "
+	    << seriesShifted << " benchmark changed\n\n";
+
+	for (size_t t = 0; t < series.size(); ++t) {
+		TestSeries& s = series[t];
+		if (!s.error.empty()) {
+			out << s.test << ":  " << s.error << "\n\n";
+			continue;
+		}
+		if (s.rows.empty()) {
+			if (o.verbosity)
+				out << s.test << ":  no results\n\n";
+			continue;
+		}
+
+		bool changed = false;
+		for (size_t r = 0; r < s.rows.size(); ++r)
+			if (s.rows[r].firstChange >= 0)
+				changed = true;
+		if (!changed && !o.verbosity)
+			continue;
+
+		out << s.test << '\n';
+		for (size_t r = 0; r < s.rows.size(); ++r) {
+			SeriesRow& row = s.rows[r];
+			out << '\t' << row.cells << "  " << row.config << '\n';
+			if (row.firstChange < 0)
+				continue;
+			out << "\t\tfirst changed in "
+			    << dbs[row.firstChange] << ":\n";
+			istringstream lines(row.change);
+			string line;
+			while (getline(lines, line))
+				out << "\t\t" << line << '\n';
+		}
+		out << '\n';
+	}
+} // logReport
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// compareSeries:  compare every selected test across o.dbNames
+///////////////////////////////////////////////////////////////////////////////
+bool
+compareSeries(Options& o) {
+	try {
+		Environment::openDatabases(o);
+	}
+	catch (Environment::DBCantOpen e) {
+		cerr << "can't open database directory " << *e.db << "\n";
+		return false;
+	}
+
+	SeriesWork w;
+	w.options = &o;
+	w.next = 0;
+	for (Test* t = Test::testList; t; t = t->nextTest)
+		if (binary_search(o.selectedTests.begin(),
+		    o.selectedTests.end(), t->name))
+			w.tests.push_back(t);
+	w.series.resize(w.tests.size());
+
+	sort(w.tests.begin(), w.tests.end(), byName);
+
+	// DrawingSurfaceConfig builds its name tables the first time a
+	// config is parsed.  Do that now, before the threads race to it.
+	string empty;
+	DrawingSurfaceConfig warmUp(empty);
+
+#if defined(__UNIX__)
+	pthread_mutex_init(&w.lock, 0);
+	size_t n = min(static_cast<size_t>(o.jobs), w.tests.size());
+	vector<pthread_t> ids(n);
+	vector<bool> started(n, false);
+	for (size_t i = 1; i < n; ++i)
+		started[i] = pthread_create(&ids[i], 0, compareTests, &w) == 0;
+	compareTests(&w);	// The main thread does its share, too.
+	for (size_t i = 1; i < n; ++i)
+		if (started[i])
+			pthread_join(ids[i], 0);
+	pthread_mutex_destroy(&w.lock);
+#else
+	compareTests(&w);
+#endif
+
+	logReport(cout, o, w.series);
+	return true;
+} // compareSeries
+
+} // namespace GLEAN
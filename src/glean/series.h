@@ -0,0 +1,84 @@
+// BEGIN_COPYRIGHT -*- glean -*-
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+// series.h:  compare a series of results databases
+
+// --compare-many takes any number of results databases, oldest first,
+// and compares each test's results in every database with its results
+// in the previous one.  Every database is read once per test, and
+// tests are compared concurrently (one thread per --jobs).  No window
+// system is needed.
+//
+// The report is a matrix for each test:  one row per drawing surface
+// config (taken from the newest database that has results for the
+// test) and one column per database.  For each row, the compareOne()
+// output for the first change is shown, so it's easy to see which run
+// introduced a pass/fail flip or a performance shift.
+//
+// A change is anything compareOne() reports at verbosity 0; by
+// convention, tests are silent then unless the results differ.
+
+
+#ifndef __series_h__
+#define __series_h__
+
+#include <string>
+#include <vector>
+#include "options.h"
+
+namespace GLEAN {
+
+// Matrix cell values:
+const char seriesFirst = 'o';	// First result in the series
+const char seriesSame = '.';	// Same as the previous result
+const char seriesMissing = '-';	// No results in this database
+const char seriesChanged = 'X';	// Result changed
+const char seriesShifted = '%';	// Benchmark result changed
+
+struct SeriesRow {
+	string config;		// Concise description of the config
+	string cells;		// One cell per database
+	int firstChange;	// Database index of the first change, or -1
+	string change;		// compareOne() output for that change
+	SeriesRow(): firstChange(-1) { }
+};
+
+struct TestSeries {
+	string test;
+	vector<SeriesRow> rows;
+	string error;		// Set if the comparison couldn't be done
+};
+
+bool compareSeries(Options& o);
+				// Compare the databases in o.dbNames and
+				// write the report to cout.  Returns false
+				// if the databases couldn't be opened.
+
+} // namespace GLEAN
+
+#endif // __series_h__
@@ -117,6 +117,8 @@ and tbasic.cpp.
 
 #include <iostream>
 #include <fstream>
+#include <sstream>
+#include <cstdio>
 #include "dsconfig.h"
 #include "dsfilt.h"
 #include "dsurf.h"
@@ -125,6 +127,10 @@ and tbasic.cpp.
 #include "rc.h"
 #include "glutils.h"
 #include "misc.h"
+#include "parallel.h"
+#include "binresults.h"
+#include "series.h"
+#include "export.h"
 
 #include "test.h"
 
@@ -194,6 +200,10 @@ public:
 		config = new DrawingSurfaceConfig(configDesc);
 		return getresults(s);
 	}
+
+	// Append the result's measurements, for --export.  Tests with
+	// performance numbers override this; by default there are none.
+	virtual void measurements(vector<Measurement>& m) const { }
 };
 
 
@@ -256,6 +266,58 @@ public:
 		}
 		return v;
 	}
+
+	virtual vector<ResultType*> getResults(BinaryResultsReader& rd) {
+		vector<ResultType*> v;
+		for (int i = 0; i < rd.nRecords(); ++i) {
+			ResultType* r = new ResultType();
+			r->config = rd.config(rd.recordConfig(i));
+			size_t length;
+			const char* data = rd.recordData(i, &length);
+			MemoryBuf buf(data, length);
+			istream s(&buf);
+			// Records have explicit bounds, so a short read
+			// can't disturb the records that follow.
+			r->getresults(s);
+			v.push_back(r);
+		}
+		return v;
+	}
+
+	// Read the results stored in a database, in whichever format
+	// they were written:
+	vector<ResultType*> readResults(string& dbName) {
+		string binName(env->binaryResultFileName(dbName, name));
+		if (BinaryResultsReader::exists(binName)) {
+			try {
+				BinaryResultsReader rd(binName);
+				return getResults(rd);
+			}
+			catch (BinaryResultsReader::BadFile) {
+				throw CantOpenResultsFile(name, dbName);
+			}
+		}
+		ifstream s(env->resultFileName(dbName, name).c_str());
+		if (!s)
+			throw CantOpenResultsFile(name, dbName);
+		return getResults(s);
+	}
+
+	void saveResult(OutputStream& os, ResultType& r) {
+		if (os.bin) {
+			ostringstream s;
+			r.putresults(s);
+			os.bin->add(r.config->canonicalDescription(), s.str());
+		} else
+			r.put(os);
+
+		if (env->exporter) {
+			vector<Measurement> m;
+			r.measurements(m);
+			env->exporter->write(name,
+				r.config->conciseDescription(), m);
+		}
+	}
 	
 	virtual void logDescription() {
 		if (env->options.verbosity)
@@ -271,6 +333,94 @@ public:
 		return true;
 	}
 
+	// This method allows a test to indicate that its drawing surface
+	// configs may be tested concurrently (see the --threads option).
+	// A test that returns true must not modify shared state in
+	// runOne() or isApplicable(); logOne() is always called on the
+	// main thread, in config order.
+	virtual bool isConfigParallel() const {
+		return false;
+	}
+
+#if defined(__UNIX__)
+	// Job for one config in a config-parallel run:
+	class ConfigRun: public ConfigJob {
+	    public:
+		BaseTest* test;
+		ResultType* r;
+		bool skipped;
+
+		virtual void run() {
+			skipped = !test->isApplicable()
+				|| !GLUtils::haveExtensions(test->extensions);
+			if (!skipped)
+				test->runOne(*r, *w);
+			if (test->env->exporter)
+				test->env->exporter->noteContext();
+		}
+	};
+
+	// Test configs in batches of options.threads, one thread per
+	// config.  Results are logged and saved in the original order.
+	void runConfigsInThreads(vector<DrawingSurfaceConfig*>& configs,
+	    OutputStream& os) {
+		WindowSystem& ws = env->winSys();
+		size_t batch = env->options.threads;
+		for (size_t first = 0; first < configs.size(); first += batch) {
+			size_t last = min(configs.size(), first + batch);
+			vector<ConfigJob*> jobs;
+			try {
+				for (size_t i = first; i < last; ++i) {
+					ConfigRun* j = new ConfigRun();
+					jobs.push_back(j);
+					j->test = this;
+					j->r = new ResultType();
+					j->r->config = configs[i];
+					j->skipped = true;
+					j->w = new Window(ws, *configs[i],
+						fWidth, fHeight);
+					j->rc = new RenderingContext(ws,
+						*configs[i]);
+				}
+			}
+			catch (RenderingContext::Error) {
+				deleteConfigRuns(jobs);
+				throw;
+			}
+
+			runConfigJobs(*env, jobs);
+
+			bool failed = false;
+			for (size_t i = 0; i < jobs.size(); ++i) {
+				ConfigRun* j = static_cast<ConfigRun*>(jobs[i]);
+				env->log << j->log.str();
+				if (j->failed)
+					failed = true;
+				else if (!j->skipped) {
+					logOne(*j->r);
+					results.push_back(j->r);
+					saveResult(os, *j->r);
+					j->r = 0;
+				}
+			}
+			deleteConfigRuns(jobs);
+			if (failed)
+				throw Error();
+		}
+	}
+
+	void deleteConfigRuns(vector<ConfigJob*>& jobs) {
+		for (size_t i = 0; i < jobs.size(); ++i) {
+			ConfigRun* j = static_cast<ConfigRun*>(jobs[i]);
+			delete j->r;
+			delete j->rc;
+			delete j->w;
+			delete j;
+		}
+		jobs.clear();
+	}
+#endif
+
 	virtual void run(Environment& environment) {
 		if (hasRun)
 			return; // no multiple invocations
@@ -280,7 +430,7 @@ public:
 			(*t)->run(environment);
 		env = &environment; // make environment available
 		logDescription();   // log invocation
-		WindowSystem& ws = env->winSys;
+		WindowSystem& ws = env->winSys();
 
 		try {
 			OutputStream os(*this);	// open results file
@@ -290,6 +440,12 @@ public:
 			vector<DrawingSurfaceConfig*>
                            configs(f.filter(ws.surfConfigs, environment.options.maxVisuals));
 
+#if defined(__UNIX__)
+			if (isConfigParallel() && !testOne
+			    && environment.options.threads > 1)
+				runConfigsInThreads(configs, os);
+			else
+#endif
 			// Test each config
 			for (vector<DrawingSurfaceConfig*>::const_iterator
 				     p = configs.begin();
@@ -301,6 +457,9 @@ public:
 					// XXX need to throw exception here
 				}
 
+				if (env->exporter)
+					env->exporter->noteContext();
+
 				// Check if test is applicable to this context
 				if (!isApplicable())
 					continue;
@@ -319,12 +478,13 @@ public:
 				
 				// Save the result
 				results.push_back(r);
-				r->put(os);
+				saveResult(os, *r);
 
 				// if testOne, skip remaining surface configs
 				if (testOne)
 					break;
 			}
+			os.close();
 		}
 		catch (DrawingSurfaceFilter::Syntax e) {
 			env->log << "Syntax error in test's drawing-surface"
@@ -347,10 +507,8 @@ public:
 		env = &environment; // Save the environment
 		logDescription();
 		// Read results from previous runs:
-		Input1Stream is1(*this);
-		vector<ResultType*> oldR(getResults(is1));
-		Input2Stream is2(*this);
-		vector<ResultType*> newR(getResults(is2));
+		vector<ResultType*> oldR(readResults(env->options.db1Name));
+		vector<ResultType*> newR(readResults(env->options.db2Name));
 
 		// Construct a vector of surface configurations from the
 		// old run.  (Later we'll find the best match in this
@@ -393,6 +551,122 @@ public:
 			delete *op;
 	}
 
+	virtual void compareSeries(Environment& environment,
+	    TestSeries& series) {
+		env = &environment;
+		vector<string>& dbs = env->options.dbNames;
+
+		// Read every run once:
+		vector<vector<ResultType*> > runs(dbs.size());
+		vector<vector<DrawingSurfaceConfig*> > configs(dbs.size());
+		int newest = -1;
+		for (size_t i = 0; i < dbs.size(); ++i) {
+			try {
+				runs[i] = readResults(dbs[i]);
+			}
+			catch (CantOpenResultsFile) {
+				// Test wasn't run; leave a gap.
+			}
+			for (size_t j = 0; j < runs[i].size(); ++j)
+				configs[i].push_back(runs[i][j]->config);
+			if (!runs[i].empty())
+				newest = i;
+		}
+
+		// One row for each config in the newest run, matched
+		// against the configs of the others as compare() does:
+		for (int c = 0; newest >= 0
+		    && c < static_cast<int>(runs[newest].size()); ++c) {
+			DrawingSurfaceConfig* config = runs[newest][c]->config;
+			SeriesRow row;
+			row.config = config->conciseDescription();
+			ResultType* prev = 0;
+			size_t prevRun = 0;
+			for (size_t i = 0; i < dbs.size(); ++i) {
+				if (runs[i].empty()) {
+					row.cells += seriesMissing;
+					continue;
+				}
+				ResultType* cur =
+					runs[i][config->match(configs[i])];
+				if (!prev)
+					row.cells += seriesFirst;
+				else {
+					string diff(compareQuietly(*prev, *cur,
+						dbs[prevRun], dbs[i]));
+					if (diff.empty())
+						row.cells += seriesSame;
+					else {
+						row.cells += isBenchmark()?
+							seriesShifted:
+							seriesChanged;
+						if (row.firstChange < 0) {
+							row.firstChange = i;
+							row.change = diff;
+						}
+					}
+				}
+				prev = cur;
+				prevRun = i;
+			}
+			series.rows.push_back(row);
+		}
+
+		for (size_t i = 0; i < runs.size(); ++i)
+			for (size_t j = 0; j < runs[i].size(); ++j)
+				delete runs[i][j];
+	}
+
+	// Run compareOne() on two runs, returning whatever it logs:
+	string compareQuietly(ResultType& oldR, ResultType& newR,
+	    string& oldDB, string& newDB) {
+		env->options.db1Name = oldDB;
+		env->options.db2Name = newDB;
+		ostringstream s;
+		streambuf* orig = env->log.rdbuf(s.rdbuf());
+		try {
+			compareOne(oldR, newR);
+		}
+		catch (...) {
+			env->log.rdbuf(orig);
+			throw;
+		}
+		env->log.rdbuf(orig);
+		return s.str();
+	}
+
+	virtual void convert(Environment& environment) {
+		env = &environment;
+		string& db = env->options.db1Name;
+
+		// Skip tests that weren't part of the run.  (Avoid
+		// resultFileName() here; it would create the directory.)
+		string textName(db + '/' + name + "/results");
+		if (!BinaryResultsReader::exists(textName)
+		    && !BinaryResultsReader::exists(textName + ".bin"))
+			return;
+
+		vector<ResultType*> v(readResults(db));
+		{
+			OutputStream os(*this);
+			for (size_t i = 0; i < v.size(); ++i)
+				saveResult(os, *v[i]);
+			os.close();
+		}
+		if (env->options.binaryResults)
+			remove(env->resultFileName(db, name).c_str());
+		else
+			remove(env->binaryResultFileName(db, name).c_str());
+		if (env->options.verbosity)
+			env->log << name << ":  converted " << v.size()
+				 << (env->options.binaryResults?
+				     " results to binary\n":
+				     " results to text\n");
+
+		for (size_t i = 0; i < v.size(); ++i)
+			delete v[i];
+	}
+
 	// comparePassFail is a helper function for tests that have a
 	// boolean result as all or part of their ResultType
 	virtual void comparePassFail(ResultType& oldR, ResultType& newR) {
@@ -38,11 +38,11 @@
 // calibrate() and time() methods as shown in runOne().
 
 #include "tbasicperf.h"
-#include "timer.h"
+#include "gputimer.h"
 #include <algorithm>
 
 namespace {
-class MyPerf : public GLEAN::Timer {
+class MyPerf : public GLEAN::GPUTimer {
 public:
 	int msec;
 
@@ -55,22 +55,12 @@ public:
 #endif
 	}
 	void postop() { glFinish(); }
+	void postmeasure() { w->swap(); }	// So user can see something
 
-	MyPerf() { msec = 100; }
-};
-
+	GLEAN::Window* w;
 
-// Complex results helper functions
-
-void
-diffHeader(bool& same, const string& name,
-           GLEAN::DrawingSurfaceConfig* config, GLEAN::Environment* env) {
-        if (same) {
-                same = false;
-                env->log << name << ":  DIFF "
-                         << config->conciseDescription() << '\n';
-        }
-} // diffHeader
+	MyPerf() { msec = 100; w = 0; }
+};
 
 }
 
@@ -83,18 +73,12 @@ void
 BasicPerfTest::runOne(BasicPerfResult& r, Window &w) {
 	MyPerf perf;
 
-	perf.calibrate();
-	vector<float> m;
-	for (int i = 0; i < 5; i++) {
-		env->quiesce();
-		double t = perf.time();
-		w.swap();	// So user can see something
-		m.push_back(t);
-	}
-	sort(m.begin(), m.end());
-	r.timeAvg  = (m[1] + m[2] + m[3]) / 3.0;
-	r.timeLow  = m[1];
-	r.timeHigh = m[3];
+	perf.w = &w;
+	env->quiesce();
+	perf.measure(5, &r.timeLow, &r.timeAvg, &r.timeHigh);
+	r.submitAvg = perf.submitAvg;
+	r.gpuAvg = perf.gpuAvg;
+	r.samples = perf.stats.n();
 	r.pass        = true;
 } // BasicPerfTest::runOne
 
@@ -113,50 +97,28 @@ BasicPerfTest::logOne(BasicPerfResult& r) {
 ///////////////////////////////////////////////////////////////////////////////
 void
 BasicPerfTest::compareOne(BasicPerfResult& oldR, BasicPerfResult& newR) {
-	bool same = true;
-	const char *title = "100mS sleep";
-
-	if (newR.timeLow < oldR.timeLow) {
-		double percent = (100.0
-				  * (oldR.timeLow - newR.timeLow)
-				  / newR.timeLow + 0.5);
-		if (percent >= 5.0) {
-			diffHeader(same, name, oldR.config, env);
-			env->log << '\t'
-				 << env->options.db1Name
-				 << " may be "
-				 << percent
-				 << "% faster on "
-				 << title
-				 << '\n';
-		}
-        }
-	if (newR.timeHigh > oldR.timeHigh) {
-		double percent = (100.0
-				  * (newR.timeHigh - oldR.timeHigh)
-				  / oldR.timeHigh + 0.5);
-		if (percent >= 5.0) {
-			diffHeader(same, name, oldR.config, env);
-			env->log << '\t'
-				 << env->options.db2Name
-				 << " may be "
-				 << percent
-				 << "% faster on "
-				 << title
-				 << '\n';
-		}
-        }
-
-	if (same && env->options.verbosity) {
+	if (significantlyDifferent(oldR.timeLow, oldR.timeHigh,
+	    newR.timeLow, newR.timeHigh)) {
+		const bool newFaster = newR.timeAvg < oldR.timeAvg;
+		const BasicPerfResult& fast = newFaster? newR: oldR;
+		const BasicPerfResult& slow = newFaster? oldR: newR;
+		double percent = 100.0 * (slow.timeAvg - fast.timeAvg)
+			/ fast.timeAvg;
+		env->log << name << ":  DIFF "
+			 << newR.config->conciseDescription() << "\n\t"
+			 << (newFaster? env->options.db2Name:
+				env->options.db1Name)
+			 << " is significantly faster on 100mS sleep ("
+			 << percent << "%).\n";
+	} else if (env->options.verbosity) {
 		env->log << name
-			 << ": SAME "
+			 << ":  SAME "
 			 << newR.config->conciseDescription()
-			 << "\n\t"
-			 << env->options.db2Name
-			 << " test time falls within the"
-			 << " valid measurement range of\n\t"
+			 << "\n\tDifference between "
 			 << env->options.db1Name
-			 << " test time.\n";
+			 << " and "
+			 << env->options.db2Name
+			 << " is not significant.\n";
 	}
 	if (env->options.verbosity) {
 		env->log << env->options.db1Name << ':';
@@ -168,13 +130,18 @@ BasicPerfTest::compareOne(BasicPerfResult& oldR, BasicPerfResult& newR) {
 
 void
 BasicPerfTest::logStats(BasicPerfResult& r) {
-        env->log << "\tAverage = "
+        env->log << "\tMedian = "
 		 << r.timeAvg
-		 << "\tRange = ["
+		 << "\t95% confidence interval = ["
 		 << r.timeLow
 		 << ", "
 		 << r.timeHigh
 		 << "]\n";
+	env->log << "\tCPU submission = " << r.submitAvg << " sec.\n";
+	if (r.gpuAvg > 0.0)
+		env->log << "\tGPU execution = " << r.gpuAvg << " sec.\n";
+	else
+		env->log << "\tGPU execution not measured\n";
 }
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -45,6 +45,7 @@
 #ifndef __tbasicperf_h__
 #define __tbasicperf_h__
 
+#include <sstream>
 #include "tbase.h"
 
 namespace GLEAN {
@@ -55,9 +56,14 @@ class BasicPerfResult: public BaseResult {
 public:
 	bool   pass;
 	double timeAvg, timeLow, timeHigh;
+	double submitAvg;	// CPU time spent issuing the operation
+	double gpuAvg;		// GPU execution time; 0 if unavailable
+	int samples;		// Number of timings behind timeAvg (not
+				// saved; only for --export)
 	
 	BasicPerfResult() {
-		timeAvg = timeLow = timeHigh = 0.0;
+		timeAvg = timeLow = timeHigh = submitAvg = gpuAvg = 0.0;
+		samples = 0;
 	}
 
 	void putresults(ostream& s) const {
@@ -65,12 +71,30 @@ public:
 		  << ' ' << timeAvg
 		  << ' ' << timeLow
 		  << ' ' << timeHigh
+		  << ' ' << submitAvg
+		  << ' ' << gpuAvg
 		  << '\n';
 	}
 
 	bool getresults(istream& s) {
-		s >> pass >> timeAvg >> timeLow >> timeHigh;
-		return s.good();
+		// submitAvg and gpuAvg are missing from older results files:
+		string line;
+		s >> ws;
+		getline(s, line);
+		istringstream ls(line);
+		ls >> pass >> timeAvg >> timeLow >> timeHigh;
+		bool ok = !ls.fail();
+		if (!(ls >> submitAvg >> gpuAvg))
+			submitAvg = gpuAvg = 0.0;
+		return ok && s.good();
+	}
+
+	virtual void measurements(vector<Measurement>& m) const {
+		m.push_back(Measurement("time", "s", timeAvg, timeLow,
+			timeHigh, samples));
+		m.push_back(Measurement("submit", "s", submitAvg, samples));
+		if (gpuAvg > 0.0)
+			m.push_back(Measurement("gpu", "s", gpuAvg, samples));
 	}
 };
 
@@ -78,6 +102,7 @@ class BasicPerfTest: public BaseTest<BasicPerfResult> {
 public:
 	GLEAN_CLASS(BasicPerfTest, BasicPerfResult);
 	void logStats(BasicPerfResult& r);
+	virtual bool isBenchmark() const { return true; }
 }; // class BasicPerfTest
 
 } // namespace GLEAN
@@ -84,7 +84,7 @@ void
 MakeCurrentTest::runOne(MakeCurrentResult& r, Window& w) {
 
 	DrawingSurfaceConfig& config = *(r.config);
-	WindowSystem& ws = env->winSys;
+	WindowSystem& ws = env->winSys();
 
 	// The rendering contexts to be used:
 	vector<RenderingContext*> rcs;
@@ -102,7 +102,7 @@ MakeCurrentTest::runOne(MakeCurrentResult& r, Window& w) {
 	ws.makeCurrent();
 	r.testSequence.push_back(static_cast<int>(rcs.size()) - 1);
 
-	rcs.push_back(new RenderingContext(env->winSys, config, 0, true));
+	rcs.push_back(new RenderingContext(env->winSys(), config, 0, true));
 	r.descriptions.push_back("Direct-rendering context");
 	ws.makeCurrent(*rcs.back(), w);
 	r.testSequence.push_back(static_cast<int>(rcs.size()) - 1);
@@ -111,7 +111,7 @@ MakeCurrentTest::runOne(MakeCurrentResult& r, Window& w) {
 	if (!makeCurrentOK(config))
 		goto failed;
 
-	rcs.push_back(new RenderingContext(env->winSys, config, 0, false));
+	rcs.push_back(new RenderingContext(env->winSys(), config, 0, false));
 	r.descriptions.push_back("Indirect-rendering context");
 	ws.makeCurrent(*rcs.back(), w);
 	r.testSequence.push_back(static_cast<int>(rcs.size()) - 1);
@@ -39,13 +39,6 @@
 
 #define HUGE_STEP 1000
 
-namespace GLEAN {
-static PFNGLBLENDFUNCSEPARATEPROC glBlendFuncSeparate_func = NULL;
-static PFNGLBLENDCOLORPROC glBlendColor_func = NULL;
-static PFNGLBLENDEQUATIONPROC glBlendEquation_func = NULL;
-static PFNGLBLENDEQUATIONSEPARATEPROC glBlendEquationSeparate_func = NULL;
-}
-
 //namespace {
 
 struct enumNameMapping {
@@ -454,6 +447,7 @@ BlendFuncTest::runFactors(GLenum srcFactorRGB, GLenum srcFactorA,
 			  GLenum dstFactorRGB, GLenum dstFactorA,
 			  GLenum opRGB, GLenum opA,
 			  const GLfloat constantColor[4],
+			  const Features& f,
 			  GLEAN::DrawingSurfaceConfig& config,
 			  GLEAN::Environment& env)
 {
@@ -517,16 +511,16 @@ BlendFuncTest::runFactors(GLenum srcFactorRGB, GLenum srcFactorA,
 	Image src(drawingSize, drawingSize, GL_RGBA, GL_FLOAT);
 	RandomBitsDouble srcARand(16, 42);
 
-	if (haveSepFunc)
-		glBlendFuncSeparate_func(srcFactorRGB, dstFactorRGB,
-					 srcFactorA, dstFactorA);
+	if (f.haveSepFunc)
+		f.glBlendFuncSeparate_func(srcFactorRGB, dstFactorRGB,
+					   srcFactorA, dstFactorA);
 	else
 		glBlendFunc(srcFactorRGB, dstFactorRGB);
 
-	if (haveBlendEquationSep)
-		glBlendEquationSeparate_func(opRGB, opA);
-	else if (haveBlendEquation)
-		glBlendEquation_func(opRGB);
+	if (f.haveBlendEquationSep)
+		f.glBlendEquationSeparate_func(opRGB, opA);
+	else if (f.haveBlendEquation)
+		f.glBlendEquation_func(opRGB);
 
 	glEnable(GL_BLEND);
 
@@ -585,7 +579,7 @@ float* sPix = reinterpret_cast<float*>(src.pixels()
 	+ y * src.rowSizeInBytes() + x * 4 * sizeof(float));
 float* dPix = reinterpret_cast<float*>(dst.pixels()
 	+ y * dst.rowSizeInBytes() + x * 4 * sizeof(float));
-env.log << '\n'
+jobLog(env) << '\n'
 << "First failing pixel is at row " << y << " column " << x << "\n"
 << "Actual values are (" << aPix[0] << ", " << aPix[1] << ", " << aPix[2]
 	<< ", " << aPix[3] << ")\n"
@@ -614,10 +608,11 @@ env.log << '\n'
 bool
 BlendFuncTest::runCombo(BlendFuncResult& r, Window& w,
 			BlendFuncResult::PartialResult p,
+			const Features& f,
 			GLEAN::Environment& env)
 {
 	runFactorsResult res(runFactors(p.srcRGB, p.srcA, p.dstRGB, p.dstA,
-					p.opRGB, p.opA, p.constColor,
+					p.opRGB, p.opA, p.constColor, f,
 					*(r.config), env));
 	w.swap();
 
@@ -626,7 +621,7 @@ BlendFuncTest::runCombo(BlendFuncResult& r, Window& w,
 	r.results.push_back(p);
 
 	if (p.rbErr > 1.0 || p.blErr > 1.0) {
-		env.log << name << ":  FAIL "
+		jobLog(env) << name << ":  FAIL "
 			<< r.config->conciseDescription() << '\n'
 			<< "\tsource factor RGB = " << factorToName(p.srcRGB)
 			<< ", source factor A = " << factorToName(p.srcA)
@@ -698,64 +693,69 @@ BlendFuncTest::runOne(BlendFuncResult& r, Window& w) {
 	BlendFuncResult::PartialResult p;
 	bool allPassed = true;
 	unsigned testNo, testStride;
+	Features f;
 
 	// test for features, get function pointers
+	f.haveSepFunc = false;
+	f.haveBlendEquation = false;
+	f.haveBlendEquationSep = false;
+	f.haveBlendColor = false;
 	if (GLUtils::getVersion() >= 1.4) {
-		haveSepFunc = true;
-		glBlendFuncSeparate_func = (PFNGLBLENDFUNCSEPARATEPROC)
+		f.haveSepFunc = true;
+		f.glBlendFuncSeparate_func = (PFNGLBLENDFUNCSEPARATEPROC)
 			GLUtils::getProcAddress("glBlendFuncSeparate");
 	}
 	else if (GLUtils::haveExtension("GL_EXT_blend_func_separate")) {
-		haveSepFunc = true;
-		glBlendFuncSeparate_func = (PFNGLBLENDFUNCSEPARATEPROC)
+		f.haveSepFunc = true;
+		f.glBlendFuncSeparate_func = (PFNGLBLENDFUNCSEPARATEPROC)
 			GLUtils::getProcAddress("glBlendFuncSeparateEXT");
 	}
 
 	if (GLUtils::getVersion() >= 1.4) {
-		haveBlendColor = true;
-		glBlendColor_func = (PFNGLBLENDCOLORPROC)
+		f.haveBlendColor = true;
+		f.glBlendColor_func = (PFNGLBLENDCOLORPROC)
 			GLUtils::getProcAddress("glBlendColor");
 	}
 	else if (GLUtils::haveExtension("GL_EXT_blend_color")) {
-		haveBlendColor = true;
-		glBlendColor_func = (PFNGLBLENDCOLORPROC)
+		f.haveBlendColor = true;
+		f.glBlendColor_func = (PFNGLBLENDCOLORPROC)
 			GLUtils::getProcAddress("glBlendColorEXT");
 	}
 
 	if (GLUtils::getVersion() >= 1.4) {
-		haveBlendEquation = true;
-		glBlendEquation_func = (PFNGLBLENDEQUATIONPROC)
+		f.haveBlendEquation = true;
+		f.glBlendEquation_func = (PFNGLBLENDEQUATIONPROC)
 			GLUtils::getProcAddress("glBlendEquation");
 	}
 	else if (GLUtils::haveExtension("GL_EXT_blend_subtract") &&
 		 GLUtils::haveExtension("GL_EXT_blend_min_max")) {
-		haveBlendEquation = true;
-		glBlendEquation_func = (PFNGLBLENDEQUATIONPROC)
+		f.haveBlendEquation = true;
+		f.glBlendEquation_func = (PFNGLBLENDEQUATIONPROC)
 			GLUtils::getProcAddress("glBlendEquationEXT");
 	}
 
 	if (GLUtils::getVersion() >= 2.0) {
-		haveBlendEquationSep = true;
-		glBlendEquationSeparate_func = (PFNGLBLENDEQUATIONSEPARATEPROC)
+		f.haveBlendEquationSep = true;
+		f.glBlendEquationSeparate_func = (PFNGLBLENDEQUATIONSEPARATEPROC)
 			GLUtils::getProcAddress("glBlendEquationSeparate");
 	}
 	else if (GLUtils::haveExtension("GL_EXT_blend_equation_separate")) {
-		haveBlendEquationSep = true;
-		glBlendEquationSeparate_func = (PFNGLBLENDEQUATIONSEPARATEPROC)
+		f.haveBlendEquationSep = true;
+		f.glBlendEquationSeparate_func = (PFNGLBLENDEQUATIONSEPARATEPROC)
 			GLUtils::getProcAddress("glBlendEquationSeparateEXT");
 	}
 
-	if (haveBlendColor) {
+	if (f.haveBlendColor) {
 		// Just one blend color setting for all tests
 		p.constColor[0] = 0.25;
 		p.constColor[1] = 0.0;
 		p.constColor[2] = 1.0;
 		p.constColor[3] = 0.75;
-		glBlendColor_func(p.constColor[0], p.constColor[1],
-				  p.constColor[2], p.constColor[3]);
+		f.glBlendColor_func(p.constColor[0], p.constColor[1],
+				    p.constColor[2], p.constColor[3]);
 	}
 
-	if (haveSepFunc) {
+	if (f.haveSepFunc) {
 		numSrcFactorsSep = ELEMENTS(srcFactors);
 		numDstFactorsSep = ELEMENTS(dstFactors);
 	}
@@ -764,7 +764,7 @@ BlendFuncTest::runOne(BlendFuncResult& r, Window& w) {
 		numDstFactorsSep = 1;
 	}
 
-	if (haveBlendEquation) {
+	if (f.haveBlendEquation) {
 		numOperatorsRGB = ELEMENTS(operators);
 		numOperatorsA = ELEMENTS(operators);
 	}
@@ -791,7 +791,7 @@ BlendFuncTest::runOne(BlendFuncResult& r, Window& w) {
 	p.dstRGB = p.dstA = GL_ONE_MINUS_SRC_ALPHA;
 	p.opRGB = GL_FUNC_ADD;
 	p.opA = GL_FUNC_ADD;
-	allPassed = runCombo(r, w, p, *env);
+	allPassed = runCombo(r, w, p, f, *env);
 #else
 	for (unsigned int op = 0; op < numOperatorsRGB; ++op) {
 		p.opRGB = operators[op];
@@ -819,7 +819,7 @@ BlendFuncTest::runOne(BlendFuncResult& r, Window& w) {
 					for (unsigned int df = 0; df < ELEMENTS(dstFactors); df += step) {
 						for (unsigned int dfa = 0; dfa < numDstFactorsSep; dfa += step) {
 
-							if (haveSepFunc) {
+							if (f.haveSepFunc) {
 								p.srcRGB = srcFactors[sf];
 								p.srcA = srcFactors[sfa];
 								p.dstRGB = dstFactors[df];
@@ -839,7 +839,7 @@ BlendFuncTest::runOne(BlendFuncResult& r, Window& w) {
 								continue;
 
 							// skip test if blend color used, but not supported.
-							if (!haveBlendColor
+							if (!f.haveBlendColor
 								&& (needsBlendColor(p.srcRGB) ||
 									needsBlendColor(p.srcA) ||
 									needsBlendColor(p.dstRGB) ||
@@ -855,7 +855,7 @@ BlendFuncTest::runOne(BlendFuncResult& r, Window& w) {
 								continue;
 							}
 
-							if (!runCombo(r, w, p, *env)) {
+							if (!runCombo(r, w, p, f, *env)) {
 								allPassed = false;
 							}
 						}
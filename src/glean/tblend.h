@@ -63,6 +63,7 @@ class BlendFuncTest: public BaseTest<BlendFuncResult> {
 public:
 	GLEAN_CLASS_WH(BlendFuncTest, BlendFuncResult,
 		       windowSize, windowSize);
+	virtual bool isConfigParallel() const { return true; }
 
 private:
 	struct runFactorsResult {
@@ -70,15 +71,31 @@ private:
 		float blendErrorBits;
 	};
 
+	// Blending features of the current context.  These are kept
+	// on the stack in runOne(), since configs may be tested
+	// concurrently.
+	struct Features {
+		bool haveSepFunc;
+		bool haveBlendEquation;
+		bool haveBlendEquationSep;
+		bool haveBlendColor;
+		PFNGLBLENDFUNCSEPARATEPROC glBlendFuncSeparate_func;
+		PFNGLBLENDCOLORPROC glBlendColor_func;
+		PFNGLBLENDEQUATIONPROC glBlendEquation_func;
+		PFNGLBLENDEQUATIONSEPARATEPROC glBlendEquationSeparate_func;
+	};
+
 	runFactorsResult runFactors(GLenum srcFactorRGB, GLenum srcFactorA,
 				    GLenum dstFactorRGB, GLenum dstFactorA,
 				    GLenum opRGB, GLenum opA,
 				    const GLfloat constantColor[4],
+				    const Features& f,
 				    GLEAN::DrawingSurfaceConfig& config,
 				    GLEAN::Environment& env);
 
 	bool runCombo(BlendFuncResult& r, Window& w,
 		      BlendFuncResult::PartialResult p,
+		      const Features& f,
 		      GLEAN::Environment& env);
 
 	bool equalMode(const BlendFuncResult::PartialResult &r1,
@@ -86,11 +103,6 @@ private:
 
 	void printMode(const BlendFuncResult::PartialResult &r) const;
 
-	bool haveSepFunc;
-	bool haveBlendEquation;
-	bool haveBlendEquationSep;
-	bool haveBlendColor;
-
 }; // class BlendFuncTest
 
 } // namespace GLEAN
@@ -32,7 +32,7 @@
 #include <algorithm>
 #include "rand.h"
 #include "image.h"
-#include "timer.h"
+#include "gputimer.h"
 #include "geomutil.h"
 
 #if 0
@@ -142,13 +142,13 @@ bindDraw() {
 	}
 } // BindDraw
 
-class BindDrawTimer: public GLEAN::Timer {
+class BindDrawTimer: public GLEAN::GPUTimer {
 	virtual void op()     { bindDraw(); }
 	virtual void preop()  { glFinish(); }
 	virtual void postop() { glFinish(); }
 };
 
-class NoBindDrawTimer: public GLEAN::Timer {
+class NoBindDrawTimer: public GLEAN::GPUTimer {
 	virtual void op()     { noBindDraw(); }
 	virtual void preop()  { glFinish();   }
 	virtual void postop() { glFinish();   }
@@ -157,8 +157,13 @@ class NoBindDrawTimer: public GLEAN::Timer {
 void
 logStats(GLEAN::TexBindPerfResult& r, GLEAN::Environment* env) {
 	env->log << "\tApproximate texture binding time = " << r.bindTime
-		<< " microseconds.\n\tRange of valid measurements = ["
-		<< r.lowerBound << ", " << r.upperBound << "]\n";
+		<< " microseconds.\n\t95% confidence interval = ["
+		<< r.lowerBound << ", " << r.upperBound << "]\n"
+		<< "\tCPU submission estimate = " << r.cpuBindTime
+		<< " microseconds.\n";
+	if (r.gpuBindTime > 0.0)
+		env->log << "\tGPU execution estimate = " << r.gpuBindTime
+			<< " microseconds.\n";
 } // logStats
 
 } // anonymous namespace
@@ -216,8 +221,12 @@ TexBindPerf::runOne(TexBindPerfResult& r, Window& w) {
 	bindDrawTimer.calibrate();
 	noBindDrawTimer.calibrate();
 
-	vector<float> measurements;
-	for (int i = 0; i < 5; ++i) {
+	// Sample until the estimate is precise enough, or we run out of
+	// time, just as Timer::measure() does:
+	RobustStats measurements, cpuMeasurements, gpuMeasurements;
+	bool haveGPU = true;
+	double start = Timer::getClock();
+	for (;;) {
 		env->quiesce();
 		double tBind = bindDrawTimer.time();
 		w.swap();	// So the user can see something happening.
@@ -234,17 +243,35 @@ TexBindPerf::runOne(TexBindPerfResult& r, Window& w) {
 			// and try again.  (Note:  You really shouldn't be
 			// running timing tests on a system where other
 			// processes are active!)
-			--i;
-			continue;
+			if (Timer::getClock() - start < Timer::getBudget())
+				continue;
+			break;
 		}
 
-		measurements.push_back(bindTime);
+		measurements.sample(bindTime);
+		cpuMeasurements.sample(1E6 * (bindDrawTimer.submitTime
+			- noBindDrawTimer.submitTime) / nTris);
+		if (bindDrawTimer.gpuTime > 0.0 && noBindDrawTimer.gpuTime > 0.0)
+			gpuMeasurements.sample(1E6 * (bindDrawTimer.gpuTime
+				- noBindDrawTimer.gpuTime) / nTris);
+		else
+			haveGPU = false;
+
+		if (measurements.n() < 5)
+			continue;
+		if (Timer::getClock() - start >= Timer::getBudget())
+			break;
+		if (measurements.relativeCI() <= Timer::getPrecision())
+			break;
 	}
 
-	sort(measurements.begin(), measurements.end());
-	r.bindTime = (measurements[1]+measurements[2]+measurements[3]) / 3.0;
-	r.lowerBound = measurements[1];
-	r.upperBound = measurements[3];
+	measurements.rejectOutliers();
+	r.bindTime = measurements.median();
+	measurements.bootstrapCI(0.95, &r.lowerBound, &r.upperBound);
+	r.samples = measurements.n();
+	r.cpuBindTime = cpuMeasurements.median();
+	if (haveGPU)
+		r.gpuBindTime = gpuMeasurements.median();
 	r.pass = true;
 } // TexBindPerf::runOne
 
@@ -263,32 +290,28 @@ TexBindPerf::logOne(TexBindPerfResult& r) {
 ///////////////////////////////////////////////////////////////////////////////
 void
 TexBindPerf::compareOne(TexBindPerfResult& oldR, TexBindPerfResult& newR) {
-	if (newR.bindTime < oldR.lowerBound) {
+	if (significantlyDifferent(oldR.lowerBound, oldR.upperBound,
+	    newR.lowerBound, newR.upperBound)) {
+		const bool newFaster = newR.bindTime < oldR.bindTime;
+		const double fast = newFaster? newR.bindTime: oldR.bindTime;
+		const double slow = newFaster? oldR.bindTime: newR.bindTime;
 		int percent = static_cast<int>(
-			100.0 * (oldR.bindTime - newR.bindTime) / newR.bindTime
-			+ 0.5);
+			100.0 * (slow - fast) / fast + 0.5);
 		env->log << name << ":  DIFF "
 			<< newR.config->conciseDescription() << '\n'
-			<< '\t' << env->options.db2Name << " may be "
-			<< percent << "% faster.\n";
-	} else if (newR.bindTime > oldR.upperBound) {
-		int percent = static_cast<int>(
-			100.0 * (newR.bindTime - oldR.bindTime) / oldR.bindTime
-			+ 0.5);
-		env->log << name << ":  DIFF "
-			<< oldR.config->conciseDescription() << '\n'
-			<< '\t' << env->options.db1Name << " may be "
-			<< percent << "% faster.\n";
+			<< '\t' << (newFaster? env->options.db2Name:
+				env->options.db1Name)
+			<< " is significantly faster ("
+			<< percent << "%).\n";
 	} else {
 		if (env->options.verbosity)
 			env->log << name << ":  SAME "
 				<< newR.config->conciseDescription()
-				<< "\n\t"
-				<< env->options.db2Name
-				<< " test time falls within the "
-				<< "valid measurement range of "
+				<< "\n\tDifference between "
 				<< env->options.db1Name
-				<< " test time.\n";
+				<< " and "
+				<< env->options.db2Name
+				<< " test times is not significant.\n";
 	}
 	if (env->options.verbosity) {
 		env->log << env->options.db1Name << ':';
@@ -32,6 +32,7 @@
 #ifndef __tchgperf_h__
 #define __tchgperf_h__
 
+#include <sstream>
 #include "tbase.h"
 
 namespace GLEAN {
@@ -44,19 +45,50 @@ public:
 	double bindTime;
         double lowerBound;
 	double upperBound;
+	double cpuBindTime;	// Estimate from CPU submission time alone
+	double gpuBindTime;	// Estimate from GPU execution time; 0 if
+				// timer queries aren't supported
+	int samples;		// Number of estimates behind bindTime (not
+				// saved; only for --export)
 
-	TexBindPerfResult() { bindTime = lowerBound = upperBound = 0.0; }
+	TexBindPerfResult() {
+		bindTime = lowerBound = upperBound = 0.0;
+		cpuBindTime = gpuBindTime = 0.0;
+		samples = 0;
+	}
 
 	void putresults(ostream& s) const {
 		s << bindTime
 		  << ' ' << lowerBound
 		  << ' ' << upperBound
+		  << ' ' << cpuBindTime
+		  << ' ' << gpuBindTime
 		  << '\n';
 	}
 	
 	bool getresults(istream& s) {
-		s >> bindTime >> lowerBound >> upperBound;
-		return s.good();
+		// cpuBindTime and gpuBindTime are missing from older
+		// results files:
+		string line;
+		s >> ws;
+		getline(s, line);
+		istringstream ls(line);
+		ls >> bindTime >> lowerBound >> upperBound;
+		bool ok = !ls.fail();
+		if (!(ls >> cpuBindTime >> gpuBindTime))
+			cpuBindTime = gpuBindTime = 0.0;
+		return ok && s.good();
+	}
+
+	virtual void measurements(vector<Measurement>& m) const {
+		m.push_back(Measurement("bindTime", "us", bindTime,
+			lowerBound, upperBound, samples));
+		if (cpuBindTime > 0.0)
+			m.push_back(Measurement("bindTime.cpu", "us",
+				cpuBindTime, samples));
+		if (gpuBindTime > 0.0)
+			m.push_back(Measurement("bindTime.gpu", "us",
+				gpuBindTime, samples));
 	}
 
 };
@@ -65,6 +97,7 @@ class TexBindPerf: public BaseTest<TexBindPerfResult> {
 public:
 	GLEAN_CLASS_WH(TexBindPerf, TexBindPerfResult,
 	       drawingSize, drawingSize);
+	virtual bool isBenchmark() const { return true; }
 }; // class TexBindPerf
 
 } // namespace GLEAN
@@ -40,6 +40,7 @@
 #include "winsys.h"
 #include "environ.h"
 #include "test.h"
+#include "binresults.h"
 
 namespace GLEAN {
 
@@ -84,17 +85,54 @@ Test::~Test() {
 // Stream opening utilities for results databases
 ///////////////////////////////////////////////////////////////////////////////
 
-Test::OutputStream::OutputStream(Test& t) {
+Test::OutputStream::OutputStream(Test& t): test(t) {
+	s = 0;
+	bin = 0;
+	if (t.env->options.binaryResults) {
+		// Nothing is written until close(), but make sure the
+		// results directory exists.
+		bin = new BinaryResultsWriter(t.env->binaryResultFileName(
+			t.env->options.db1Name, t.name));
+		return;
+	}
 	s = new ofstream(t.env->resultFileName(t.name).c_str());
-	if (!*s)
+	if (!*s) {
+		delete s;
 		throw Test::CantOpenResultsFile(t.name, t.env->options.db1Name);
+	}
 } // Test::OutputStream::OutputStream
 
 Test::OutputStream::~OutputStream() {
-	s->close();
-	delete s;
+	try {
+		close();
+	}
+	catch (CantOpenResultsFile) {
+		// Already unwinding, or the caller didn't care.
+	}
 } // Test::OutputStream::~OutputStream
 
+void
+Test::OutputStream::close() {
+	if (s) {
+		s->close();
+		delete s;
+		s = 0;
+	}
+	if (bin) {
+		BinaryResultsWriter* b = bin;
+		bin = 0;
+		try {
+			b->close();
+		}
+		catch (BinaryResultsWriter::CantWrite) {
+			delete b;
+			throw Test::CantOpenResultsFile(test.name,
+				test.env->options.db1Name);
+		}
+		delete b;
+	}
+} // Test::OutputStream::close
+
 Test::OutputStream::operator ofstream& () {
 	return *s;
 } // Test::OutputStream::operator ::ofstream&
@@ -62,6 +62,8 @@ namespace GLEAN {
 
 class Environment;		// Mutually-recursive and forward references.
 class DrawingSurfaceConfig;
+class BinaryResultsWriter;
+struct TestSeries;
 
 // Base class for a single test result.  A test may have many results
 // (for example, one per drawing surface configuration), so in general
@@ -101,6 +103,21 @@ class Test {
 	virtual void compare(Environment& env) = 0;
 				// Compare two previous runs.
 
+	virtual void compareSeries(Environment& env, TestSeries& series) = 0;
+				// Compare the runs in env.options.dbNames,
+				// each with the one before it.
+
+	virtual void convert(Environment& env) = 0;
+				// Rewrite the results of a previous run
+				// in the format chosen by the
+				// binaryResults option.
+
+	virtual bool isBenchmark() const { return false; }
+				// True for performance tests.  Their
+				// results are disturbed by other activity
+				// on the machine, so parallel runs
+				// schedule them by themselves.
+
 	// Exceptions:
 	struct Error { };	// Base class for all exceptions.
 	struct CantOpenResultsFile: public Error {
@@ -116,10 +133,15 @@ class Test {
 	// when their destructors are executed.
 	class OutputStream {	// Open an output stream for storing results.
 	    public:
-		ofstream* s;
+		ofstream* s;		// Text results, or
+		BinaryResultsWriter* bin;	// binary results
 		OutputStream(Test& t);
 		~OutputStream();
 		operator ofstream& ();
+		void close();	// Finish writing; throws
+				// CantOpenResultsFile on failure.
+	    private:
+		Test& test;
 	};
 	class Input1Stream {	// Open db #1 input stream for reading results.
 	    public:
@@ -0,0 +1,485 @@
+// BEGIN_COPYRIGHT -*- glean -*-
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+// tfillperf.cpp:  Test fill rate under various rasterization loads
+
+#include "tfillperf.h"
+#include "gputimer.h"
+#include "rand.h"
+
+namespace {
+
+// Each case draws screen-aligned quads, changing one thing from the
+// baseline (a window-sized, untextured, unblended quad with depth and
+// stencil testing off).  The drawing surface's color format is varied
+// by running the test on each configuration.
+struct FillCase {
+	const char* name;
+	int size;		// Quad width and height, in pixels
+	bool depth;		// Depth test and write every pixel
+	bool stencil;		// Stencil test and write every pixel
+	bool blend;		// Alpha blending
+	int texUnits;		// Texture units sampled per pixel
+	GLenum filter;		// Texture minification filter
+	GLenum texFormat;	// Texture internal format
+	int aluOps;		// Fragment shader ALU statements (0 for
+				// fixed-function fragment processing)
+};
+
+const FillCase fillCases[] = {
+	// name		size  depth  stencil blend  units filter  format  alu
+	{ "size128",	 128, false, false, false, 0, GL_LINEAR, GL_RGBA8, 0 },
+	{ "size256",	 256, false, false, false, 0, GL_LINEAR, GL_RGBA8, 0 },
+	{ "base",   fillSize, false, false, false, 0, GL_LINEAR, GL_RGBA8, 0 },
+	{ "depth",  fillSize, true,  false, false, 0, GL_LINEAR, GL_RGBA8, 0 },
+	{ "stencil", fillSize, false, true, false, 0, GL_LINEAR, GL_RGBA8, 0 },
+	{ "depthStencil", fillSize, true, true, false, 0, GL_LINEAR,
+		GL_RGBA8, 0 },
+	{ "blend",  fillSize, false, false, true,  0, GL_LINEAR, GL_RGBA8, 0 },
+	{ "tex1Nearest", fillSize, false, false, false, 1, GL_NEAREST,
+		GL_RGBA8, 0 },
+	{ "tex1", fillSize, false, false, false, 1, GL_LINEAR, GL_RGBA8, 0 },
+	{ "tex1Trilinear", fillSize, false, false, false, 1,
+		GL_LINEAR_MIPMAP_LINEAR, GL_RGBA8, 0 },
+	{ "tex1RGB5", fillSize, false, false, false, 1, GL_LINEAR,
+		GL_RGB5, 0 },
+	{ "tex1L8", fillSize, false, false, false, 1, GL_LINEAR,
+		GL_LUMINANCE8, 0 },
+	{ "tex2", fillSize, false, false, false, 2, GL_LINEAR, GL_RGBA8, 0 },
+	{ "tex4", fillSize, false, false, false, 4, GL_LINEAR, GL_RGBA8, 0 },
+	{ "alu8",   fillSize, false, false, false, 0, GL_LINEAR, GL_RGBA8, 8 },
+	{ "alu32",  fillSize, false, false, false, 0, GL_LINEAR, GL_RGBA8, 32 },
+	{ "alu128", fillSize, false, false, false, 0, GL_LINEAR, GL_RGBA8, 128 },
+};
+const int nFillCases = sizeof(fillCases) / sizeof(fillCases[0]);
+
+const int texSize = 256;
+
+// Entry points for multitexturing and fragment shaders.  Those the
+// context lacks are left null, and the cases that need them skipped.
+struct FillEntryPoints {
+	PFNGLACTIVETEXTUREPROC ActiveTexture;
+	PFNGLMULTITEXCOORD2FARBPROC MultiTexCoord2f;
+	bool shaders;
+	PFNGLCREATESHADERPROC CreateShader;
+	PFNGLSHADERSOURCEPROC ShaderSource;
+	PFNGLCOMPILESHADERPROC CompileShader;
+	PFNGLGETSHADERIVPROC GetShaderiv;
+	PFNGLDELETESHADERPROC DeleteShader;
+	PFNGLCREATEPROGRAMPROC CreateProgram;
+	PFNGLATTACHSHADERPROC AttachShader;
+	PFNGLLINKPROGRAMPROC LinkProgram;
+	PFNGLGETPROGRAMIVPROC GetProgramiv;
+	PFNGLUSEPROGRAMPROC UseProgram;
+	PFNGLDELETEPROGRAMPROC DeleteProgram;
+
+	FillEntryPoints();
+}; // FillEntryPoints
+
+template<class P>
+void
+lookup(P& p, const char* name) {
+	p = reinterpret_cast<P>(GLEAN::GLUtils::getProcAddress(name));
+} // lookup
+
+FillEntryPoints::FillEntryPoints() {
+	ActiveTexture = 0;
+	MultiTexCoord2f = 0;
+	shaders = false;
+
+	const float version = GLEAN::GLUtils::getVersion();
+	if (version >= 1.3) {
+		lookup(ActiveTexture, "glActiveTexture");
+		lookup(MultiTexCoord2f, "glMultiTexCoord2f");
+	} else if (GLEAN::GLUtils::haveExtension("GL_ARB_multitexture")) {
+		lookup(ActiveTexture, "glActiveTextureARB");
+		lookup(MultiTexCoord2f, "glMultiTexCoord2fARB");
+	}
+	if (!ActiveTexture || !MultiTexCoord2f)
+		ActiveTexture = 0;
+
+	if (version < 2.0)
+		return;
+	lookup(CreateShader, "glCreateShader");
+	lookup(ShaderSource, "glShaderSource");
+	lookup(CompileShader, "glCompileShader");
+	lookup(GetShaderiv, "glGetShaderiv");
+	lookup(DeleteShader, "glDeleteShader");
+	lookup(CreateProgram, "glCreateProgram");
+	lookup(AttachShader, "glAttachShader");
+	lookup(LinkProgram, "glLinkProgram");
+	lookup(GetProgramiv, "glGetProgramiv");
+	lookup(UseProgram, "glUseProgram");
+	lookup(DeleteProgram, "glDeleteProgram");
+	shaders = CreateShader && ShaderSource && CompileShader
+		&& GetShaderiv && DeleteShader && CreateProgram
+		&& AttachShader && LinkProgram && GetProgramiv
+		&& UseProgram && DeleteProgram;
+} // FillEntryPoints::FillEntryPoints
+
+///////////////////////////////////////////////////////////////////////////////
+// aluProgram:  Build a fragment program of aluOps dependent statements.
+//	fract() keeps the compiler from folding the chain together.
+///////////////////////////////////////////////////////////////////////////////
+GLuint
+aluProgram(const FillEntryPoints& gl, int aluOps) {
+	ostringstream src;
+	src << "void main() {\n"
+	    << "	vec4 c = gl_Color;\n";
+	for (int i = 0; i < aluOps; ++i)
+		src << "	c = fract(c * 1.618 + 0.1);\n";
+	src << "	gl_FragColor = c;\n"
+	    << "}\n";
+	const string s(src.str());
+	const GLchar* text = s.c_str();
+
+	GLint ok;
+	GLuint fs = gl.CreateShader(GL_FRAGMENT_SHADER);
+	gl.ShaderSource(fs, 1, &text, 0);
+	gl.CompileShader(fs);
+	gl.GetShaderiv(fs, GL_COMPILE_STATUS, &ok);
+	if (!ok) {
+		gl.DeleteShader(fs);
+		return 0;
+	}
+	GLuint program = gl.CreateProgram();
+	gl.AttachShader(program, fs);
+	gl.DeleteShader(fs);
+	gl.LinkProgram(program);
+	gl.GetProgramiv(program, GL_LINK_STATUS, &ok);
+	if (!ok) {
+		gl.DeleteProgram(program);
+		return 0;
+	}
+	return program;
+} // aluProgram
+
+///////////////////////////////////////////////////////////////////////////////
+// makeTexture:  A mipmapped texture of random texels, so that neither
+//	compression nor caching of constant texels flatters the result.
+///////////////////////////////////////////////////////////////////////////////
+GLuint
+makeTexture(GLenum internalFormat, GLenum filter) {
+	vector<GLubyte> texels(texSize * texSize * 4);
+	GLEAN::RandomBits rand(8, 271828);
+	for (size_t i = 0; i < texels.size(); ++i)
+		texels[i] = rand.next();
+
+	GLuint tex;
+	glGenTextures(1, &tex);
+	glBindTexture(GL_TEXTURE_2D, tex);
+	glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
+	glPixelStorei(GL_UNPACK_ROW_LENGTH, 0);
+	glPixelStorei(GL_UNPACK_SKIP_ROWS, 0);
+	glPixelStorei(GL_UNPACK_SKIP_PIXELS, 0);
+	gluBuild2DMipmaps(GL_TEXTURE_2D, internalFormat, texSize, texSize,
+		GL_RGBA, GL_UNSIGNED_BYTE, &texels[0]);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, filter);
+	glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER,
+		filter == GL_NEAREST? GL_NEAREST: GL_LINEAR);
+	return tex;
+} // makeTexture
+
+class FillTimer: public GLEAN::GPUTimer {
+public:
+	const FillCase* c;
+	const FillEntryPoints* gl;
+	GLfloat texScale;	// Texture coordinate span across the quad
+	GLEAN::Window* w;
+	GLEAN::Environment* env;
+
+	FillTimer(const FillCase* fc, const FillEntryPoints* e,
+		  GLEAN::Window* win, GLEAN::Environment* en) {
+		c = fc;
+		gl = e;
+		w = win;
+		env = en;
+		// One texel per pixel, except that trilinear filtering
+		// needs minification to blend two mipmap levels:
+		texScale = static_cast<GLfloat>(c->size) / texSize;
+		if (c->filter == GL_LINEAR_MIPMAP_LINEAR)
+			texScale *= 1.5;
+	}
+
+	virtual double compute(double t) {
+		return c->size * c->size / t / 1.0e6;
+	}
+	virtual void premeasure() {
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT
+			| GL_STENCIL_BUFFER_BIT);
+	}
+	virtual void postmeasure() { w->swap(); }
+	virtual void preop() { env->quiesce(); glFinish(); }
+	virtual void postop() { glFinish(); }
+	virtual void op() {
+		glBegin(GL_QUADS);
+		vertex(0.0, 0.0);
+		vertex(1.0, 0.0);
+		vertex(1.0, 1.0);
+		vertex(0.0, 1.0);
+		glEnd();
+	}
+
+private:
+	void vertex(GLfloat x, GLfloat y) {
+		if (c->texUnits == 1)
+			glTexCoord2f(x * texScale, y * texScale);
+		else
+			for (int u = 0; u < c->texUnits; ++u)
+				gl->MultiTexCoord2f(GL_TEXTURE0 + u,
+					x * texScale, y * texScale);
+		glVertex2f(x * c->size, y * c->size);
+	}
+}; // FillTimer
+
+void
+logCase(const GLEAN::FillSubResult& r, GLEAN::Environment* env) {
+	env->log << '\t' << r.name << " rate = " << r.rate
+		<< " Mpixels/sec.";
+	if (r.texUnits > 0)
+		env->log << "  (" << r.texelRate() << " Gtexels/sec.)";
+	env->log << "\n\t\t95% confidence interval = ["
+		<< r.rateLow << ", " << r.rateHigh << "]\n";
+	if (r.cpuRate > 0.0)
+		env->log << "\t\tCPU submission rate = "
+			<< r.cpuRate << " Mpixels/sec.\n";
+	if (r.gpuRate > 0.0)
+		env->log << "\t\tGPU execution rate = "
+			<< r.gpuRate << " Mpixels/sec.\n";
+} // logCase
+
+const GLEAN::FillSubResult*
+findCase(const GLEAN::FillPerfResult& r, const string& name) {
+	for (size_t i = 0; i < r.cases.size(); ++i)
+		if (r.cases[i].name == name)
+			return &r.cases[i];
+	return 0;
+} // findCase
+
+} // anonymous namespace
+
+namespace GLEAN {
+
+///////////////////////////////////////////////////////////////////////////////
+// runOne:  Run a single test case
+///////////////////////////////////////////////////////////////////////////////
+void
+FillRatePerf::runOne(FillPerfResult& r, Window& w) {
+	FillEntryPoints gl;
+	GLint maxUnits = 1;
+	if (gl.ActiveTexture)
+		glGetIntegerv(GL_MAX_TEXTURE_UNITS, &maxUnits);
+
+	GLUtils::useScreenCoords(fillSize, fillSize);
+	glDisable(GL_LIGHTING);
+	glDisable(GL_FOG);
+	glDisable(GL_SCISSOR_TEST);
+	glDisable(GL_ALPHA_TEST);
+	glDisable(GL_DITHER);
+	glDisable(GL_COLOR_LOGIC_OP);
+	glDisable(GL_CULL_FACE);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	glShadeModel(GL_SMOOTH);
+	glColor4f(0.75, 0.5, 0.25, 0.5);
+	glClearColor(0.0, 0.0, 0.0, 0.0);
+
+	for (int i = 0; i < nFillCases; ++i) {
+		const FillCase& c = fillCases[i];
+		if ((c.depth && r.config->z == 0)
+		 || (c.stencil && r.config->s == 0)
+		 || (c.texUnits > maxUnits)
+		 || (c.aluOps > 0 && !gl.shaders))
+			continue;
+
+		GLuint program = 0;
+		if (c.aluOps > 0 && !(program = aluProgram(gl, c.aluOps)))
+			continue;
+
+		if (c.depth) {
+			glEnable(GL_DEPTH_TEST);
+			glDepthFunc(GL_ALWAYS);
+			glDepthMask(GL_TRUE);
+		}
+		if (c.stencil) {
+			glEnable(GL_STENCIL_TEST);
+			glStencilFunc(GL_ALWAYS, 0, ~0);
+			glStencilOp(GL_KEEP, GL_KEEP, GL_INCR);
+			glStencilMask(~0);
+		}
+		if (c.blend) {
+			glEnable(GL_BLEND);
+			glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA);
+		}
+		vector<GLuint> textures;
+		for (int u = 0; u < c.texUnits; ++u) {
+			if (gl.ActiveTexture)
+				gl.ActiveTexture(GL_TEXTURE0 + u);
+			textures.push_back(makeTexture(c.texFormat,
+				c.filter));
+			glTexEnvi(GL_TEXTURE_ENV, GL_TEXTURE_ENV_MODE,
+				GL_MODULATE);
+			glEnable(GL_TEXTURE_2D);
+		}
+		if (program)
+			gl.UseProgram(program);
+
+		FillTimer timer(&c, &gl, &w, env);
+		FillSubResult s;
+		s.name = c.name;
+		s.texUnits = c.texUnits;
+		timer.measure(5, &s.rateLow, &s.rate, &s.rateHigh);
+		s.cpuRate = timer.submitAvg;
+		s.gpuRate = timer.gpuAvg;
+		s.samples = timer.stats.n();
+		r.cases.push_back(s);
+
+		if (program) {
+			gl.UseProgram(0);
+			gl.DeleteProgram(program);
+		}
+		for (int u = c.texUnits - 1; u >= 0; --u) {
+			if (gl.ActiveTexture)
+				gl.ActiveTexture(GL_TEXTURE0 + u);
+			glDisable(GL_TEXTURE_2D);
+		}
+		if (!textures.empty())
+			glDeleteTextures(textures.size(), &textures[0]);
+		glDisable(GL_BLEND);
+		glDisable(GL_STENCIL_TEST);
+		glDisable(GL_DEPTH_TEST);
+	}
+
+	r.pass = true;
+} // FillRatePerf::runOne
+
+///////////////////////////////////////////////////////////////////////////////
+// logOne:  Log a single test case
+///////////////////////////////////////////////////////////////////////////////
+void
+FillRatePerf::logOne(FillPerfResult& r) {
+	logPassFail(r);
+	logConcise(r);
+	logStats(r);
+} // FillRatePerf::logOne
+
+///////////////////////////////////////////////////////////////////////////////
+// compareOne:  Compare results for a single test case
+///////////////////////////////////////////////////////////////////////////////
+void
+FillRatePerf::compareOne(FillPerfResult& oldR, FillPerfResult& newR) {
+	bool same = true;
+	for (size_t i = 0; i < newR.cases.size(); ++i) {
+		const FillSubResult& n = newR.cases[i];
+		const FillSubResult* o = findCase(oldR, n.name);
+		if (!o || !significantlyDifferent(o->rateLow, o->rateHigh,
+		    n.rateLow, n.rateHigh))
+			continue;
+		const bool newFaster = n.rate > o->rate;
+		const double fast = newFaster? n.rate: o->rate;
+		const double slow = newFaster? o->rate: n.rate;
+		int percent = static_cast<int>(
+			100.0 * (fast - slow) / slow + 0.5);
+		if (same) {
+			same = false;
+			env->log << name << ":  DIFF "
+				<< newR.config->conciseDescription() << '\n';
+		}
+		env->log << '\t' << (newFaster? env->options.db2Name:
+				env->options.db1Name)
+			<< " is significantly faster on " << n.name
+			<< " (" << percent << "%).\n";
+	}
+
+	// Cases that only one run could measure:
+	const FillPerfResult* runs[2] = { &oldR, &newR };
+	const FillPerfResult* others[2] = { &newR, &oldR };
+	const string* names[2] = { &env->options.db1Name,
+		&env->options.db2Name };
+	for (int k = 0; k < 2; ++k)
+		for (size_t i = 0; i < runs[k]->cases.size(); ++i) {
+			const string& c = runs[k]->cases[i].name;
+			if (findCase(*others[k], c))
+				continue;
+			if (same) {
+				same = false;
+				env->log << name << ":  DIFF "
+					<< newR.config->conciseDescription()
+					<< '\n';
+			}
+			env->log << "\tOnly " << *names[k] << " measured "
+				<< c << ".\n";
+		}
+
+	if (same && env->options.verbosity)
+		env->log << name << ":  SAME "
+			<< newR.config->conciseDescription()
+			<< "\n\tNo significant difference in fill rate"
+			<< " between " << env->options.db1Name
+			<< " and " << env->options.db2Name << ".\n";
+
+	if (env->options.verbosity) {
+		env->log << env->options.db1Name << ':';
+		logStats(oldR);
+		env->log << env->options.db2Name << ':';
+		logStats(newR);
+	}
+} // FillRatePerf::compareOne
+
+void
+FillRatePerf::logStats(FillPerfResult& r) {
+	for (size_t i = 0; i < r.cases.size(); ++i)
+		logCase(r.cases[i], env);
+} // FillRatePerf::logStats
+
+///////////////////////////////////////////////////////////////////////////////
+// The test object itself:
+///////////////////////////////////////////////////////////////////////////////
+FillRatePerf fillRatePerfTest("fillRatePerf", "window, rgb, fast",
+
+	"This test measures fill rate:  how many pixels per second the\n"
+	"rasterizer can write when drawing large screen-aligned quads.\n"
+	"Starting from a baseline of window-sized (512x512), flat-colored\n"
+	"quads, each case changes one thing:  the quad size (128 and 256\n"
+	"pixels square); depth and/or stencil test and write on every\n"
+	"pixel; alpha blending; texturing (nearest, bilinear and trilinear\n"
+	"filtering; RGBA8, RGB5 and L8 formats; and 1, 2 and 4 texture\n"
+	"units); and fragment shaders of 8, 32 and 128 ALU statements.\n"
+	"Cases the drawing surface configuration or context can't support\n"
+	"are skipped.  The test runs on every matching configuration, so\n"
+	"that fill rate can be compared across color formats.\n"
+	"\n"
+	"Results are reported in megapixels per second, and for textured\n"
+	"cases also in gigatexels per second (texture units sampled per\n"
+	"pixel times pixels).\n"
+
+	);
+
+} // namespace GLEAN
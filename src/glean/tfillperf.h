@@ -0,0 +1,131 @@
+// BEGIN_COPYRIGHT -*- glean -*-
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+// tfillperf.h:  Test fill rate under various rasterization loads
+
+#ifndef __tfillperf_h__
+#define __tfillperf_h__
+
+#include <sstream>
+#include "tbase.h"
+
+namespace GLEAN {
+
+#define fillSize 512	// Window size, and the size of the largest quads
+
+// Auxiliary struct for holding the fill rate of one case:
+class FillSubResult {
+public:
+	string name;		// Case name (no whitespace)
+	int texUnits;		// Texture units sampled per pixel
+	double rate;		// Megapixels per second
+	double rateLow;		// Low end of rate range
+	double rateHigh;	// High end of rate range
+	double cpuRate;		// rate based on CPU submission time only
+	double gpuRate;		// rate based on GPU execution time (0 if
+				// timer queries aren't supported)
+	int samples;		// Number of timings behind rate (not
+				// saved; only for --export)
+
+	FillSubResult() {
+		texUnits = 0;
+		rate = rateLow = rateHigh = cpuRate = gpuRate = 0.0;
+		samples = 0;
+	}
+
+	// Gigatexels per second:
+	double texelRate() const { return rate * texUnits / 1000.0; }
+
+	void put(ostream& s) const {
+		s << name
+		  << ' ' << texUnits
+		  << ' ' << rate
+		  << ' ' << rateLow
+		  << ' ' << rateHigh
+		  << ' ' << cpuRate
+		  << ' ' << gpuRate
+		  << '\n';
+	}
+
+	void get(istream& s) {
+		s >> name >> texUnits >> rate >> rateLow >> rateHigh
+		  >> cpuRate >> gpuRate;
+	}
+
+	void measurements(vector<Measurement>& m) const {
+		m.push_back(Measurement(name, "Mpixel/s", rate, rateLow,
+			rateHigh, samples));
+		if (cpuRate > 0.0)
+			m.push_back(Measurement(name + ".cpu", "Mpixel/s",
+				cpuRate, samples));
+		if (gpuRate > 0.0)
+			m.push_back(Measurement(name + ".gpu", "Mpixel/s",
+				gpuRate, samples));
+		if (texUnits > 0)
+			m.push_back(Measurement(name + ".texel", "Gtexel/s",
+				texelRate(), rateLow * texUnits / 1000.0,
+				rateHigh * texUnits / 1000.0, samples));
+	}
+};
+
+class FillPerfResult: public BaseResult {
+public:
+	bool pass;
+	vector<FillSubResult> cases;	// The cases this config could run
+
+	virtual void putresults(ostream& s) const {
+		s << pass << '\n' << cases.size() << '\n';
+		for (size_t i = 0; i < cases.size(); ++i)
+			cases[i].put(s);
+	}
+
+	virtual bool getresults(istream& s) {
+		size_t n = 0;
+		s >> pass >> n;
+		cases.resize(n);
+		for (size_t i = 0; i < n; ++i)
+			cases[i].get(s);
+		return s.good();
+	}
+
+	virtual void measurements(vector<Measurement>& m) const {
+		for (size_t i = 0; i < cases.size(); ++i)
+			cases[i].measurements(m);
+	}
+};
+
+class FillRatePerf: public BaseTest<FillPerfResult> {
+public:
+	GLEAN_CLASS_WH(FillRatePerf, FillPerfResult, fillSize, fillSize);
+	void logStats(FillPerfResult& r);
+	virtual bool isBenchmark() const { return true; }
+}; // class FillRatePerf
+
+} // namespace GLEAN
+
+#endif // __tfillperf_h__
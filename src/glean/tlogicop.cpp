@@ -207,10 +207,10 @@ static int bitDifference(GLbyte a, GLubyte b) {
 	return count;
 }
 
-static GLubyte redMask, greenMask, blueMask, alphaMask;
-
 static void
 computeError(const GLubyte aPix[4], const GLubyte ePix[4],
+		GLubyte redMask, GLubyte greenMask,
+		GLubyte blueMask, GLubyte alphaMask,
 		int &er, int &eg, int &eb, int &ea) {
 	if ((aPix[0] & redMask  ) == (ePix[0] & redMask  ) &&
 	    (aPix[1] & greenMask) == (ePix[1] & greenMask) &&
@@ -238,10 +238,10 @@ runTest(GLenum logicop,
 	int y;
 
 	// Compute error bitmasks depending on color channel sizes
-	redMask   = ((1 << config.r) - 1) << (8 - config.r);
-	greenMask = ((1 << config.g) - 1) << (8 - config.g);
-	blueMask  = ((1 << config.b) - 1) << (8 - config.b);
-	alphaMask = ((1 << config.a) - 1) << (8 - config.a);
+	GLubyte redMask   = ((1 << config.r) - 1) << (8 - config.r);
+	GLubyte greenMask = ((1 << config.g) - 1) << (8 - config.g);
+	GLubyte blueMask  = ((1 << config.b) - 1) << (8 - config.b);
+	GLubyte alphaMask = ((1 << config.a) - 1) << (8 - config.a);
 
 	glDisable(GL_DITHER);
 	glClear(GL_COLOR_BUFFER_BIT);
@@ -331,7 +331,8 @@ runTest(GLenum logicop,
 		GLubyte* ePix = reinterpret_cast<GLubyte*>(dRow);
 		for (int x = 0; x < drawingSize; ++x) {
 			int rErr, gErr, bErr, aErr;
-			computeError(aPix, ePix, rErr, gErr, bErr, aErr);
+			computeError(aPix, ePix, redMask, greenMask,
+				blueMask, alphaMask, rErr, gErr, bErr, aErr);
 			result.logicopErrorBits = rErr + gErr + bErr + aErr;
 
 			if (result.logicopErrorBits > 1.0) {
@@ -340,7 +341,7 @@ GLubyte* sPix = reinterpret_cast<GLubyte*>(src.pixels()
 	+ y * src.rowSizeInBytes() + x * 4 * sizeof(GLubyte));
 GLubyte* dPix = reinterpret_cast<GLubyte*>(dst.pixels()
 	+ y * dst.rowSizeInBytes() + x * 4 * sizeof(GLubyte));
-env.log << '\n'
+jobLog(env) << '\n'
 << "First failing pixel is at row " << y << " column " << x << "\n"
 << "Actual values are (" << (int) aPix[0] << ", " << (int) aPix[1] << ", "
 	<< (int) aPix[2] << ", " << (int) aPix[3] << ")\n"
@@ -410,7 +411,7 @@ LogicopFuncTest::runOne(LogicopFuncResult& r, Window& w) {
 		r.results.push_back(p);
 
 		if (p.rbErr > 1.0 || p.opErr > 1.0) {
-			env->log << name << ":  FAIL "
+			jobLog(*env) << name << ":  FAIL "
 				<< r.config->conciseDescription()<< '\n'
 				<< "\tlogicop mode = "
 				<< logicopToName(p.logicop)
@@ -59,6 +59,7 @@ class LogicopFuncTest: public BaseTest<LogicopFuncResult> {
 public:
 	GLEAN_CLASS_WH(LogicopFuncTest, LogicopFuncResult,
 		       windowSize, windowSize);
+	virtual bool isConfigParallel() const { return true; }
 }; // class LogicopFuncTest
 
 } // namespace GLEAN
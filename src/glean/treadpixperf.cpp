@@ -43,6 +43,12 @@ static PFNGLBUFFERDATAARBPROC BufferData = NULL;
 static PFNGLMAPBUFFERARBPROC MapBuffer = NULL;
 static PFNGLUNMAPBUFFERARBPROC UnmapBuffer = NULL;
 static PFNGLGETBUFFERSUBDATAARBPROC GetBufferSubData = NULL;
+static PFNGLGENBUFFERSARBPROC GenBuffers = NULL;
+static PFNGLDELETEBUFFERSARBPROC DeleteBuffers = NULL;
+static PFNGLMAPBUFFERRANGEPROC MapBufferRange = NULL;
+static PFNGLFENCESYNCPROC FenceSync = NULL;
+static PFNGLDELETESYNCPROC DeleteSync = NULL;
+static PFNGLCLIENTWAITSYNCPROC ClientWaitSync = NULL;
 
 const GLuint PBO1 = 42, PBO2 = 43;
 
@@ -97,6 +103,14 @@ static const char *PBOmodeStrings[4] =
 };
 
 
+// Formats (indexes into Formats[]) for the asynchronous ring test.
+// These are the usual choices for video capture; both are four bytes
+// per pixel.
+static const int AsyncFormats[] = { 2, 7 };
+static const int numAsyncFormats = 2;
+static const int maxRingDepth = 8;
+
+
 static bool
 isDepthFormat(GLenum format)
 {
@@ -161,6 +175,26 @@ ReadpixPerfResult::SubResult::print(Environment *env) const
 }
 
 
+void
+ReadpixPerfResult::AsyncResult::sprint(char *s) const
+{
+	sprintf(s, "async glReadPixels(%d x %d, %s), %d-deep PBO ring, %s",
+		windowSize, windowSize, Formats[formatNum].Name, depth,
+		mapRange ? "glMapBufferRange" : "glMapBuffer");
+}
+
+
+void
+ReadpixPerfResult::AsyncResult::print(Environment *env) const
+{
+	char descrip[1000], str[1100];
+	sprint(descrip);
+	sprintf(str, "\t%.1f MB/second, latency %.3f ms (95%%: %.3f ms): %s\n",
+		rate, latency, latency95, descrip);
+	env->log << str;
+}
+
+
 static void
 SimpleRender()
 {
@@ -308,6 +342,123 @@ ReadpixPerfTest::runPBOtest(int formatNum, GLsizei width, GLsizei height,
 
 
 
+// Sustained readback with a ring of res.depth PBOs.  Each frame is
+// rendered (a clear to one of eight colors), read into the next PBO in
+// the ring, and fenced.  Once res.depth reads are in flight, the oldest
+// one's fence is waited on, then its PBO is mapped and every byte
+// summed, as a capture client would consume it.  Rendering and reading
+// later frames thus overlaps the wait for earlier ones.
+// Fills in the rate and latency fields of res; returns false if any
+// frame read back the wrong data.
+bool
+ReadpixPerfTest::runAsyncTest(ReadpixPerfResult::AsyncResult &res,
+			      GLsizei width, GLsizei height)
+{
+#ifdef GL_ARB_pixel_buffer_object
+	const ImageFormat &format = Formats[res.formatNum];
+	const GLsizei bufferSize = width * height * format.Bytes;
+	const int depth = res.depth;
+	GLuint pbos[maxRingDepth];
+	GLsync fences[maxRingDepth];
+	int frameOf[maxRingDepth];
+	double issued[maxRingDepth];
+	bool ok = true;
+
+	glPixelStorei(GL_PACK_ALIGNMENT, 1);
+	GenBuffers(depth, pbos);
+	for (int i = 0; i < depth; i++) {
+		BindBuffer(GL_PIXEL_PACK_BUFFER_ARB, pbos[i]);
+		BufferData(GL_PIXEL_PACK_BUFFER_ARB, bufferSize, NULL,
+			   GL_STREAM_READ_ARB);
+	}
+
+	RobustStats latency;
+	Timer t;
+	int frame = 0, pending = 0;
+	double start = t.getClock(), finish = start;
+
+	// Issue frames until the interval is up, then drain the ring:
+	for (;;) {
+		const bool draining = finish - start >= minInterval;
+		if (!draining) {
+			const int slot = frame % depth;
+			// Each channel is 0 or 1, so the color reads back
+			// the same at any color depth:
+			glClearColor(frame & 1, (frame >> 1) & 1,
+				     (frame >> 2) & 1, 1.0);
+			glClear(GL_COLOR_BUFFER_BIT);
+			BindBuffer(GL_PIXEL_PACK_BUFFER_ARB, pbos[slot]);
+			issued[slot] = t.getClock();
+			glReadPixels(0, 0, width, height,
+				     format.Format, format.Type, NULL);
+			fences[slot] = FenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE,
+						 0);
+			frameOf[slot] = frame;
+			frame++;
+			pending++;
+		}
+		if (pending == 0)
+			break;
+		if (pending < depth && !draining) {
+			finish = t.getClock();
+			continue;
+		}
+
+		// retire the oldest read in flight
+		const int slot = (frame - pending) % depth;
+		GLenum status;
+		do {
+			status = ClientWaitSync(fences[slot],
+						GL_SYNC_FLUSH_COMMANDS_BIT,
+						1000000000);  // 1 second
+		} while (status == GL_TIMEOUT_EXPIRED);
+		DeleteSync(fences[slot]);
+		if (status == GL_WAIT_FAILED)
+			ok = false;
+
+		BindBuffer(GL_PIXEL_PACK_BUFFER_ARB, pbos[slot]);
+		const GLubyte *b = (const GLubyte *) (res.mapRange ?
+			MapBufferRange(GL_PIXEL_PACK_BUFFER_ARB, 0, bufferSize,
+				       GL_MAP_READ_BIT) :
+			MapBuffer(GL_PIXEL_PACK_BUFFER_ARB, GL_READ_ONLY));
+		finish = t.getClock();
+		latency.sample(1000.0 * (finish - issued[slot]));
+		if (b) {
+			GLuint sum = 0;
+			for (int i = 0; i < bufferSize; i++) {
+				sum += b[i];
+			}
+			UnmapBuffer(GL_PIXEL_PACK_BUFFER_ARB);
+
+			const int f = frameOf[slot];
+			const GLuint pixelSum = 255 * ((f & 1) + ((f >> 1) & 1)
+				+ ((f >> 2) & 1) + 1);  // alpha is always 1
+			if (sum != pixelSum * width * height)
+				ok = false;
+		}
+		else {
+			ok = false;
+		}
+		pending--;
+		finish = t.getClock();
+	}
+
+	BindBuffer(GL_PIXEL_PACK_BUFFER_ARB, 0);
+	DeleteBuffers(depth, pbos);
+
+	const double elapsedTime = finish - start;
+	res.frames = frame;
+	res.rate = static_cast<double>(bufferSize) * frame / elapsedTime
+		/ 1000000.0;
+	res.latency = latency.median();
+	res.latency95 = latency.percentile(95.0);
+	return ok;
+#else
+	return false;
+#endif /* GL_ARB_pixel_buffer_object */
+}
+
+
 // Per visual setup.
 void
 ReadpixPerfTest::setup(void)
@@ -333,12 +484,40 @@ ReadpixPerfTest::setup(void)
 		GetBufferSubData = (PFNGLGETBUFFERSUBDATAARBPROC)
 			GLUtils::getProcAddress("glGetBufferSubDataARB");
 		assert(GetBufferSubData);
+		GenBuffers = (PFNGLGENBUFFERSARBPROC)
+			GLUtils::getProcAddress("glGenBuffersARB");
+		assert(GenBuffers);
+		DeleteBuffers = (PFNGLDELETEBUFFERSARBPROC)
+			GLUtils::getProcAddress("glDeleteBuffersARB");
+		assert(DeleteBuffers);
 		numPBOmodes = 4;
 	}
 	else {
 		numPBOmodes = 1;
 	}
 
+	// The asynchronous ring test needs fences (OpenGL 3.2 or
+	// GL_ARB_sync), and can map with glMapBufferRange if it's there.
+	haveAsync = false;
+	haveMapRange = false;
+	const float version = GLUtils::getVersion();
+	if (numPBOmodes > 1
+	    && (version >= 3.2 || GLUtils::haveExtensions("GL_ARB_sync"))) {
+		FenceSync = (PFNGLFENCESYNCPROC)
+			GLUtils::getProcAddress("glFenceSync");
+		DeleteSync = (PFNGLDELETESYNCPROC)
+			GLUtils::getProcAddress("glDeleteSync");
+		ClientWaitSync = (PFNGLCLIENTWAITSYNCPROC)
+			GLUtils::getProcAddress("glClientWaitSync");
+		haveAsync = FenceSync && DeleteSync && ClientWaitSync;
+	}
+	if (haveAsync && (version >= 3.0
+	    || GLUtils::haveExtensions("GL_ARB_map_buffer_range"))) {
+		MapBufferRange = (PFNGLMAPBUFFERRANGEPROC)
+			GLUtils::getProcAddress("glMapBufferRange");
+		haveMapRange = MapBufferRange != NULL;
+	}
+
 	// Fill colorbuffer with random data
 	GLubyte *buffer = new GLubyte [windowSize * windowSize * 4];
 	for (int i = 0; i < windowSize * windowSize * 4; i++)
@@ -431,6 +610,30 @@ ReadpixPerfTest::runOne(ReadpixPerfResult &r, Window &w)
 			}
 		}
 	}
+
+	if (!haveAsync)
+		return;
+
+	ReadpixPerfResult::AsyncResult ares;
+	for (int i = 0; i < numAsyncFormats; i++) {
+		ares.formatNum = AsyncFormats[i];
+		for (ares.mapRange = 0; ares.mapRange <= int(haveMapRange);
+		     ares.mapRange++) {
+			for (ares.depth = 1; ares.depth <= maxRingDepth;
+			     ares.depth++) {
+				if (!runAsyncTest(ares, windowSize, windowSize)) {
+					char s0[1000];
+					ares.sprint(s0);
+					env->log << name
+						 << " Error: wrong data read back by "
+						 << s0 << "\n";
+					r.pass = false;
+				}
+				ares.print(env);
+				r.asyncResults.push_back(ares);
+			}
+		}
+	}
 }
 
 
@@ -475,6 +678,43 @@ ReadpixPerfTest::compareOne(ReadpixPerfResult &oldR,
 					 << " MPixels/sec)\n";
 			}
 		}
+
+		// Results files written before the asynchronous test have
+		// no async results; match the rest by their parameters.
+		for (ReadpixPerfResult::async_iterator it = newR.asyncResults.begin();
+		     it != newR.asyncResults.end(); ++it) {
+			const ReadpixPerfResult::AsyncResult &newres = *it;
+			ReadpixPerfResult::async_iterator old;
+			for (old = oldR.asyncResults.begin();
+			     old != oldR.asyncResults.end(); ++old) {
+				if (old->formatNum == newres.formatNum
+				    && old->depth == newres.depth
+				    && old->mapRange == newres.mapRange)
+					break;
+			}
+			if (old == oldR.asyncResults.end())
+				continue;
+
+			double diff = (newres.rate - old->rate) / newres.rate;
+			diff *= 100.0;
+			if (fabs(diff) >= threshold) {
+				char descrip[1000];
+				newres.sprint(descrip);
+				env->log << name << ": Warning: rate for '"
+					 << descrip
+					 << "' changed by "
+					 << diff
+					 << " percent (new: "
+					 << newres.rate
+					 << " old: "
+					 << old->rate
+					 << " MB/sec, latency new: "
+					 << newres.latency
+					 << " old: "
+					 << old->latency
+					 << " ms)\n";
+			}
+		}
 	}
 	else {
 		// one test or the other failed
@@ -504,6 +744,18 @@ ReadpixPerfResult::putresults(ostream &s) const
                 s << res.readBuf << '\n';
 		s << res.work << '\n';
 	}
+	s << "async " << asyncResults.size() << '\n';
+	for (ReadpixPerfResult::async_iterator it = asyncResults.begin();
+	     it != asyncResults.end();
+	     ++it) {
+		s << it->formatNum << ' '
+		  << it->depth << ' '
+		  << it->mapRange << ' '
+		  << it->frames << ' '
+		  << it->rate << ' '
+		  << it->latency << ' '
+		  << it->latency95 << '\n';
+	}
 }
 
 
@@ -528,7 +780,53 @@ ReadpixPerfResult::getresults(istream &s)
 		  >> res.work;
 		results.push_back(res);
 	}
-	return s.good();
+
+	// Results files written before the asynchronous test end here:
+	bool ok = s.good();
+	if (ok && (s >> ws).peek() == 'a') {
+		string tag;
+		s >> tag >> count;
+		asyncResults.reserve(count);
+		for (int i = 0; i < count; i++) {
+			ReadpixPerfResult::AsyncResult res;
+			s >> res.formatNum
+			  >> res.depth
+			  >> res.mapRange
+			  >> res.frames
+			  >> res.rate
+			  >> res.latency
+			  >> res.latency95;
+			asyncResults.push_back(res);
+		}
+		ok = s.good();
+	}
+	return ok;
+}
+
+
+// One measurement per sub result, named for the sub result's parameters
+void
+ReadpixPerfResult::measurements(vector<Measurement>& m) const
+{
+	for (ReadpixPerfResult::sub_iterator it = results.begin();
+	     it != results.end();
+	     ++it) {
+		char descrip[1000];
+		it->sprint(descrip);
+		m.push_back(Measurement(descrip, "Mpixel/s", it->rate));
+	}
+	for (ReadpixPerfResult::async_iterator it = asyncResults.begin();
+	     it != asyncResults.end();
+	     ++it) {
+		char descrip[1000];
+		it->sprint(descrip);
+		m.push_back(Measurement(descrip, "MB/s", it->rate,
+					it->frames));
+		m.push_back(Measurement(string(descrip) + ", latency", "ms",
+					it->latency, it->frames));
+		m.push_back(Measurement(string(descrip) + ", latency95", "ms",
+					it->latency95, it->frames));
+	}
 }
 
 
@@ -542,6 +840,13 @@ ReadpixPerfTest readpixperfTest("readpixPerf", "window, rgb",
 	"GL_STREAM_READ_ARB, GL_STATIC_READ_ARB and GL_DYNAMIC_READ_ARB.\n"
 	"Furthermore, test effect of summing the value of all image bytes\n"
 	"to simulate host-based image processing.\n"
+	"When fences are available (OpenGL 3.2 or GL_ARB_sync), we also\n"
+	"measure sustained asynchronous readback, as used for video\n"
+	"capture:  each frame is rendered, read into the next PBO of a\n"
+	"ring 1 to 8 deep, and fenced; the oldest read is mapped (with\n"
+	"glMapBuffer, and with glMapBufferRange where available) only\n"
+	"after its fence signals.  This reports MB/second and the latency\n"
+	"from glReadPixels to mapped data.\n"
 	);
 
 
@@ -53,14 +53,33 @@ public:
 		char readBuf[10]; // "GL_FRONT" or "GL_BACK"
 	};	
 
+	// Sustained readback through a ring of PBOs, each read fenced
+	// and mapped only once the fence has signaled:
+	struct AsyncResult
+	{
+		int formatNum;
+		int depth;	// number of PBOs (reads in flight)
+		int mapRange;	// glMapBufferRange rather than glMapBuffer
+				// (really bool)
+		int frames;	// number of frames read
+		double rate;	// MB/second
+		double latency;	// median ms from glReadPixels to mapped data
+		double latency95; // 95th percentile of the same
+		void sprint(char *s) const;
+		void print(Environment *env) const;
+	};
+
 	bool pass;
 
 	vector<SubResult> results;
+	vector<AsyncResult> asyncResults;
 
 	typedef vector<ReadpixPerfResult::SubResult>::const_iterator sub_iterator;
+	typedef vector<ReadpixPerfResult::AsyncResult>::const_iterator async_iterator;
 
 	virtual void putresults(ostream& s) const;
 	virtual bool getresults(istream& s);
+	virtual void measurements(vector<Measurement>& m) const;
 };
 
 
@@ -69,15 +88,19 @@ class ReadpixPerfTest: public BaseTest<ReadpixPerfResult>
 public:
 	GLEAN_CLASS_WH(ReadpixPerfTest, ReadpixPerfResult,
 		       windowSize, windowSize);
+	virtual bool isBenchmark() const { return true; }
 
 private:
         int depthBits, stencilBits;
 	int numPBOmodes;
+	bool haveAsync, haveMapRange;
 
 	double runPBOtest(int formatNum, GLsizei width, GLsizei height,
 			  GLenum bufferUsage, GLuint *sumOut);
 	double runNonPBOtest(int formatNum, GLsizei width, GLsizei height,
 			     GLuint *sumOut);
+	bool runAsyncTest(ReadpixPerfResult::AsyncResult &res,
+			  GLsizei width, GLsizei height);
 
         void setup(void);
 };
@@ -33,6 +33,7 @@
 #include "rand.h"
 #include "geomutil.h"
 #include "image.h"
+#include "readback.h"
 
 #if 0
 #if defined __UNIX__
@@ -104,11 +105,22 @@ RGBTriStripTest::runOne(RGBTriStripResult& r, Window& w) {
 	}
 	w.swap();
 
-	Image image(drawingSize + 2, drawingSize + 2, GL_RGB, GL_FLOAT);
-	image.read(0, 0);	// Invoke glReadPixels to read the image.
-	image.writeTIFF(env->imageFileName(name, r.imageNumber));
-
-	r.pass = true;
+	// Stream the image from the framebuffer to its file a band of
+	// rows at a time.  The bands are also checked against a plain
+	// whole-frame read, so that a fault in the banded (or PBO)
+	// readback path shows up as a failure here:
+	Image whole(drawingSize + 2, drawingSize + 2, GL_RGB, GL_FLOAT);
+	whole.read(0, 0);
+	BandedReadback readback(env->options.readbackRows);
+	TIFFBandWriter tiff(env->imageFileName(name, r.imageNumber));
+	BandDiff check(whole);
+	readback.add(tiff);
+	readback.add(check);
+	readback.read(0, 0, drawingSize + 2, drawingSize + 2, GL_RGB,
+		GL_FLOAT);
+
+	r.badPixels = check.difference().pixels;
+	r.pass = r.badPixels == 0;
 } // RGBTriStripTest::runOne
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -116,9 +128,12 @@ RGBTriStripTest::runOne(RGBTriStripResult& r, Window& w) {
 ///////////////////////////////////////////////////////////////////////////////
 void
 RGBTriStripTest::logOne(RGBTriStripResult& r) {
-	env->log << name << ":  NOTE "
+	env->log << name << (r.pass? ":  NOTE ": ":  FAIL ")
 		 << r.config->conciseDescription() << '\n'
 		 << "\tImage number " << r.imageNumber << '\n';
+	if (!r.pass)
+		env->log << "\tBanded readback differed from a whole-frame "
+			"read at " << r.badPixels << " pixels.\n";
 	if (env->options.verbosity)
 		env->log <<
 		   "\tThis test does not check its result.  Please view\n"
@@ -132,11 +147,12 @@ RGBTriStripTest::logOne(RGBTriStripResult& r) {
 ///////////////////////////////////////////////////////////////////////////////
 void
 RGBTriStripTest::compareOne(RGBTriStripResult& oldR, RGBTriStripResult& newR) {
-	// Fetch the old and new images:
+	// Fetch the old and new images.  They're only examined, so
+	// uncompressed ones can be left in their files:
 	Image oldI;
-	oldI.readTIFF(env->image1FileName(name, oldR.imageNumber));
+	oldI.mapTIFF(env->image1FileName(name, oldR.imageNumber));
 	Image newI;
-	newI.readTIFF(env->image2FileName(name, newR.imageNumber));
+	newI.mapTIFF(env->image2FileName(name, newR.imageNumber));
 
 	// Register the images, and gather statistics about the differences
 	// for each color channel:
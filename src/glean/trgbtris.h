@@ -41,6 +41,9 @@ class RGBTriStripResult: public BaseResult {
 public:
 	bool pass;
 	int  imageNumber;
+	int  badPixels;		// Pixels where the banded readback
+				// differed from a whole-frame read
+				// (not saved in the results file)
 
 	void putresults(ostream& s) const {
 		s << imageNumber << '\n';
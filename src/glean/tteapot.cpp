@@ -26,8 +26,11 @@
 // 
 // END_COPYRIGHT
 
+#include <algorithm>
+#include <iomanip>
 #include "tteapot.h"
-#include "timer.h"
+#include "gputimer.h"
+#include "glutils.h"
 
 namespace {
 
@@ -3039,6 +3042,148 @@ int stripIndices[] = {
 	0
 };
 
+
+enum DrawPath {
+	pathImmediate,		// glBegin/glNormal/glVertex/glEnd
+	pathArrays,		// glDrawElements from client-side arrays
+	pathVBO,		// glDrawElements from buffer objects
+	nPaths
+};
+const char* const pathNames[nPaths] = { "immediate", "arrays", "vbo" };
+
+const int nTeapotVertices = sizeof(vertexArrayData) / (6 * sizeof(GLfloat));
+
+// The quad strips in stripIndices, unpacked into a single index array
+// that glDrawElements can draw a strip at a time:
+struct Strips {
+	vector<GLuint> indices;
+	vector<size_t> first;		// Offset of each strip in indices
+	vector<GLsizei> count;		// Number of indices in each strip
+
+	Strips() {
+		for (const int* p = stripIndices; *p; ) {
+			int n = *p++;
+			first.push_back(indices.size());
+			count.push_back(n);
+			for (; n; --n, ++p)
+				indices.push_back(*p);
+		}
+	}
+}; // Strips
+
+///////////////////////////////////////////////////////////////////////////////
+// drawTeapot:  Draw the teapot through one submission path.  For the
+//	arrays and vbo paths, starts holds the address (or buffer offset)
+//	of each strip's indices.
+///////////////////////////////////////////////////////////////////////////////
+void
+drawTeapot(DrawPath path, const Strips& strips,
+    const vector<const GLvoid*>& starts) {
+	if (path == pathImmediate) {
+		for (const int* p = stripIndices; *p; ) {
+			glBegin(GL_QUAD_STRIP);
+			for (int n = *p++; n; --n, ++p) {
+				const GLfloat* v = vertexArrayData + 6 * *p;
+				glNormal3fv(v);
+				glVertex3fv(v + 3);
+			}
+			glEnd();
+		}
+	} else {
+		for (size_t i = 0; i < starts.size(); ++i)
+			glDrawElements(GL_QUAD_STRIP, strips.count[i],
+				GL_UNSIGNED_INT, starts[i]);
+	}
+} // drawTeapot
+
+///////////////////////////////////////////////////////////////////////////////
+// timeFrames:  Draw warmup frames untimed, then time each of frames more.
+//	A frame's CPU time runs from the return of one swap to the return
+//	of the next.  Its GPU time is read a few frames later, so that
+//	reading it doesn't drain the pipeline.
+///////////////////////////////////////////////////////////////////////////////
+void
+timeFrames(DrawPath path, const Strips& strips,
+    const vector<const GLvoid*>& starts, int warmup, int frames,
+    GLEAN::Window& w, vector<double>& cpuMs, vector<double>& gpuMs) {
+	GLEAN::GPUTimer gpu;
+	const bool haveGPU = gpu.available();
+	const int lag = GLEAN::GPUTimer::ringSize - 1;
+
+	glFinish();
+	double prev = GLEAN::Timer::getClock();
+	for (int f = -warmup; f < frames; ++f) {
+		const GLfloat angle = (f + warmup) % 360;
+		if (f >= 0)
+			gpu.startBatch();
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		glPushMatrix();
+		glRotatef(angle, 1.0, 0.0, 0.0);
+		glRotatef(angle, 0.0, 1.0, 0.0);
+		drawTeapot(path, strips, starts);
+		glPopMatrix();
+		if (f >= 0)
+			gpu.finishBatch();
+		w.swap();
+
+		const double now = GLEAN::Timer::getClock();
+		if (f >= 0) {
+			cpuMs.push_back(1000.0 * (now - prev));
+			if (haveGPU && f >= lag)
+				gpuMs.push_back(1000.0
+					* gpu.laggedBatchTime(lag));
+		}
+		prev = now;
+	}
+
+	if (haveGPU) {
+		glFinish();
+		const int pending = (frames < lag)? frames: lag;
+		for (int age = pending - 1; age >= 0; --age)
+			gpuMs.push_back(1000.0 * gpu.laggedBatchTime(age));
+	}
+} // timeFrames
+
+///////////////////////////////////////////////////////////////////////////////
+// summarize:  Reduce per-frame times to percentiles and a histogram
+///////////////////////////////////////////////////////////////////////////////
+void
+summarize(vector<double>& cpuMs, vector<double>& gpuMs,
+    GLEAN::TeapotPathResult& r) {
+	typedef GLEAN::TeapotPathResult P;
+	GLEAN::RobustStats cpu(cpuMs);
+	r.frames = cpu.n();
+	if (r.frames == 0)
+		return;
+	double total = 0.0;
+	for (size_t i = 0; i < cpuMs.size(); ++i)
+		total += cpuMs[i];
+	r.fps = (total > 0.0)? 1000.0 * r.frames / total: 0.0;
+	r.p50 = cpu.median();
+	cpu.bootstrapCI(0.95, &r.p50Low, &r.p50High);
+	r.p95 = cpu.percentile(95.0);
+	r.p99 = cpu.percentile(99.0);
+	r.worst = cpu.percentile(100.0);
+
+	r.spikes = 0;
+	for (size_t i = 0; i < cpuMs.size(); ++i) {
+		if (cpuMs[i] > 2.0 * r.p50)
+			++r.spikes;
+		int bin = 0;
+		while (bin < P::nBins - 1 && cpuMs[i] >= P::binLimit(bin))
+			++bin;
+		++r.histogram[bin];
+	}
+
+	if (!gpuMs.empty()) {
+		GLEAN::RobustStats gpu(gpuMs);
+		r.gpuP50 = gpu.median();
+		r.gpuP95 = gpu.percentile(95.0);
+		r.gpuP99 = gpu.percentile(99.0);
+		r.gpuWorst = gpu.percentile(100.0);
+	}
+} // summarize
+
 } // anonymous namespace
 
 namespace GLEAN {
@@ -3132,44 +3277,68 @@ TeapotTest::runOne(TeapotResult& res, Window& w) {
 
 ///////////////////////// End of materials set-up //////////////////////
 
-	glInterleavedArrays( GL_N3F_V3F, 0, vertexArrayData );
-	glEnableClientState( GL_VERTEX_ARRAY );
-	glEnableClientState( GL_NORMAL_ARRAY );
-
+	GLUtils::BufferFuncs gl;
+	Strips strips;
+	const int warmup = env->options.quick? 10: 30;
+	const int frames = env->options.quick? 120: 360;
 
-	// XXX The timing code here doesn't calibrate the timer
-	// overhead, doesn't scale the size of the test to insure
-	// consistent results on a wide range of hardware, and doesn't
-	// flush the pipeline before or after rendering, so the
-	// numbers that result are only a rough approximation of the
-	// actual performance.  A better solution would be to use the
-	// timing methodology that's illustrated in tchgperf.cpp.
+	res.fTps = 0.0;
+	for (int p = 0; p < nPaths; ++p) {
+		const DrawPath path = static_cast<DrawPath>(p);
+		const vector<string>& selected = env->options.drawPaths;
+		if (!selected.empty() && find(selected.begin(),
+		    selected.end(), pathNames[p]) == selected.end())
+			continue;
+		if (path == pathVBO && !gl.have)
+			continue;
 
-	Timer tTimer;
-	double start = tTimer.getClock();
-
-	const int startX = 0;
-	const int endX = 360;
+		vector<const GLvoid*> starts;
+		GLuint buffers[2] = { 0, 0 };
+		if (path == pathVBO) {
+			gl.GenBuffers(2, buffers);
+			gl.BindBuffer(GL_ARRAY_BUFFER_ARB, buffers[0]);
+			gl.BufferData(GL_ARRAY_BUFFER_ARB,
+				sizeof(vertexArrayData), vertexArrayData,
+				GL_STATIC_DRAW_ARB);
+			gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER_ARB, buffers[1]);
+			gl.BufferData(GL_ELEMENT_ARRAY_BUFFER_ARB,
+				strips.indices.size() * sizeof(GLuint),
+				&strips.indices[0], GL_STATIC_DRAW_ARB);
+			glInterleavedArrays(GL_N3F_V3F, 0,
+				GLUtils::bufferOffset(0));
+			for (size_t i = 0; i < strips.first.size(); ++i)
+				starts.push_back(GLUtils::bufferOffset(
+					strips.first[i] * sizeof(GLuint)));
+		} else if (path == pathArrays) {
+			glInterleavedArrays(GL_N3F_V3F, 0, vertexArrayData);
+			for (size_t i = 0; i < strips.first.size(); ++i)
+				starts.push_back(&strips.indices[0]
+					+ strips.first[i]);
+		}
 
-	for (int rotX=startX; rotX < endX; rotX++) {
-		glClear(GL_COLOR_BUFFER_BIT| GL_DEPTH_BUFFER_BIT );
-		glPushMatrix();
-		glRotatef(rotX, 1.0,0.0,0.0);
-		glRotatef(rotX, 0.0,1.0,0.0);
+		vector<double> cpuMs, gpuMs;
+		env->quiesce();
+		timeFrames(path, strips, starts, warmup, frames, w,
+			cpuMs, gpuMs);
 
-		for (int* p = stripIndices; *p; ) {
-			glBegin(GL_QUAD_STRIP);
-			for (int nVertices = *p++; nVertices; --nVertices, ++p)
-				glArrayElement(*p);
-			glEnd();
+		if (path != pathImmediate) {
+			glDisableClientState(GL_VERTEX_ARRAY);
+			glDisableClientState(GL_NORMAL_ARRAY);
 		}
-		w.swap();
-		glPopMatrix();
+		if (path == pathVBO) {
+			gl.BindBuffer(GL_ARRAY_BUFFER_ARB, 0);
+			gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+			gl.DeleteBuffers(2, buffers);
+		}
+
+		TeapotPathResult r;
+		r.name = pathNames[p];
+		summarize(cpuMs, gpuMs, r);
+		if (res.paths.empty())
+			res.fTps = r.fps;
+		res.paths.push_back(r);
 	}
-	
-	double finish = tTimer.getClock();
-	
-	res.fTps = (endX - startX) / (finish - start);
+
 	res.pass = true;
 } // TeapotTest::runOne
 
@@ -3181,8 +3350,53 @@ TeapotTest::logOne(TeapotResult& r) {
 	logPassFail(r);
 	env->log << "Teapots/Sec: " << r.fTps << "  ";
 	logConcise(r);
+	for (size_t i = 0; i < r.paths.size(); ++i)
+		logPath(r.paths[i]);
 } // TeapotTest::logOne
 
+///////////////////////////////////////////////////////////////////////////////
+// logPath:  Log the frame times of one submission path
+///////////////////////////////////////////////////////////////////////////////
+void
+TeapotTest::logPath(const TeapotPathResult& p) {
+	env->log << '\t' << p.name << ": " << p.fps << " frames/sec. over "
+		<< p.frames << " frames\n"
+		<< "\t\tCPU frame time (ms):  p50 " << p.p50
+		<< " [" << p.p50Low << ", " << p.p50High << "], p95 " << p.p95
+		<< ", p99 " << p.p99 << ", max " << p.worst << '\n';
+	if (p.gpuP50 > 0.0)
+		env->log << "\t\tGPU frame time (ms):  p50 " << p.gpuP50
+			<< ", p95 " << p.gpuP95 << ", p99 " << p.gpuP99
+			<< ", max " << p.gpuWorst << '\n';
+	if (p.spikes)
+		env->log << "\t\t" << p.spikes
+			<< " frame(s) took more than twice the median.\n";
+
+	// Histogram, trimmed to the occupied bins:
+	if (p.frames == 0)
+		return;
+	int first = 0, last = TeapotPathResult::nBins - 1, most = 0;
+	while (first < last && p.histogram[first] == 0)
+		++first;
+	while (last > first && p.histogram[last] == 0)
+		--last;
+	for (int i = first; i <= last; ++i)
+		if (p.histogram[i] > most)
+			most = p.histogram[i];
+	for (int i = first; i <= last; ++i) {
+		ostringstream label;
+		if (i == TeapotPathResult::nBins - 1)
+			label << ">= " << TeapotPathResult::binLimit(i - 1);
+		else
+			label << "<  " << TeapotPathResult::binLimit(i);
+		label << " ms";
+		const int bar = (40 * p.histogram[i] + most - 1) / most;
+		env->log << "\t\t" << left << setw(12) << label.str()
+			<< right << setw(6)
+			<< p.histogram[i] << ' ' << string(bar, '#') << '\n';
+	}
+} // TeapotTest::logPath
+
 ///////////////////////////////////////////////////////////////////////////////
 // compareOne:  Compare results for a single test case
 ///////////////////////////////////////////////////////////////////////////////
@@ -3203,13 +3417,60 @@ TeapotTest::compareOne(TeapotResult& oldR, TeapotResult& newR) {
 			 << newR.fTps
 			 << '\n';
 	}
+
+	// Median frame times are compared by confidence interval; the
+	// upper percentiles are only shown, since a single run of frames
+	// says little about how much they vary.
+	bool same = true;
+	for (size_t i = 0; i < newR.paths.size(); ++i) {
+		const TeapotPathResult& n = newR.paths[i];
+		const TeapotPathResult* o = 0;
+		for (size_t j = 0; j < oldR.paths.size(); ++j)
+			if (oldR.paths[j].name == n.name)
+				o = &oldR.paths[j];
+		if (!o)
+			continue;
+		if (significantlyDifferent(o->p50Low, o->p50High,
+		    n.p50Low, n.p50High)) {
+			const bool newFaster = n.p50 < o->p50;
+			const double fast = newFaster? n.p50: o->p50;
+			const double slow = newFaster? o->p50: n.p50;
+			int percent = static_cast<int>(
+				100.0 * (slow - fast) / fast + 0.5);
+			if (same) {
+				same = false;
+				env->log << name << ":  DIFF "
+					<< newR.config->conciseDescription()
+					<< '\n';
+			}
+			env->log << '\t' << (newFaster? env->options.db2Name:
+					env->options.db1Name)
+				<< " has significantly shorter median frame"
+				<< " time on the " << n.name << " path ("
+				<< percent << "%).\n";
+		}
+		if (env->options.verbosity)
+			env->log << '\t' << n.name << " frame time (ms):  p50 "
+				<< o->p50 << " vs. " << n.p50 << ", p99 "
+				<< o->p99 << " vs. " << n.p99 << ", max "
+				<< o->worst << " vs. " << n.worst << '\n';
+	}
 } // TeapotTest::compareOne
 
 ///////////////////////////////////////////////////////////////////////////////
 // The test object itself:
 ///////////////////////////////////////////////////////////////////////////////
 TeapotTest teapotTest("teapot", "window, rgb, z",
-	"This test simply displays a teapot, rotates it, and attempts to\n"
-	"determine the frame/sec the pipeline can generate\n");
+	"This test displays a rotating teapot, drawn as quad strips, and\n"
+	"times every frame.  After a few untimed warm-up frames, it draws\n"
+	"a full rotation through each submission path selected with\n"
+	"--draw-paths:  immediate mode (glBegin/glEnd), glDrawElements\n"
+	"from client-side arrays, and glDrawElements from vertex buffer\n"
+	"objects.  For each path it reports frames per second and the\n"
+	"median, 95th and 99th percentile and maximum frame time, measured\n"
+	"on the CPU from one buffer swap to the next and (where timer\n"
+	"queries are supported) on the GPU, along with a histogram of\n"
+	"frame times.  Occasional slow frames show up in the upper\n"
+	"percentiles and the histogram, though not in the average.\n");
 
 } // namespace GLEAN
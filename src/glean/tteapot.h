@@ -34,28 +34,131 @@
 
 // Simple teapot-drawing benchmark provided by Adam Haberlach.
 
+// The teapot is drawn through each selected submission path (see
+// --draw-paths), and every frame is timed, so that the occasional slow
+// frame (a shader recompile or buffer reallocation, say) shows up in the
+// upper percentiles and the histogram even when it's lost in the mean.
+
 namespace GLEAN {
 
+// Frame times for one submission path:
+class TeapotPathResult {
+public:
+	enum { nBins = 12 };	// Histogram bins; see binLimit()
+
+	string name;		// Submission path (no whitespace)
+	int frames;		// Number of frames timed, after warm-up
+	double fps;		// Frames per second over the timed frames
+	double p50;		// Median CPU frame time (ms), measured
+				// from one swap to the next
+	double p50Low;		// 95% confidence interval of the median
+	double p50High;
+	double p95;		// Upper percentiles of CPU frame time (ms)
+	double p99;
+	double worst;		// Slowest frame (ms)
+	double gpuP50;		// GPU time per frame (ms); zero if timer
+	double gpuP95;		// queries aren't supported
+	double gpuP99;
+	double gpuWorst;
+	int spikes;		// Frames taking over twice the median
+	int histogram[nBins];	// Frames per CPU frame-time bin
+
+	// Upper limit (ms) of histogram bin i; the last bin is unbounded.
+	static double binLimit(int i) { return 0.25 * (1 << i); }
+
+	TeapotPathResult() {
+		frames = spikes = 0;
+		fps = p50 = p50Low = p50High = p95 = p99 = worst = 0.0;
+		gpuP50 = gpuP95 = gpuP99 = gpuWorst = 0.0;
+		for (int i = 0; i < nBins; ++i)
+			histogram[i] = 0;
+	}
+
+	void put(ostream& s) const {
+		s << name << ' ' << frames << ' ' << fps
+		  << ' ' << p50 << ' ' << p50Low << ' ' << p50High
+		  << ' ' << p95 << ' ' << p99 << ' ' << worst
+		  << ' ' << gpuP50 << ' ' << gpuP95 << ' ' << gpuP99
+		  << ' ' << gpuWorst << ' ' << spikes << '\n';
+		for (int i = 0; i < nBins; ++i)
+			s << histogram[i] << (i == nBins - 1? '\n': ' ');
+	}
+
+	void get(istream& s) {
+		s >> name >> frames >> fps >> p50 >> p50Low >> p50High
+		  >> p95 >> p99 >> worst >> gpuP50 >> gpuP95 >> gpuP99
+		  >> gpuWorst >> spikes;
+		for (int i = 0; i < nBins; ++i)
+			s >> histogram[i];
+	}
+
+	void measurements(vector<Measurement>& m) const {
+		m.push_back(Measurement(name + ".fps", "frame/s", fps,
+			frames));
+		m.push_back(Measurement(name + ".p50", "ms", p50, p50Low,
+			p50High, frames));
+		m.push_back(Measurement(name + ".p95", "ms", p95, frames));
+		m.push_back(Measurement(name + ".p99", "ms", p99, frames));
+		m.push_back(Measurement(name + ".max", "ms", worst, frames));
+		if (gpuP50 > 0.0) {
+			m.push_back(Measurement(name + ".gpu.p50", "ms",
+				gpuP50, frames));
+			m.push_back(Measurement(name + ".gpu.p95", "ms",
+				gpuP95, frames));
+			m.push_back(Measurement(name + ".gpu.p99", "ms",
+				gpuP99, frames));
+			m.push_back(Measurement(name + ".gpu.max", "ms",
+				gpuWorst, frames));
+		}
+	}
+};
+
 class TeapotResult: public BaseResult {
 public:
 	bool pass;
-	double fTps; // speed in "Teapots per Second"
+	double fTps; // speed in "Teapots per Second", through the first
+		     // path measured
+	vector<TeapotPathResult> paths;
 
 	void putresults(ostream& s) const {
 		s << pass << '\n';
 		s << fTps << '\n';
+		s << "frames " << paths.size() << '\n';
+		for (size_t i = 0; i < paths.size(); ++i)
+			paths[i].put(s);
 	}
 	
 	bool getresults(istream& s) {
 		s >> pass;
 		s >> fTps;
-		return s.good();
+
+		// Results files written before frame times were recorded
+		// end here:
+		bool ok = s.good();
+		if (ok && (s >> ws).peek() == 'f') {
+			string tag;
+			size_t n = 0;
+			s >> tag >> n;
+			paths.resize(n);
+			for (size_t i = 0; i < n; ++i)
+				paths[i].get(s);
+			ok = s.good();
+		}
+		return ok;
+	}
+
+	virtual void measurements(vector<Measurement>& m) const {
+		m.push_back(Measurement("rate", "teapot/s", fTps));
+		for (size_t i = 0; i < paths.size(); ++i)
+			paths[i].measurements(m);
 	}
 };
 
 class TeapotTest: public BaseTest<TeapotResult> {
 public:
 	GLEAN_CLASS_WH(TeapotTest, TeapotResult, 300, 315);
+	virtual bool isBenchmark() const { return true; }
+	void logPath(const TeapotPathResult& p);
 };
 
 } // namespace GLEAN
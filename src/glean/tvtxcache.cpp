@@ -0,0 +1,409 @@
+// BEGIN_COPYRIGHT -*- glean -*-
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+// tvtxcache.cpp:  Test sensitivity of vertex throughput to index locality
+
+#include "tvtxcache.h"
+#include "geomutil.h"
+#include "gputimer.h"
+#include "image.h"
+#include "rand.h"
+
+namespace {
+
+// Entries in the vertex cache the optimizer targets, and the simulated
+// cache reports.  It's small enough for older hardware, and the
+// optimizer's orders remain good for larger caches.
+const int cacheSize = 16;
+
+// Sphere3D and RandomMesh2D mesh resolution.  Both give about 32,000
+// triangles of a pixel or two, so the drawing is vertex-bound.
+const int sphereSlices = 128;
+const int sphereStacks = 128;
+const int gridPoints = 128;
+
+class DrawMeshTimer: public GLEAN::GPUTimer {
+public:
+	int nIndices;
+	const GLvoid* indices;
+	GLEAN::Window* w;
+	GLEAN::Environment* env;
+
+	DrawMeshTimer(int n, GLEAN::Window* win, GLEAN::Environment* e) {
+		nIndices = n;
+		indices = 0;
+		w = win;
+		env = e;
+	}
+
+	virtual double compute(double t) { return (nIndices / 3) / t; }
+	virtual void premeasure() {
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+		w->swap();
+		glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
+	}
+	virtual void postmeasure() { w->swap(); }
+	virtual void preop() { env->quiesce(); glFinish(); }
+	virtual void op() {
+		glDrawElements(GL_TRIANGLES, nIndices, GL_UNSIGNED_INT,
+			indices);
+	}
+	virtual void postop() { glFinish(); }
+}; // DrawMeshTimer
+
+void
+measureSub(DrawMeshTimer& t, GLEAN::VPSubResult& r) {
+	t.measure(5, &r.tpsLow, &r.tps, &r.tpsHigh);
+	r.cpuTps = t.submitAvg;
+	r.gpuTps = t.gpuAvg;
+	r.samples = t.stats.n();
+} // measureSub
+
+bool
+imagesDiffer(GLEAN::Image& testImage, GLEAN::Image& goldenImage) {
+	GLEAN::Image::Registration imageReg(testImage.reg(goldenImage));
+	return (imageReg.stats[0].max()
+		+ imageReg.stats[1].max()
+		+ imageReg.stats[2].max()) != 0.0;
+} // imagesDiffer
+
+// Draw a mesh whose vertex arrays are already set up, first in the
+// original triangle order and then in the optimized order, and check
+// that both orders produce the same image.
+void
+measureMesh(const vector<unsigned int>& indices, int nVertices,
+    const GLEAN::GLUtils::BufferFuncs& gl, GLEAN::VCMeshResult& r,
+    bool& passed, const string& name,
+    GLEAN::DrawingSurfaceConfig* config, GLEAN::Window* w,
+    GLEAN::Environment* env, const char* title) {
+	const int n = indices.size();
+	vector<unsigned int> optimized(n);
+	GLEAN::optimizeVertexCache(&indices[0], n, nVertices, cacheSize,
+		&optimized[0]);
+	r.acmr = GLEAN::vertexCacheACMR(&indices[0], n, cacheSize);
+	r.optACMR = GLEAN::vertexCacheACMR(&optimized[0], n, cacheSize);
+
+	GLuint buffers[2];
+	if (gl.have) {
+		gl.GenBuffers(2, buffers);
+		gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER_ARB, buffers[0]);
+		gl.BufferData(GL_ELEMENT_ARRAY_BUFFER_ARB,
+			n * sizeof(GLuint), &indices[0], GL_STATIC_DRAW_ARB);
+		gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER_ARB, buffers[1]);
+		gl.BufferData(GL_ELEMENT_ARRAY_BUFFER_ARB,
+			n * sizeof(GLuint), &optimized[0], GL_STATIC_DRAW_ARB);
+	}
+
+	GLEAN::Image origImage(drawingSize, drawingSize, GL_RGB,
+		GL_UNSIGNED_BYTE);
+	GLEAN::Image optImage(drawingSize, drawingSize, GL_RGB,
+		GL_UNSIGNED_BYTE);
+	DrawMeshTimer t(n, w, env);
+
+	if (gl.have)
+		gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER_ARB, buffers[0]);
+	t.indices = gl.have? GLEAN::GLUtils::bufferOffset(0): &indices[0];
+	measureSub(t, r.orig);
+	origImage.read(0, 0);
+
+	if (gl.have)
+		gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER_ARB, buffers[1]);
+	t.indices = gl.have? GLEAN::GLUtils::bufferOffset(0)
+	    : &optimized[0];
+	measureSub(t, r.opt);
+	optImage.read(0, 0);
+
+	if (gl.have) {
+		gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+		gl.DeleteBuffers(2, buffers);
+	}
+
+	if (imagesDiffer(optImage, origImage)) {
+		if (passed)
+			env->log << name << ":  FAIL "
+				<< config->conciseDescription() << '\n';
+		passed = false;
+		env->log << '\t' << title << " image in optimized order\n"
+			<< "\t\tdiffers from the image in original order.\n";
+		r.opt.imageMatch = false;
+	}
+} // measureMesh
+
+void
+logMesh(const char* title, GLEAN::VCMeshResult& r, GLEAN::Environment* env) {
+	env->log << '\t' << title << ":\n"
+		<< "\t\tOriginal order:  ACMR " << r.acmr << ", "
+		<< r.orig.tps << " tri/sec.\n"
+		<< "\t\t\t95% confidence interval = ["
+		<< r.orig.tpsLow << ", " << r.orig.tpsHigh << "]\n"
+		<< "\t\tOptimized order:  ACMR " << r.optACMR << ", "
+		<< r.opt.tps << " tri/sec.\n"
+		<< "\t\t\t95% confidence interval = ["
+		<< r.opt.tpsLow << ", " << r.opt.tpsHigh << "]\n";
+	if (r.orig.gpuTps > 0.0 && r.opt.gpuTps > 0.0)
+		env->log << "\t\tGPU execution rates = " << r.orig.gpuTps
+			<< " and " << r.opt.gpuTps << " tri/sec.\n";
+	if (r.orig.tps > 0.0)
+		env->log << "\t\tOptimized order runs at "
+			<< 100.0 * r.opt.tps / r.orig.tps
+			<< "% of the original order's rate.\n";
+} // logMesh
+
+void
+compareMesh(const char* title, GLEAN::VCMeshResult& oldR,
+    GLEAN::VCMeshResult& newR, bool& same, const string& name,
+    GLEAN::DrawingSurfaceConfig* config, GLEAN::Environment* env) {
+	const GLEAN::VPSubResult* oldS[2] = { &oldR.orig, &oldR.opt };
+	const GLEAN::VPSubResult* newS[2] = { &newR.orig, &newR.opt };
+	const char* order[2] = { "original", "optimized" };
+	for (int i = 0; i < 2; ++i) {
+		if (!GLEAN::significantlyDifferent(oldS[i]->tpsLow,
+		    oldS[i]->tpsHigh, newS[i]->tpsLow, newS[i]->tpsHigh))
+			continue;
+		const bool newFaster = newS[i]->tps > oldS[i]->tps;
+		const double fast = newFaster? newS[i]->tps: oldS[i]->tps;
+		const double slow = newFaster? oldS[i]->tps: newS[i]->tps;
+		int percent = static_cast<int>(
+			100.0 * (fast - slow) / slow + 0.5);
+		if (same) {
+			same = false;
+			env->log << name << ":  DIFF "
+				<< config->conciseDescription() << '\n';
+		}
+		env->log << '\t' << (newFaster? env->options.db2Name:
+				env->options.db1Name)
+			<< " is significantly faster on " << title
+			<< " in " << order[i] << " order ("
+			<< percent << "%).\n";
+	}
+} // compareMesh
+
+} // anonymous namespace
+
+namespace GLEAN {
+
+///////////////////////////////////////////////////////////////////////////////
+// runOne:  Run a single test case
+///////////////////////////////////////////////////////////////////////////////
+void
+VertexCachePerf::runOne(VCPerfResult& r, Window& w) {
+	bool passed = true;
+	GLUtils::BufferFuncs gl;
+	GLuint vertexBuffer = 0;
+	if (gl.have)
+		gl.GenBuffers(1, &vertexBuffer);
+
+	glDisable(GL_FOG);
+	glDisable(GL_SCISSOR_TEST);
+	glDisable(GL_ALPHA_TEST);
+	glDisable(GL_STENCIL_TEST);
+	glDepthFunc(GL_LEQUAL);
+	glEnable(GL_DEPTH_TEST);
+	glDisable(GL_BLEND);
+	glDisable(GL_DITHER);
+	glDisable(GL_COLOR_LOGIC_OP);
+	glDisable(GL_TEXTURE_2D);
+	glColorMask(GL_TRUE, GL_TRUE, GL_TRUE, GL_TRUE);
+	glDepthMask(GL_TRUE);
+	glPolygonMode(GL_FRONT_AND_BACK, GL_FILL);
+	glFrontFace(GL_CCW);
+	glCullFace(GL_BACK);
+	glEnable(GL_CULL_FACE);
+	glShadeModel(GL_SMOOTH);
+	glReadBuffer(GL_FRONT);
+
+	////////////////////////////////////////////////////////////
+	// Lit sphere, viewed from outside along the z axis
+	////////////////////////////////////////////////////////////
+	{
+	const float radius = drawingSize / 2 - 2;
+	Sphere3D sphere(radius, sphereSlices, sphereStacks);
+	const int nVertices = sphere.getNumVertices();
+	vector<GLfloat> arrays(sphere.getVertices(),
+		sphere.getVertices() + 3 * nVertices);
+	arrays.insert(arrays.end(), sphere.getNormals(),
+		sphere.getNormals() + 3 * nVertices);
+	const GLvoid* positions = &arrays[0];
+	const GLvoid* normals = &arrays[3 * nVertices];
+	if (gl.have) {
+		gl.BindBuffer(GL_ARRAY_BUFFER_ARB, vertexBuffer);
+		gl.BufferData(GL_ARRAY_BUFFER_ARB,
+			arrays.size() * sizeof(GLfloat), &arrays[0],
+			GL_STATIC_DRAW_ARB);
+		positions = GLUtils::bufferOffset(0);
+		normals = GLUtils::bufferOffset(3 * nVertices
+		    * sizeof(GLfloat));
+	}
+	glVertexPointer(3, GL_FLOAT, 0, positions);
+	glNormalPointer(GL_FLOAT, 0, normals);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glEnableClientState(GL_NORMAL_ARRAY);
+
+	GLUtils::useScreenCoords(drawingSize, drawingSize);
+	glMatrixMode(GL_PROJECTION);
+	glLoadIdentity();
+	glOrtho(0, drawingSize, 0, drawingSize, -drawingSize, drawingSize);
+	glMatrixMode(GL_MODELVIEW);
+	glTranslatef(drawingSize / 2, drawingSize / 2, 0.0);
+
+	GLUtils::Light light(0);
+	light.ambient(0, 0, 0, 0);
+	light.diffuse(1, 1, 1, 0);
+	light.specular(0, 0, 0, 0);
+	light.position(0.3, 0.3, 1, 0);
+	light.enable();
+	GLUtils::LightModel lm;
+	lm.ambient(0.1, 0.1, 0.1, 1);
+	lm.localViewer(false);
+	lm.twoSide(false);
+	GLUtils::Material mat;
+	mat.ambientAndDiffuse(1, 1, 1, 1);
+	mat.specular(0, 0, 0, 1);
+	mat.emission(0, 0, 0, 1);
+	mat.shininess(0);
+	glDisable(GL_COLOR_MATERIAL);
+	glEnable(GL_LIGHTING);
+
+	vector<unsigned int> indices(sphere.getIndices(),
+		sphere.getIndices() + sphere.getNumIndices());
+	measureMesh(indices, nVertices, gl, r.sphere, passed, name,
+		r.config, &w, env, "Sphere");
+
+	glDisable(GL_LIGHTING);
+	glDisableClientState(GL_VERTEX_ARRAY);
+	glDisableClientState(GL_NORMAL_ARRAY);
+	}
+
+	////////////////////////////////////////////////////////////
+	// Randomly-perturbed grid
+	//	Perturbing the points can fold a cell over, so that its
+	//	triangles overlap.  Whichever is drawn last would show,
+	//	so the grid is drawn in a single color.
+	////////////////////////////////////////////////////////////
+	{
+	RandomDouble rand(1618033);
+	RandomMesh2D mesh(0.5, drawingSize - 0.5, gridPoints,
+		0.5, drawingSize - 0.5, gridPoints, rand);
+	const int nVertices = gridPoints * gridPoints;
+	const GLvoid* positions = mesh(0, 0);
+	if (gl.have) {
+		gl.BindBuffer(GL_ARRAY_BUFFER_ARB, vertexBuffer);
+		gl.BufferData(GL_ARRAY_BUFFER_ARB,
+			2 * nVertices * sizeof(GLfloat), mesh(0, 0),
+			GL_STATIC_DRAW_ARB);
+		positions = GLUtils::bufferOffset(0);
+	}
+	glVertexPointer(2, GL_FLOAT, 0, positions);
+	glEnableClientState(GL_VERTEX_ARRAY);
+	glColor4f(1.0, 1.0, 1.0, 1.0);
+
+	GLUtils::useScreenCoords(drawingSize, drawingSize);
+
+	vector<unsigned int> indices;
+	gridIndices(gridPoints, gridPoints, indices);
+	measureMesh(indices, nVertices, gl, r.grid, passed, name,
+		r.config, &w, env, "Grid");
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	}
+
+	if (gl.have) {
+		gl.BindBuffer(GL_ARRAY_BUFFER_ARB, 0);
+		gl.DeleteBuffers(1, &vertexBuffer);
+	}
+
+	r.pass = passed;
+} // VertexCachePerf::runOne
+
+///////////////////////////////////////////////////////////////////////////////
+// logOne:  Log a single test case
+///////////////////////////////////////////////////////////////////////////////
+void
+VertexCachePerf::logOne(VCPerfResult& r) {
+	if (r.pass) {
+		logPassFail(r);
+		logConcise(r);
+	} else env->log << '\n'; // because measureMesh logs failure
+	logStats(r);
+} // VertexCachePerf::logOne
+
+///////////////////////////////////////////////////////////////////////////////
+// compareOne:  Compare results for a single test case
+///////////////////////////////////////////////////////////////////////////////
+void
+VertexCachePerf::compareOne(VCPerfResult& oldR, VCPerfResult& newR) {
+	bool same = true;
+	compareMesh("sphere", oldR.sphere, newR.sphere, same, name,
+		newR.config, env);
+	compareMesh("grid", oldR.grid, newR.grid, same, name,
+		newR.config, env);
+
+	if (same && env->options.verbosity)
+		env->log << name << ":  SAME "
+			<< newR.config->conciseDescription()
+			<< "\n\tNo significant difference in test time"
+			<< " between " << env->options.db1Name
+			<< " and " << env->options.db2Name << ".\n";
+
+	if (env->options.verbosity) {
+		env->log << env->options.db1Name << ':';
+		logStats(oldR);
+		env->log << env->options.db2Name << ':';
+		logStats(newR);
+	}
+} // VertexCachePerf::compareOne
+
+void
+VertexCachePerf::logStats(VCPerfResult& r) {
+	logMesh("Sphere (Sphere3D)", r.sphere, env);
+	logMesh("Grid (RandomMesh2D)", r.grid, env);
+} // VertexCachePerf::logStats
+
+///////////////////////////////////////////////////////////////////////////////
+// The test object itself:
+///////////////////////////////////////////////////////////////////////////////
+VertexCachePerf vertexCachePerfTest("vertexCachePerf", "window, rgb, z, fast",
+
+	"This test measures how sensitive the vertex pipeline is to the\n"
+	"locality of the indices it's given.  It draws two meshes of about\n"
+	"32,000 small triangles with DrawElements:  a lit sphere from\n"
+	"Sphere3D, and a randomly perturbed grid from RandomMesh2D.  Each\n"
+	"is drawn in the order its generator emits the triangles, and\n"
+	"again in the order chosen by a post-transform vertex cache\n"
+	"optimizer (Tipsify).  The test reports triangles per second for\n"
+	"both orders, along with the average cache miss ratio (ACMR:\n"
+	"vertices transformed per triangle) of each order in a simulated\n"
+	"16-entry FIFO cache.  Drivers that exploit a vertex cache should\n"
+	"run the optimized order faster.\n"
+	"\n"
+	"Since reordering triangles shouldn't change the image, the test\n"
+	"fails if the two orders draw different images.\n"
+
+	);
+
+} // namespace GLEAN
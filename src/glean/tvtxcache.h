@@ -0,0 +1,110 @@
+// BEGIN_COPYRIGHT -*- glean -*-
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+// tvtxcache.h:  Test sensitivity of vertex throughput to index locality
+
+#ifndef __tvtxcache_h__
+#define __tvtxcache_h__
+
+#include "tvtxperf.h"
+
+namespace GLEAN {
+
+// Auxiliary struct for one mesh:  its average cache miss ratio (ACMR,
+// vertices transformed per triangle in a simulated FIFO cache) and its
+// throughput, in the generator's original triangle order and in the
+// order chosen by the vertex-cache optimizer.
+class VCMeshResult {
+public:
+	double acmr;		// ACMR in the original order
+	double optACMR;		// ACMR in the optimized order
+	VPSubResult orig;	// DrawElements in the original order
+	VPSubResult opt;	// DrawElements in the optimized order
+
+	VCMeshResult() {
+		acmr = optACMR = 0.0;
+	}
+
+	void put(ostream& s) const {
+		s << acmr << ' ' << optACMR << '\n';
+		orig.put(s);
+		opt.put(s);
+	}
+
+	void get(istream& s) {
+		s >> acmr >> optACMR;
+		orig.get(s);
+		opt.get(s);
+	}
+
+	void measurements(vector<Measurement>& m, const string& name) const {
+		m.push_back(Measurement(name + ".acmr", "vtx/tri", acmr));
+		m.push_back(Measurement(name + "Opt.acmr", "vtx/tri",
+			optACMR));
+		orig.measurements(m, name);
+		opt.measurements(m, name + "Opt");
+	}
+};
+
+class VCPerfResult: public BaseResult {
+public:
+	bool pass;
+
+	VCMeshResult sphere;	// Sphere3D, in stacks-and-slices order
+	VCMeshResult grid;	// RandomMesh2D, in row-by-row order
+
+	virtual void putresults(ostream& s) const {
+		s << pass << '\n';
+		sphere.put(s);
+		grid.put(s);
+	}
+
+	virtual bool getresults(istream& s) {
+		s >> pass;
+		sphere.get(s);
+		grid.get(s);
+		return s.good();
+	}
+
+	virtual void measurements(vector<Measurement>& m) const {
+		sphere.measurements(m, "sphere");
+		grid.measurements(m, "grid");
+	}
+};
+
+class VertexCachePerf: public BaseTest<VCPerfResult> {
+public:
+	GLEAN_CLASS_WHO(VertexCachePerf, VCPerfResult,
+			drawingSize, drawingSize, true);
+	void logStats(VCPerfResult& r);
+	virtual bool isBenchmark() const { return true; }
+}; // class VertexCachePerf
+
+} // namespace GLEAN
+
+#endif // __tvtxcache_h__
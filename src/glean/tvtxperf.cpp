@@ -28,9 +28,11 @@
 
 // tvtxperf.cpp:  Test performance of various ways to specify vertex data
 
+#include <cstddef>
+#include <cstring>
 #include "tvtxperf.h"
 #include "geomutil.h"
-#include "timer.h"
+#include "gputimer.h"
 #include "image.h"
 #include "codedid.h"
 #include "treadpix.h"
@@ -48,7 +50,7 @@ struct C4UB_T2F_V3F {
 	GLfloat v[3];
 };
 
-class TvtxBaseTimer: public GLEAN::Timer {
+class TvtxBaseTimer: public GLEAN::GPUTimer {
 public:
 	int nVertices;
 	GLuint* indices;
@@ -282,13 +284,28 @@ public:
 	virtual void op() { glCallList(dList); }
 }; // callDList
 
+void
+measureSub(TvtxBaseTimer& t, GLEAN::VPSubResult& r) {
+	t.measure(5, &r.tpsLow, &r.tps, &r.tpsHigh);
+	r.cpuTps = t.submitAvg;
+	r.gpuTps = t.gpuAvg;
+	r.samples = t.stats.n();
+} // measureSub
+
 void
 logStats1(const char* title, GLEAN::VPSubResult& r,
     GLEAN::Environment* env) {
 	env->log << '\t' << title << " rate = "
 		<< r.tps << " tri/sec.\n"
-		<< "\t\tRange of valid measurements = ["
-		<< r.tpsLow << ", " << r.tpsHigh << "]\n"
+		<< "\t\t95% confidence interval = ["
+		<< r.tpsLow << ", " << r.tpsHigh << "]\n";
+	if (r.cpuTps > 0.0)
+		env->log << "\t\tCPU submission rate = "
+			<< r.cpuTps << " tri/sec.\n";
+	if (r.gpuTps > 0.0)
+		env->log << "\t\tGPU execution rate = "
+			<< r.gpuTps << " tri/sec.\n";
+	env->log
 		<< "\t\tImage sanity check "
 		<< (r.imageOK? "passed\n": "failed\n")
 		<< "\t\tImage consistency check "
@@ -322,21 +339,18 @@ doComparison(const GLEAN::VPSubResult& oldR,
     GLEAN::DrawingSurfaceConfig* config,
     bool& same, const string& name, GLEAN::Environment* env,
     const char* title) {
-	if (newR.tps < oldR.tpsLow) {
+	if (GLEAN::significantlyDifferent(oldR.tpsLow, oldR.tpsHigh,
+	    newR.tpsLow, newR.tpsHigh)) {
+		const bool newFaster = newR.tps > oldR.tps;
+		const double fast = newFaster? newR.tps: oldR.tps;
+		const double slow = newFaster? oldR.tps: newR.tps;
 		int percent = static_cast<int>(
-			100.0 * (oldR.tps - newR.tps) / newR.tps + 0.5);
+			100.0 * (fast - slow) / slow + 0.5);
 		diffHeader(same, name, config, env);
-		env->log << '\t' << env->options.db1Name
-			<< " may be " << percent << "% faster on "
-			<< title << " drawing.\n";
-	}
-	if (newR.tps > oldR.tpsHigh) {
-		int percent = static_cast<int>(
-			100.0 * (newR.tps - oldR.tps) / oldR.tps + 0.5);
-		diffHeader(same, name, config, env);
-		env->log << '\t' << env->options.db2Name
-			<< " may be " << percent << "% faster on "
-			<< title << " drawing.\n";
+		env->log << '\t' << (newFaster? env->options.db2Name:
+				env->options.db1Name)
+			<< " is significantly faster on " << title
+			<< " drawing (" << percent << "%).\n";
 	}
 	if (newR.imageOK != oldR.imageOK) {
 		diffHeader(same, name, config, env);
@@ -398,6 +412,542 @@ verifyVtxPerf(GLEAN::Image& testImage, GLEAN::RGBCodedID& colorGen,
 	}
 } // verify
 
+// Everything verifyVtxPerf needs, apart from the result being checked
+// and its title:
+struct VtxChecker {
+	GLEAN::Image& testImage;
+	GLEAN::RGBCodedID& colorGen;
+	int lastID;
+	GLEAN::Image& refImage;
+	bool& passed;
+	string& name;
+	GLEAN::DrawingSurfaceConfig* config;
+	GLEAN::Environment* env;
+
+	VtxChecker(GLEAN::Image& t, GLEAN::RGBCodedID& c, int l,
+	    GLEAN::Image& ref, bool& p, string& n,
+	    GLEAN::DrawingSurfaceConfig* cfg, GLEAN::Environment* e):
+		testImage(t), colorGen(c), lastID(l), refImage(ref),
+		passed(p), name(n), config(cfg), env(e) {
+	}
+
+	void check(GLEAN::VPSubResult& res, const string& title) {
+		verifyVtxPerf(testImage, colorGen, 0, lastID, refImage,
+			passed, name, config, res, env, title.c_str());
+	}
+}; // VtxChecker
+
+///////////////////////////////////////////////////////////////////////////////
+// Buffer-object drawing paths
+///////////////////////////////////////////////////////////////////////////////
+
+// Headers disagree on the constness of MultiDrawElements' indices, and
+// older ones lack the instancing entry points, so we declare our own:
+typedef void (GLAPIENTRY * MultiDrawElementsProc) (GLenum mode,
+	const GLsizei* count, GLenum type, const GLvoid* const* indices,
+	GLsizei primcount);
+typedef void (GLAPIENTRY * DrawArraysInstancedProc) (GLenum mode,
+	GLint first, GLsizei count, GLsizei primcount);
+typedef void (GLAPIENTRY * VertexAttribDivisorProc) (GLuint index,
+	GLuint divisor);
+
+// Titles of the paths, in the order of VPBufferResult's members:
+const char* bufferPathTitles[] = {
+	"VBO DrawArrays",
+	"Planar VBO DrawArrays",
+	"VBO DrawElements",
+	"16-bit VBO DrawElements",
+	"VBO DrawRangeElements",
+	"VBO MultiDrawElements",
+	"Instanced",
+};
+const int nBufferPaths =
+	sizeof(bufferPathTitles) / sizeof(bufferPathTitles[0]);
+
+void
+bufferPaths(GLEAN::VPBufferResult& r, GLEAN::VPSubResult* p[]) {
+	p[0] = &r.da;
+	p[1] = &r.pl;
+	p[2] = &r.de;
+	p[3] = &r.de16;
+	p[4] = &r.dre;
+	p[5] = &r.mde;
+	p[6] = &r.in;
+} // bufferPaths
+
+template<class P>
+void
+lookup(P& p, const char* name) {
+	p = reinterpret_cast<P>(GLEAN::GLUtils::getProcAddress(name));
+} // lookup
+
+// Entry points for the buffer-object paths.  A path whose entry points
+// the context lacks is skipped, and its result is left at zero.
+struct BufferEntryPoints: public GLEAN::GLUtils::BufferFuncs {
+				// ``have'' covers the VBO and IBO paths
+	bool instancing;	// Instanced path
+
+	PFNGLDRAWRANGEELEMENTSPROC DrawRangeElements;
+	MultiDrawElementsProc MultiDrawElements;
+
+	PFNGLCREATESHADERPROC CreateShader;
+	PFNGLSHADERSOURCEPROC ShaderSource;
+	PFNGLCOMPILESHADERPROC CompileShader;
+	PFNGLGETSHADERIVPROC GetShaderiv;
+	PFNGLDELETESHADERPROC DeleteShader;
+	PFNGLCREATEPROGRAMPROC CreateProgram;
+	PFNGLATTACHSHADERPROC AttachShader;
+	PFNGLBINDATTRIBLOCATIONPROC BindAttribLocation;
+	PFNGLLINKPROGRAMPROC LinkProgram;
+	PFNGLGETPROGRAMIVPROC GetProgramiv;
+	PFNGLGETATTRIBLOCATIONPROC GetAttribLocation;
+	PFNGLUSEPROGRAMPROC UseProgram;
+	PFNGLDELETEPROGRAMPROC DeleteProgram;
+	PFNGLVERTEXATTRIBPOINTERPROC VertexAttribPointer;
+	PFNGLENABLEVERTEXATTRIBARRAYPROC EnableVertexAttribArray;
+	PFNGLDISABLEVERTEXATTRIBARRAYPROC DisableVertexAttribArray;
+	VertexAttribDivisorProc VertexAttribDivisor;
+	DrawArraysInstancedProc DrawArraysInstanced;
+
+	BufferEntryPoints();
+}; // BufferEntryPoints
+
+BufferEntryPoints::BufferEntryPoints() {
+	instancing = false;
+	DrawRangeElements = 0;
+	MultiDrawElements = 0;
+	if (!have)
+		return;
+
+	const float version = GLEAN::GLUtils::getVersion();
+
+	if (version >= 1.2)
+		lookup(DrawRangeElements, "glDrawRangeElements");
+	else if (GLEAN::GLUtils::haveExtension("GL_EXT_draw_range_elements"))
+		lookup(DrawRangeElements, "glDrawRangeElementsEXT");
+	if (version >= 1.4)
+		lookup(MultiDrawElements, "glMultiDrawElements");
+	else if (GLEAN::GLUtils::haveExtension("GL_EXT_multi_draw_arrays"))
+		lookup(MultiDrawElements, "glMultiDrawElementsEXT");
+
+	// Instancing needs a vertex shader to pick out each instance's
+	// attributes, as well as the instancing entry points themselves:
+	if (version < 2.0)
+		return;
+	const bool coreInstancing = version >= 3.3;
+	if (!coreInstancing
+	 && !(GLEAN::GLUtils::haveExtension("GL_ARB_instanced_arrays")
+	   && GLEAN::GLUtils::haveExtension("GL_ARB_draw_instanced")))
+		return;
+	lookup(CreateShader, "glCreateShader");
+	lookup(ShaderSource, "glShaderSource");
+	lookup(CompileShader, "glCompileShader");
+	lookup(GetShaderiv, "glGetShaderiv");
+	lookup(DeleteShader, "glDeleteShader");
+	lookup(CreateProgram, "glCreateProgram");
+	lookup(AttachShader, "glAttachShader");
+	lookup(BindAttribLocation, "glBindAttribLocation");
+	lookup(LinkProgram, "glLinkProgram");
+	lookup(GetProgramiv, "glGetProgramiv");
+	lookup(GetAttribLocation, "glGetAttribLocation");
+	lookup(UseProgram, "glUseProgram");
+	lookup(DeleteProgram, "glDeleteProgram");
+	lookup(VertexAttribPointer, "glVertexAttribPointer");
+	lookup(EnableVertexAttribArray, "glEnableVertexAttribArray");
+	lookup(DisableVertexAttribArray, "glDisableVertexAttribArray");
+	lookup(VertexAttribDivisor, coreInstancing? "glVertexAttribDivisor":
+		"glVertexAttribDivisorARB");
+	lookup(DrawArraysInstanced, coreInstancing? "glDrawArraysInstanced":
+		"glDrawArraysInstancedARB");
+	instancing = CreateShader && ShaderSource && CompileShader
+		&& GetShaderiv && DeleteShader && CreateProgram
+		&& AttachShader && BindAttribLocation && LinkProgram
+		&& GetProgramiv && GetAttribLocation && UseProgram
+		&& DeleteProgram && VertexAttribPointer
+		&& EnableVertexAttribArray && DisableVertexAttribArray
+		&& VertexAttribDivisor && DrawArraysInstanced;
+} // BufferEntryPoints::BufferEntryPoints
+
+class drawArraysTimer: public TvtxBaseTimer {
+public:
+	GLenum mode;
+	drawArraysTimer(GLenum m, int v, int t, GLEAN::Window* w,
+			GLEAN::Environment* env):
+		TvtxBaseTimer(v, 0, t, w, env) {
+		mode = m;
+	}
+	virtual void op() { glDrawArrays(mode, 0, nVertices); }
+}; // drawArraysTimer
+
+class drawElementsTimer: public TvtxBaseTimer {
+public:
+	GLenum mode;
+	GLenum type;
+	drawElementsTimer(GLenum m, GLenum ty, int v, int t,
+			  GLEAN::Window* w, GLEAN::Environment* env):
+		TvtxBaseTimer(v, 0, t, w, env) {
+		mode = m;
+		type = ty;
+	}
+	virtual void op() {
+		glDrawElements(mode, nVertices, type,
+			GLEAN::GLUtils::bufferOffset(0));
+	}
+}; // drawElementsTimer
+
+class drawRangeElementsTimer: public TvtxBaseTimer {
+public:
+	GLenum mode;
+	PFNGLDRAWRANGEELEMENTSPROC draw;
+	drawRangeElementsTimer(GLenum m, PFNGLDRAWRANGEELEMENTSPROC d,
+			       int v, int t, GLEAN::Window* w,
+			       GLEAN::Environment* env):
+		TvtxBaseTimer(v, 0, t, w, env) {
+		mode = m;
+		draw = d;
+	}
+	virtual void op() {
+		draw(mode, 0, nVertices - 1, nVertices, GL_UNSIGNED_INT,
+			GLEAN::GLUtils::bufferOffset(0));
+	}
+}; // drawRangeElementsTimer
+
+class multiDrawElementsTimer: public TvtxBaseTimer {
+public:
+	GLenum mode;
+	MultiDrawElementsProc draw;
+	vector<GLsizei> counts;
+	vector<const GLvoid*> offsets;
+
+	// Split the primitive into batches of 256 triangles.  Strip
+	// batches overlap their neighbors by two vertices, and start on
+	// an even vertex so that every triangle keeps its winding.
+	multiDrawElementsTimer(GLenum m, MultiDrawElementsProc d, int v,
+			       int t, GLEAN::Window* w,
+			       GLEAN::Environment* env):
+		TvtxBaseTimer(v, 0, t, w, env) {
+		const int batch = 256;
+		mode = m;
+		draw = d;
+		if (mode == GL_TRIANGLES) {
+			for (int first = 0; first < v; first += 3 * batch) {
+				counts.push_back(min(3 * batch, v - first));
+				offsets.push_back(GLEAN::GLUtils::bufferOffset(
+					first * sizeof(GLuint)));
+			}
+		} else {
+			for (int first = 0; first + 2 < v; first += batch) {
+				counts.push_back(min(batch + 2, v - first));
+				offsets.push_back(GLEAN::GLUtils::bufferOffset(
+					first * sizeof(GLuint)));
+			}
+		}
+	}
+	virtual void op() {
+		draw(mode, &counts[0], GL_UNSIGNED_INT, &offsets[0],
+			counts.size());
+	}
+}; // multiDrawElementsTimer
+
+class drawInstancedTimer: public TvtxBaseTimer {
+public:
+	DrawArraysInstancedProc draw;
+	drawInstancedTimer(DrawArraysInstancedProc d, int t, GLEAN::Window* w,
+			   GLEAN::Environment* env):
+		TvtxBaseTimer(3, 0, t, w, env) {
+		draw = d;
+	}
+	virtual void op() { draw(GL_TRIANGLES, 0, 3, nTris); }
+}; // drawInstancedTimer
+
+// How each vertex format's second attribute (the one after the color)
+// is specified:
+template<class V> struct VertexFormat;
+
+template<> struct VertexFormat<C4UB_N3F_V3F> {
+	enum { secondSize = 3 };
+	static size_t secondOffset() { return offsetof(C4UB_N3F_V3F, n); }
+	static const GLfloat* second(const C4UB_N3F_V3F& x) { return x.n; }
+	static void secondPointer(GLsizei stride, const GLvoid* p) {
+		glNormalPointer(GL_FLOAT, stride, p);
+	}
+};
+
+template<> struct VertexFormat<C4UB_T2F_V3F> {
+	enum { secondSize = 2 };
+	static size_t secondOffset() { return offsetof(C4UB_T2F_V3F, t); }
+	static const GLfloat* second(const C4UB_T2F_V3F& x) { return x.t; }
+	static void secondPointer(GLsizei stride, const GLvoid* p) {
+		glTexCoordPointer(2, GL_FLOAT, stride, p);
+	}
+};
+
+// Copy interleaved vertices into planar form:  all of the colors, then
+// all of the second attribute, then all of the positions.
+template<class V>
+void
+makePlanar(const V* data, int n, vector<GLubyte>& planar) {
+	const size_t cSize = sizeof(data->c);
+	const size_t sSize = VertexFormat<V>::secondSize * sizeof(GLfloat);
+	const size_t vSize = sizeof(data->v);
+	planar.resize((cSize + sSize + vSize) * n);
+	GLubyte* c = &planar[0];
+	GLubyte* s = c + cSize * n;
+	GLubyte* v = s + sSize * n;
+	for (int i = 0; i < n; ++i) {
+		memcpy(c + cSize * i, data[i].c, cSize);
+		memcpy(s + sSize * i, VertexFormat<V>::second(data[i]), sSize);
+		memcpy(v + vSize * i, data[i].v, vSize);
+	}
+} // makePlanar
+
+// Point the vertex arrays into the bound array buffer, which holds
+// either interleaved or planar vertices:
+template<class V>
+void
+bufferPointers(int n, bool planar) {
+	const size_t cSize = sizeof(static_cast<V*>(0)->c);
+	const size_t sSize = VertexFormat<V>::secondSize * sizeof(GLfloat);
+	if (planar) {
+		glColorPointer(4, GL_UNSIGNED_BYTE, 0,
+			GLEAN::GLUtils::bufferOffset(0));
+		VertexFormat<V>::secondPointer(0,
+			GLEAN::GLUtils::bufferOffset(cSize * n));
+		glVertexPointer(3, GL_FLOAT, 0,
+			GLEAN::GLUtils::bufferOffset((cSize + sSize) * n));
+	} else {
+		glColorPointer(4, GL_UNSIGNED_BYTE, sizeof(V),
+			GLEAN::GLUtils::bufferOffset(offsetof(V, c)));
+		VertexFormat<V>::secondPointer(sizeof(V),
+			GLEAN::GLUtils::bufferOffset(
+				VertexFormat<V>::secondOffset()));
+		glVertexPointer(3, GL_FLOAT, sizeof(V),
+			GLEAN::GLUtils::bufferOffset(offsetof(V, v)));
+	}
+} // bufferPointers
+
+// Instancing has no fixed-function form, so each instance is one
+// triangle, with its corners and color as per-instance attributes read
+// from the independent-triangle vertex buffer.  The fixed-function
+// state of both tests reduces to passing the color through (the light
+// is white and shines head-on; the texture is white), and this shader
+// does the same.
+const GLchar* instancedVertexShader =
+	"attribute float corner;\n"
+	"attribute vec3 corner0;\n"
+	"attribute vec3 corner1;\n"
+	"attribute vec3 corner2;\n"
+	"attribute vec4 color;\n"
+	"void main() {\n"
+	"	vec3 p = corner < 0.5? corner0:\n"
+	"		(corner < 1.5? corner1: corner2);\n"
+	"	gl_Position = gl_ModelViewProjectionMatrix * vec4(p, 1.0);\n"
+	"	gl_FrontColor = color;\n"
+	"	gl_TexCoord[0] = vec4(0.5, 0.5, 0.0, 1.0);\n"
+	"}\n";
+
+GLuint
+instancedProgram(const BufferEntryPoints& gl) {
+	GLint ok;
+	GLuint vs = gl.CreateShader(GL_VERTEX_SHADER);
+	gl.ShaderSource(vs, 1, &instancedVertexShader, 0);
+	gl.CompileShader(vs);
+	gl.GetShaderiv(vs, GL_COMPILE_STATUS, &ok);
+	if (!ok) {
+		gl.DeleteShader(vs);
+		return 0;
+	}
+
+	GLuint program = gl.CreateProgram();
+	gl.AttachShader(program, vs);
+	gl.DeleteShader(vs);
+	// Nothing is drawn unless generic attribute 0 is an array:
+	gl.BindAttribLocation(program, 0, "corner");
+	gl.LinkProgram(program);
+	gl.GetProgramiv(program, GL_LINK_STATUS, &ok);
+	if (!ok) {
+		gl.DeleteProgram(program);
+		return 0;
+	}
+	return program;
+} // instancedProgram
+
+template<class V>
+void
+measureInstanced(GLuint vertexBuffer, int nTris, const BufferEntryPoints& gl,
+    GLEAN::VPSubResult& r, VtxChecker& checker, GLEAN::Window* w,
+    GLEAN::Environment* env) {
+	GLuint program = instancedProgram(gl);
+	if (!program)
+		return;
+	const char* names[] = { "corner0", "corner1", "corner2", "color" };
+	GLint attribs[4];
+	for (int i = 0; i < 4; ++i)
+		if ((attribs[i] = gl.GetAttribLocation(program, names[i])) < 0) {
+			gl.DeleteProgram(program);
+			return;
+		}
+
+	const GLfloat corners[3] = { 0.0, 1.0, 2.0 };
+	GLuint cornerBuffer;
+	gl.GenBuffers(1, &cornerBuffer);
+	gl.BindBuffer(GL_ARRAY_BUFFER_ARB, cornerBuffer);
+	gl.BufferData(GL_ARRAY_BUFFER_ARB, sizeof(corners), corners,
+		GL_STATIC_DRAW_ARB);
+	gl.VertexAttribPointer(0, 1, GL_FLOAT, GL_FALSE, 0,
+		GLEAN::GLUtils::bufferOffset(0));
+	gl.EnableVertexAttribArray(0);
+
+	gl.BindBuffer(GL_ARRAY_BUFFER_ARB, vertexBuffer);
+	for (int i = 0; i < 3; ++i)
+		gl.VertexAttribPointer(attribs[i], 3, GL_FLOAT, GL_FALSE,
+			3 * sizeof(V), GLEAN::GLUtils::bufferOffset(
+				i * sizeof(V) + offsetof(V, v)));
+	gl.VertexAttribPointer(attribs[3], 4, GL_UNSIGNED_BYTE, GL_TRUE,
+		3 * sizeof(V), GLEAN::GLUtils::bufferOffset(offsetof(V, c)));
+	for (int i = 0; i < 4; ++i) {
+		gl.EnableVertexAttribArray(attribs[i]);
+		gl.VertexAttribDivisor(attribs[i], 1);
+	}
+
+	glDisableClientState(GL_VERTEX_ARRAY);
+	gl.UseProgram(program);
+	drawInstancedTimer in(gl.DrawArraysInstanced, nTris, w, env);
+	measureSub(in, r);
+	gl.UseProgram(0);
+	glEnableClientState(GL_VERTEX_ARRAY);
+
+	for (int i = 0; i < 4; ++i) {
+		gl.VertexAttribDivisor(attribs[i], 0);
+		gl.DisableVertexAttribArray(attribs[i]);
+	}
+	gl.DisableVertexAttribArray(0);
+	gl.DeleteBuffers(1, &cornerBuffer);
+	gl.DeleteProgram(program);
+
+	checker.check(r, "Instanced independent triangle");
+} // measureInstanced
+
+// Measure every buffer-object path the context supports, for either
+// independent triangles or a triangle strip.  The fixed-function
+// vertex arrays must already be enabled.
+template<class V>
+void
+measureBufferPaths(GLenum mode, const V* data, int nVertices, int nTris,
+    const BufferEntryPoints& gl, GLEAN::VPBufferResult& r,
+    VtxChecker& checker, GLEAN::Window* w, GLEAN::Environment* env) {
+	if (!gl.have)
+		return;
+	const string prim(mode == GL_TRIANGLES? " independent triangle":
+		" triangle strip");
+
+	// Interleaved and planar vertices; 32- and 16-bit indices:
+	GLuint buffers[4];
+	gl.GenBuffers(4, buffers);
+
+	gl.BindBuffer(GL_ARRAY_BUFFER_ARB, buffers[0]);
+	gl.BufferData(GL_ARRAY_BUFFER_ARB, nVertices * sizeof(V), data,
+		GL_STATIC_DRAW_ARB);
+	vector<GLubyte> planar;
+	makePlanar(data, nVertices, planar);
+	gl.BindBuffer(GL_ARRAY_BUFFER_ARB, buffers[1]);
+	gl.BufferData(GL_ARRAY_BUFFER_ARB, planar.size(), &planar[0],
+		GL_STATIC_DRAW_ARB);
+
+	vector<GLuint> indices(nVertices);
+	vector<GLushort> shortIndices(nVertices);
+	for (int i = 0; i < nVertices; ++i)
+		shortIndices[i] = indices[i] = i;
+	gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER_ARB, buffers[3]);
+	gl.BufferData(GL_ELEMENT_ARRAY_BUFFER_ARB,
+		nVertices * sizeof(GLushort), &shortIndices[0],
+		GL_STATIC_DRAW_ARB);
+	gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER_ARB, buffers[2]);
+	gl.BufferData(GL_ELEMENT_ARRAY_BUFFER_ARB,
+		nVertices * sizeof(GLuint), &indices[0], GL_STATIC_DRAW_ARB);
+
+	drawArraysTimer da(mode, nVertices, nTris, w, env);
+	bufferPointers<V>(nVertices, true);
+	measureSub(da, r.pl);
+	checker.check(r.pl, bufferPathTitles[1] + prim);
+
+	gl.BindBuffer(GL_ARRAY_BUFFER_ARB, buffers[0]);
+	bufferPointers<V>(nVertices, false);
+	measureSub(da, r.da);
+	checker.check(r.da, bufferPathTitles[0] + prim);
+
+	drawElementsTimer de(mode, GL_UNSIGNED_INT, nVertices, nTris, w, env);
+	measureSub(de, r.de);
+	checker.check(r.de, bufferPathTitles[2] + prim);
+
+	if (gl.DrawRangeElements) {
+		drawRangeElementsTimer dre(mode, gl.DrawRangeElements,
+			nVertices, nTris, w, env);
+		measureSub(dre, r.dre);
+		checker.check(r.dre, bufferPathTitles[4] + prim);
+	}
+
+	if (gl.MultiDrawElements) {
+		multiDrawElementsTimer mde(mode, gl.MultiDrawElements,
+			nVertices, nTris, w, env);
+		measureSub(mde, r.mde);
+		checker.check(r.mde, bufferPathTitles[5] + prim);
+	}
+
+	// (Our meshes always fit in 16-bit indices, but guard against a
+	// larger drawingSize.)
+	if (nVertices <= 65536) {
+		gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER_ARB, buffers[3]);
+		de.type = GL_UNSIGNED_SHORT;
+		measureSub(de, r.de16);
+		checker.check(r.de16, bufferPathTitles[3] + prim);
+	}
+	gl.BindBuffer(GL_ELEMENT_ARRAY_BUFFER_ARB, 0);
+
+	if (mode == GL_TRIANGLES && gl.instancing)
+		measureInstanced<V>(buffers[0], nTris, gl, r.in, checker,
+			w, env);
+
+	gl.BindBuffer(GL_ARRAY_BUFFER_ARB, 0);
+	gl.DeleteBuffers(4, buffers);
+} // measureBufferPaths
+
+void
+logBufferStats(const char* prim, GLEAN::VPBufferResult& r,
+    GLEAN::Environment* env) {
+	GLEAN::VPSubResult* paths[nBufferPaths];
+	bufferPaths(r, paths);
+	for (int i = 0; i < nBufferPaths; ++i)
+		if (paths[i]->tps > 0.0)
+			logStats1((string(bufferPathTitles[i]) + ' '
+				+ prim).c_str(), *paths[i], env);
+} // logBufferStats
+
+void
+compareBufferPaths(GLEAN::VPBufferResult& oldR, GLEAN::VPBufferResult& newR,
+    GLEAN::DrawingSurfaceConfig* config, bool& same, const string& name,
+    GLEAN::Environment* env, const char* prim) {
+	GLEAN::VPSubResult* oldPaths[nBufferPaths];
+	GLEAN::VPSubResult* newPaths[nBufferPaths];
+	bufferPaths(oldR, oldPaths);
+	bufferPaths(newR, newPaths);
+	for (int i = 0; i < nBufferPaths; ++i) {
+		const string title(string(bufferPathTitles[i]) + ' ' + prim);
+		const bool oldRan = oldPaths[i]->tps > 0.0;
+		const bool newRan = newPaths[i]->tps > 0.0;
+		if (oldRan && newRan)
+			doComparison(*oldPaths[i], *newPaths[i], config, same,
+				name, env, title.c_str());
+		else if (oldRan != newRan) {
+			diffHeader(same, name, config, env);
+			env->log << '\t' << (oldRan? env->options.db2Name:
+					env->options.db1Name)
+				<< " did not measure " << title
+				<< " drawing.\n";
+		}
+	}
+} // compareBufferPaths
+
 } // anonymous namespace
 
 namespace GLEAN {
@@ -431,6 +981,7 @@ ColoredLitPerf::runOne(VPResult& r, Window& w) {
 		glUnlockArraysEXT = reinterpret_cast<PFNGLUNLOCKARRAYSEXTPROC>
 			(GLUtils::getProcAddress("glUnlockArraysEXT"));
 	}
+	BufferEntryPoints bufferEntryPoints;
 
 	Image imTriImage(drawingSize, drawingSize, GL_RGB, GL_UNSIGNED_BYTE);
 	Image testImage(drawingSize, drawingSize, GL_RGB, GL_UNSIGNED_BYTE);
@@ -561,8 +1112,7 @@ ColoredLitPerf::runOne(VPResult& r, Window& w) {
 	////////////////////////////////////////////////////////////
 	ColoredLit_imIndTri coloredLit_imIndTri(nVertices, c4ub_n3f_v3f,
 						nTris, &w, env);
-	coloredLit_imIndTri.measure(5, &r.imTri.tpsLow, &r.imTri.tps,
-				    &r.imTri.tpsHigh);
+	measureSub(coloredLit_imIndTri, r.imTri);
 	imTriImage.read(0, 0);
 	verifyVtxPerf(testImage, colorGen, 0, lastID, imTriImage,
 	       passed, name, r.config, r.imTri, env,
@@ -576,7 +1126,7 @@ ColoredLitPerf::runOne(VPResult& r, Window& w) {
 	coloredLit_imIndTri.op();
 	glEndList();
 	callDListTimer callDList(dList, nTris, &w, env);
-	callDList.measure(5, &r.dlTri.tpsLow, &r.dlTri.tps, &r.dlTri.tpsHigh);
+	measureSub(callDList, r.dlTri);
 	glDeleteLists(dList, 1);
 	verifyVtxPerf(testImage, colorGen, 0, lastID, imTriImage,
 	       passed, name, r.config, r.dlTri, env,
@@ -596,7 +1146,7 @@ ColoredLitPerf::runOne(VPResult& r, Window& w) {
 	glEnableClientState(GL_VERTEX_ARRAY);
 
 	daIndTriTimer daIndTri(nVertices, indices, nTris, &w, env);
-	daIndTri.measure(5, &r.daTri.tpsLow, &r.daTri.tps, &r.daTri.tpsHigh);
+	measureSub(daIndTri, r.daTri);
 	verifyVtxPerf(testImage, colorGen, 0, lastID, imTriImage,
 		passed, name, r.config, r.daTri, env,
 		"DrawArrays independent triangle");
@@ -608,8 +1158,7 @@ ColoredLitPerf::runOne(VPResult& r, Window& w) {
 	////////////////////////////////////////////////////////////
 	if (glLockArraysEXT)
 		glLockArraysEXT(0, nVertices);
-	daIndTri.measure(5, &r.ldaTri.tpsLow, &r.ldaTri.tps,
-			 &r.ldaTri.tpsHigh);
+	measureSub(daIndTri, r.ldaTri);
 	if (glUnlockArraysEXT)
 		glUnlockArraysEXT();
 	if (!glLockArraysEXT)
@@ -622,7 +1171,7 @@ ColoredLitPerf::runOne(VPResult& r, Window& w) {
 	// DrawElements on independent triangles
 	////////////////////////////////////////////////////////////
 	deIndTriTimer deIndTri(nVertices, indices, nTris, &w, env);
-	deIndTri.measure(5, &r.deTri.tpsLow, &r.deTri.tps, &r.deTri.tpsHigh);
+	measureSub(deIndTri, r.deTri);
 	verifyVtxPerf(testImage, colorGen, 0, lastID, imTriImage,
 	       passed, name, r.config, r.deTri, env,
 	       "DrawElements independent triangle");
@@ -632,8 +1181,7 @@ ColoredLitPerf::runOne(VPResult& r, Window& w) {
 	////////////////////////////////////////////////////////////
 	if (glLockArraysEXT)
 		glLockArraysEXT(0, nVertices);
-	deIndTri.measure(5, &r.ldeTri.tpsLow, &r.ldeTri.tps,
-			 &r.ldeTri.tpsHigh);
+	measureSub(deIndTri, r.ldeTri);
 	if (glUnlockArraysEXT)
 		glUnlockArraysEXT();
 	if (!glLockArraysEXT)
@@ -642,6 +1190,14 @@ ColoredLitPerf::runOne(VPResult& r, Window& w) {
 	       passed, name, r.config, r.ldeTri, env,
 	       "Locked DrawElements independent triangle");
 
+	////////////////////////////////////////////////////////////
+	// Buffer objects on independent triangles
+	////////////////////////////////////////////////////////////
+	VtxChecker checker(testImage, colorGen, lastID, imTriImage, passed,
+		name, r.config, env);
+	measureBufferPaths(GL_TRIANGLES, c4ub_n3f_v3f, nVertices, nTris,
+		bufferEntryPoints, r.vboTri, checker, &w, env);
+
 	glDisableClientState(GL_COLOR_ARRAY);
 	glDisableClientState(GL_NORMAL_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
@@ -683,8 +1239,7 @@ ColoredLitPerf::runOne(VPResult& r, Window& w) {
 	////////////////////////////////////////////////////////////
 	ColoredLit_imTriStrip coloredLit_imTriStrip(nVertices, c4ub_n3f_v3f,
 						    nTris, &w, env);
-	coloredLit_imTriStrip.measure(5, &r.imTS.tpsLow, &r.imTS.tps,
-				      &r.imTS.tpsHigh);
+	measureSub(coloredLit_imTriStrip, r.imTS);
 	verifyVtxPerf(testImage, colorGen, 0, lastID, imTriImage,
 	       passed, name, r.config, r.imTS, env,
 	       "Immediate-mode triangle strip");
@@ -697,7 +1252,7 @@ ColoredLitPerf::runOne(VPResult& r, Window& w) {
 	coloredLit_imTriStrip.op();
 	glEndList();
 	callDList.dList = dList;
-	callDList.measure(5, &r.dlTS.tpsLow, &r.dlTS.tps, &r.dlTS.tpsHigh);
+	measureSub(callDList, r.dlTS);
 	glDeleteLists(dList, 1);
 	verifyVtxPerf(testImage, colorGen, 0, lastID, imTriImage,
 	       passed, name, r.config, r.dlTS, env,
@@ -717,7 +1272,7 @@ ColoredLitPerf::runOne(VPResult& r, Window& w) {
 	glEnableClientState(GL_VERTEX_ARRAY);
 
 	daTriStripTimer daTriStrip(nVertices, nTris, &w, env);
-	daTriStrip.measure(5, &r.daTS.tpsLow, &r.daTS.tps, &r.daTS.tpsHigh);
+	measureSub(daTriStrip, r.daTS);
 	verifyVtxPerf(testImage, colorGen, 0, lastID, imTriImage,
 	       passed, name, r.config, r.daTS, env,
 	       "DrawArrays triangle strip");
@@ -727,7 +1282,7 @@ ColoredLitPerf::runOne(VPResult& r, Window& w) {
 	////////////////////////////////////////////////////////////
 	if (glLockArraysEXT)
 		glLockArraysEXT(0, nVertices);
-	daTriStrip.measure(5, &r.ldaTS.tpsLow, &r.ldaTS.tps, &r.ldaTS.tpsHigh);
+	measureSub(daTriStrip, r.ldaTS);
 	if (glUnlockArraysEXT)
 		glUnlockArraysEXT();
 	if (!glLockArraysEXT)
@@ -740,7 +1295,7 @@ ColoredLitPerf::runOne(VPResult& r, Window& w) {
 	// DrawElements on triangle strips
 	////////////////////////////////////////////////////////////
 	deTriStripTimer deTriStrip(nVertices, indices, nTris, &w, env);
-	deTriStrip.measure(5, &r.deTS.tpsLow, &r.deTS.tps, &r.deTS.tpsHigh);
+	measureSub(deTriStrip, r.deTS);
 	verifyVtxPerf(testImage, colorGen, 0, lastID, imTriImage,
 	       passed, name, r.config, r.deTS, env,
 	       "DrawElements triangle strip");
@@ -750,7 +1305,7 @@ ColoredLitPerf::runOne(VPResult& r, Window& w) {
 	////////////////////////////////////////////////////////////
 	if (glLockArraysEXT)
 		glLockArraysEXT(0, nVertices);
-	deTriStrip.measure(5, &r.ldeTS.tpsLow, &r.ldeTS.tps, &r.ldeTS.tpsHigh);
+	measureSub(deTriStrip, r.ldeTS);
 	if (glUnlockArraysEXT)
 		glUnlockArraysEXT();
 	if (!glLockArraysEXT)
@@ -760,6 +1315,12 @@ ColoredLitPerf::runOne(VPResult& r, Window& w) {
 		passed, name, r.config, r.ldeTS, env,
 		"Locked DrawElements triangle strip");
 
+	////////////////////////////////////////////////////////////
+	// Buffer objects on triangle strips
+	////////////////////////////////////////////////////////////
+	measureBufferPaths(GL_TRIANGLE_STRIP, c4ub_n3f_v3f, nVertices, nTris,
+		bufferEntryPoints, r.vboTS, checker, &w, env);
+
 	glDisableClientState(GL_COLOR_ARRAY);
 	glDisableClientState(GL_NORMAL_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
@@ -839,16 +1400,18 @@ ColoredLitPerf::compareOne(VPResult& oldR, VPResult& newR) {
 		env, "DrawElements triangle strip");
 	doComparison(oldR.ldeTS, newR.ldeTS, newR.config, same, name,
 		env, "Locked DrawElements triangle strip");
+	compareBufferPaths(oldR.vboTri, newR.vboTri, newR.config, same, name,
+		env, "independent triangle");
+	compareBufferPaths(oldR.vboTS, newR.vboTS, newR.config, same, name,
+		env, "triangle strip");
 
 	if (same && env->options.verbosity) {
 		env->log << name << ":  SAME "
 			<< newR.config->conciseDescription()
-			<< "\n\t"
-			<< env->options.db2Name
-			<< " test time falls within the "
-			<< "valid measurement range of\n\t"
-			<< env->options.db1Name
-			<< " test time; both have the same"
+			<< "\n\tNo significant difference in test time"
+			<< " between " << env->options.db1Name
+			<< " and " << env->options.db2Name
+			<< ";\n\tboth have the same"
 			<< " image comparison results.\n";
 	}
 
@@ -874,6 +1437,8 @@ ColoredLitPerf::logStats(VPResult& r, GLEAN::Environment* env) {
 	logStats1("Locked DrawArrays triangle strip", r.ldaTS, env);
 	logStats1("DrawElements triangle strip", r.deTS, env);
 	logStats1("Locked DrawElements triangle strip", r.ldeTS, env);
+	logBufferStats("independent triangle", r.vboTri, env);
+	logBufferStats("triangle strip", r.vboTS, env);
 } // ColoredLitPerf::logStats
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -890,7 +1455,11 @@ ColoredLitPerf coloredLitPerfTest("coloredLitPerf2", "window, rgb, z, fast",
 	"specify the vertex data in order to determine which is\n"
 	"fastest:  fine-grained API calls, DrawArrays, DrawElements,\n"
 	"locked (compiled) DrawArrays, and locked DrawElements; for\n"
-	"independent triangles and for triangle strips.  The test\n"
+	"independent triangles and for triangle strips.  Where the\n"
+	"context supports them, it also checks buffer objects with\n"
+	"interleaved and planar arrays, DrawElements with 32- and\n"
+	"16-bit indices, DrawRangeElements, MultiDrawElements, and\n"
+	"(for independent triangles) instanced drawing.  The test\n"
 	"result is performance measured in triangles per second for\n"
 	"each of the various vertex specification methods.\n"
 
@@ -931,6 +1500,7 @@ ColoredTexPerf::runOne(VPResult& r, Window& w) {
 		glUnlockArraysEXT = reinterpret_cast<PFNGLUNLOCKARRAYSEXTPROC>
 			(GLUtils::getProcAddress("glUnlockArraysEXT"));
 	}
+	BufferEntryPoints bufferEntryPoints;
 
 	Image imTriImage(drawingSize, drawingSize, GL_RGB, GL_UNSIGNED_BYTE);
 	Image testImage(drawingSize, drawingSize, GL_RGB, GL_UNSIGNED_BYTE);
@@ -1079,8 +1649,7 @@ ColoredTexPerf::runOne(VPResult& r, Window& w) {
 	////////////////////////////////////////////////////////////
 	ColoredTex_imIndTri coloredTex_imIndTri(nVertices, c4ub_t2f_v3f,
 						nTris, &w, env);
-	coloredTex_imIndTri.measure(5, &r.imTri.tpsLow, &r.imTri.tps,
-				    &r.imTri.tpsHigh);
+	measureSub(coloredTex_imIndTri, r.imTri);
 	imTriImage.read(0, 0);
 	verifyVtxPerf(testImage, colorGen, 0, lastID, imTriImage,
 	       passed, name, r.config, r.imTri, env,
@@ -1094,7 +1663,7 @@ ColoredTexPerf::runOne(VPResult& r, Window& w) {
 	coloredTex_imIndTri.op();
 	glEndList();
 	callDListTimer callDList(dList, nTris, &w, env);
-	callDList.measure(5, &r.dlTri.tpsLow, &r.dlTri.tps, &r.dlTri.tpsHigh);
+	measureSub(callDList, r.dlTri);
 	glDeleteLists(dList, 1);
 	verifyVtxPerf(testImage, colorGen, 0, lastID, imTriImage,
 	       passed, name, r.config, r.dlTri, env,
@@ -1114,7 +1683,7 @@ ColoredTexPerf::runOne(VPResult& r, Window& w) {
 	glEnableClientState(GL_VERTEX_ARRAY);
 
 	daIndTriTimer daIndTri(nVertices, indices, nTris, &w, env);
-	daIndTri.measure(5, &r.daTri.tpsLow, &r.daTri.tps, &r.daTri.tpsHigh);
+	measureSub(daIndTri, r.daTri);
 	verifyVtxPerf(testImage, colorGen, 0, lastID, imTriImage,
 	       passed, name, r.config, r.daTri, env,
 	       "DrawArrays independent triangle");
@@ -1126,8 +1695,7 @@ ColoredTexPerf::runOne(VPResult& r, Window& w) {
 	////////////////////////////////////////////////////////////
 	if (glLockArraysEXT)
 		glLockArraysEXT(0, nVertices);
-	daIndTri.measure(5, &r.ldaTri.tpsLow, &r.ldaTri.tps,
-			 &r.ldaTri.tpsHigh);
+	measureSub(daIndTri, r.ldaTri);
 	if (glUnlockArraysEXT)
 		glUnlockArraysEXT();
 	if (!glLockArraysEXT)
@@ -1140,7 +1708,7 @@ ColoredTexPerf::runOne(VPResult& r, Window& w) {
 	// DrawElements on independent triangles
 	////////////////////////////////////////////////////////////
 	deIndTriTimer deIndTri(nVertices, indices, nTris, &w, env);
-	deIndTri.measure(5, &r.deTri.tpsLow, &r.deTri.tps, &r.deTri.tpsHigh);
+	measureSub(deIndTri, r.deTri);
 	verifyVtxPerf(testImage, colorGen, 0, lastID, imTriImage,
 	       passed, name, r.config, r.deTri, env,
 	       "DrawElements independent triangle");
@@ -1150,8 +1718,7 @@ ColoredTexPerf::runOne(VPResult& r, Window& w) {
 	////////////////////////////////////////////////////////////
 	if (glLockArraysEXT)
 		glLockArraysEXT(0, nVertices);
-	deIndTri.measure(5, &r.ldeTri.tpsLow, &r.ldeTri.tps,
-			 &r.ldeTri.tpsHigh);
+	measureSub(deIndTri, r.ldeTri);
 	if (glUnlockArraysEXT)
 		glUnlockArraysEXT();
 	if (!glLockArraysEXT)
@@ -1160,6 +1727,14 @@ ColoredTexPerf::runOne(VPResult& r, Window& w) {
 	       passed, name, r.config, r.ldeTri, env,
 	       "Locked DrawElements independent triangle");
 
+	////////////////////////////////////////////////////////////
+	// Buffer objects on independent triangles
+	////////////////////////////////////////////////////////////
+	VtxChecker checker(testImage, colorGen, lastID, imTriImage, passed,
+		name, r.config, env);
+	measureBufferPaths(GL_TRIANGLES, c4ub_t2f_v3f, nVertices, nTris,
+		bufferEntryPoints, r.vboTri, checker, &w, env);
+
 	glDisableClientState(GL_COLOR_ARRAY);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
 	glDisableClientState(GL_VERTEX_ARRAY);
@@ -1200,8 +1775,7 @@ ColoredTexPerf::runOne(VPResult& r, Window& w) {
 	////////////////////////////////////////////////////////////
 	ColoredTex_imTriStrip coloredTex_imTriStrip(nVertices, c4ub_t2f_v3f,
 						    nTris, &w, env);
-	coloredTex_imTriStrip.measure(5, &r.imTS.tpsLow, &r.imTS.tps,
-				      &r.imTS.tpsHigh);
+	measureSub(coloredTex_imTriStrip, r.imTS);
 	verifyVtxPerf(testImage, colorGen, 0, lastID, imTriImage,
 	       passed, name, r.config, r.imTS, env,
 	       "Immediate-mode triangle strip");
@@ -1214,7 +1788,7 @@ ColoredTexPerf::runOne(VPResult& r, Window& w) {
 	coloredTex_imTriStrip.op();
 	glEndList();
 	callDList.dList = dList;
-	callDList.measure(5, &r.dlTS.tpsLow, &r.dlTS.tps, &r.dlTS.tpsHigh);
+	measureSub(callDList, r.dlTS);
 	glDeleteLists(dList, 1);
 	verifyVtxPerf(testImage, colorGen, 0, lastID, imTriImage,
 	       passed, name, r.config, r.dlTS, env,
@@ -1234,7 +1808,7 @@ ColoredTexPerf::runOne(VPResult& r, Window& w) {
 	glEnableClientState(GL_VERTEX_ARRAY);
 
 	daTriStripTimer daTriStrip(nVertices, nTris, &w, env);
-	daTriStrip.measure(5, &r.daTS.tpsLow, &r.daTS.tps, &r.daTS.tpsHigh);
+	measureSub(daTriStrip, r.daTS);
 	verifyVtxPerf(testImage, colorGen, 0, lastID, imTriImage,
 	       passed, name, r.config, r.daTS, env,
 	       "DrawArrays triangle strip");
@@ -1244,7 +1818,7 @@ ColoredTexPerf::runOne(VPResult& r, Window& w) {
 	////////////////////////////////////////////////////////////
 	if (glLockArraysEXT)
 		glLockArraysEXT(0, nVertices);
-	daTriStrip.measure(5, &r.ldaTS.tpsLow, &r.ldaTS.tps, &r.ldaTS.tpsHigh);
+	measureSub(daTriStrip, r.ldaTS);
 	if (glUnlockArraysEXT)
 		glUnlockArraysEXT();
 	if (!glLockArraysEXT)
@@ -1257,7 +1831,7 @@ ColoredTexPerf::runOne(VPResult& r, Window& w) {
 	// DrawElements on triangle strips
 	////////////////////////////////////////////////////////////
 	deTriStripTimer deTriStrip(nVertices, indices, nTris, &w, env);
-	deTriStrip.measure(5, &r.deTS.tpsLow, &r.deTS.tps, &r.deTS.tpsHigh);
+	measureSub(deTriStrip, r.deTS);
 	verifyVtxPerf(testImage, colorGen, 0, lastID, imTriImage,
 	       passed, name, r.config, r.deTS, env,
 	       "DrawElements triangle strip");
@@ -1267,7 +1841,7 @@ ColoredTexPerf::runOne(VPResult& r, Window& w) {
 	////////////////////////////////////////////////////////////
 	if (glLockArraysEXT)
 		glLockArraysEXT(0, nVertices);
-	deTriStrip.measure(5, &r.ldeTS.tpsLow, &r.ldeTS.tps, &r.ldeTS.tpsHigh);
+	measureSub(deTriStrip, r.ldeTS);
 	if (glUnlockArraysEXT)
 		glUnlockArraysEXT();
 	if (!glLockArraysEXT)
@@ -1276,6 +1850,12 @@ ColoredTexPerf::runOne(VPResult& r, Window& w) {
 	       passed, name, r.config, r.ldeTS, env,
 	       "Locked DrawElements triangle strip");
 
+	////////////////////////////////////////////////////////////
+	// Buffer objects on triangle strips
+	////////////////////////////////////////////////////////////
+	measureBufferPaths(GL_TRIANGLE_STRIP, c4ub_t2f_v3f, nVertices, nTris,
+		bufferEntryPoints, r.vboTS, checker, &w, env);
+
 
 	glDisableClientState(GL_COLOR_ARRAY);
 	glDisableClientState(GL_TEXTURE_COORD_ARRAY);
@@ -1357,16 +1937,18 @@ ColoredTexPerf::compareOne(VPResult& oldR, VPResult& newR) {
 		env, "DrawElements triangle strip");
 	doComparison(oldR.ldeTS, newR.ldeTS, newR.config, same, name,
 		env, "Locked DrawElements triangle strip");
+	compareBufferPaths(oldR.vboTri, newR.vboTri, newR.config, same, name,
+		env, "independent triangle");
+	compareBufferPaths(oldR.vboTS, newR.vboTS, newR.config, same, name,
+		env, "triangle strip");
 
 	if (same && env->options.verbosity) {
 		env->log << name << ":  SAME "
 			<< newR.config->conciseDescription()
-			<< "\n\t"
-			<< env->options.db2Name
-			<< " test time falls within the "
-			<< "valid measurement range of\n\t"
-			<< env->options.db1Name
-			<< " test time; both have the same"
+			<< "\n\tNo significant difference in test time"
+			<< " between " << env->options.db1Name
+			<< " and " << env->options.db2Name
+			<< ";\n\tboth have the same"
 			<< " image comparison results.\n";
 	}
 
@@ -1392,6 +1974,8 @@ ColoredTexPerf::logStats(VPResult& r, GLEAN::Environment* env) {
 	logStats1("Locked DrawArrays triangle strip", r.ldaTS, env);
 	logStats1("DrawElements triangle strip", r.deTS, env);
 	logStats1("Locked DrawElements triangle strip", r.ldeTS, env);
+	logBufferStats("independent triangle", r.vboTri, env);
+	logBufferStats("triangle strip", r.vboTS, env);
 } // ColoredTexPerf::logStats
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -1408,7 +1992,11 @@ ColoredTexPerf coloredTexPerfTest("coloredTexPerf2", "window, rgb, z, fast",
 	"specify the vertex data in order to determine which is\n"
 	"fastest:  fine-grained API calls, DrawArrays, DrawElements,\n"
 	"locked (compiled) DrawArrays, and locked DrawElements; for\n"
-	"independent triangles and for triangle strips.  The test\n"
+	"independent triangles and for triangle strips.  Where the\n"
+	"context supports them, it also checks buffer objects with\n"
+	"interleaved and planar arrays, DrawElements with 32- and\n"
+	"16-bit indices, DrawRangeElements, MultiDrawElements, and\n"
+	"(for independent triangles) instanced drawing.  The test\n"
 	"result is performance measured in triangles per second for\n"
 	"each of the various vertex specification methods.\n"
 
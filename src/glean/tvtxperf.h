@@ -31,6 +31,7 @@
 #ifndef __tvtxperf_h__
 #define __tvtxperf_h__
 
+#include <sstream>
 #include "tbase.h"
 
 namespace GLEAN {
@@ -43,12 +44,18 @@ public:
 	double tps;		// Triangles Per Second
 	double tpsLow;		// Low end of tps range
 	double tpsHigh;		// High end of tps range
+	double cpuTps;		// tps based on CPU submission time only
+	double gpuTps;		// tps based on GPU execution time (0 if
+				// timer queries aren't supported)
 	bool imageOK;		// Image sanity-check status
 	bool imageMatch;	// Image comparison status
+	int samples;		// Number of timings behind tps (not
+				// saved; only for --export)
 
 	VPSubResult() {
-		tps = tpsLow = tpsHigh = 0.0;
+		tps = tpsLow = tpsHigh = cpuTps = gpuTps = 0.0;
 		imageOK = imageMatch = true;
+		samples = 0;
 	}
 	
 	void put(ostream& s) const {
@@ -57,11 +64,81 @@ public:
 		  << ' ' << tpsHigh
 		  << ' ' << imageOK
 		  << ' ' << imageMatch
+		  << ' ' << cpuTps
+		  << ' ' << gpuTps
 		  << '\n';
 	}
 	
 	void get(istream& s) {
-		s >> tps >> tpsLow >> tpsHigh >> imageOK >> imageMatch;
+		// cpuTps and gpuTps are missing from older results files:
+		string line;
+		s >> ws;
+		getline(s, line);
+		istringstream ls(line);
+		ls >> tps >> tpsLow >> tpsHigh >> imageOK >> imageMatch;
+		if (!(ls >> cpuTps >> gpuTps))
+			cpuTps = gpuTps = 0.0;
+	}
+
+	void measurements(vector<Measurement>& m, const string& name) const {
+		m.push_back(Measurement(name, "tri/s", tps, tpsLow, tpsHigh,
+			samples));
+		if (cpuTps > 0.0)
+			m.push_back(Measurement(name + ".cpu", "tri/s", cpuTps,
+				samples));
+		if (gpuTps > 0.0)
+			m.push_back(Measurement(name + ".gpu", "tri/s", gpuTps,
+				samples));
+	}
+};
+
+// Auxiliary struct for the buffer-object drawing paths of one kind of
+// primitive.  Paths the context doesn't support are left at zero.
+class VPBufferResult {
+public:
+	VPSubResult da;		// VBO DrawArrays, interleaved arrays
+	VPSubResult pl;		// VBO DrawArrays, planar arrays
+	VPSubResult de;		// VBO/IBO DrawElements, 32-bit indices
+	VPSubResult de16;	// VBO/IBO DrawElements, 16-bit indices
+	VPSubResult dre;	// VBO/IBO DrawRangeElements
+	VPSubResult mde;	// VBO/IBO MultiDrawElements
+	VPSubResult in;		// Instanced (independent triangles only)
+
+	void put(ostream& s) const {
+		da.put(s);
+		pl.put(s);
+		de.put(s);
+		de16.put(s);
+		dre.put(s);
+		mde.put(s);
+		in.put(s);
+	}
+
+	void get(istream& s) {
+		da.get(s);
+		pl.get(s);
+		de.get(s);
+		de16.get(s);
+		dre.get(s);
+		mde.get(s);
+		in.get(s);
+	}
+
+	void measurements(vector<Measurement>& m, const string& prim) const {
+		if (da.tps > 0.0)
+			da.measurements(m, "vda" + prim);
+		if (pl.tps > 0.0)
+			pl.measurements(m, "vpl" + prim);
+		if (de.tps > 0.0)
+			de.measurements(m, "vde" + prim);
+		if (de16.tps > 0.0)
+			de16.measurements(m, "vde16" + prim);
+		if (dre.tps > 0.0)
+			dre.measurements(m, "vdre" + prim);
+		if (mde.tps > 0.0)
+			mde.measurements(m, "vmde" + prim);
+		if (in.tps > 0.0)
+			in.measurements(m, "vin" + prim);
 	}
 };
 
@@ -83,6 +160,9 @@ public:
 	VPSubResult ldaTS;	// Locked DrawArrays triangle strip
 	VPSubResult deTS;	// DrawElements triangle strip
 	VPSubResult ldeTS;	// Locked DrawElements triangle strip
+
+	VPBufferResult vboTri;	// buffer-object independent triangles
+	VPBufferResult vboTS;	// buffer-object triangle strip
 		
 	virtual void putresults(ostream& s) const {
 		s
@@ -103,6 +183,10 @@ public:
 		ldaTS.put(s);
 		deTS.put(s);
 		ldeTS.put(s);
+
+		s << "vbo\n";
+		vboTri.put(s);
+		vboTS.put(s);
 	}
 	
 	virtual bool getresults(istream& s) {
@@ -123,8 +207,39 @@ public:
 		ldaTS.get(s);
 		deTS.get(s);
 		ldeTS.get(s);
-		
-		return s.good();
+
+		// Results files written before the buffer-object paths
+		// were measured end here:
+		bool ok = s.good();
+		if (ok && s.peek() == 'v') {
+			string tag;
+			s >> tag;
+			vboTri.get(s);
+			vboTS.get(s);
+			ok = s.good();
+		}
+		return ok;
+	}
+
+	virtual void measurements(vector<Measurement>& m) const {
+		if (skipped)
+			return;
+		imTri.measurements(m, "imTri");
+		dlTri.measurements(m, "dlTri");
+		daTri.measurements(m, "daTri");
+		ldaTri.measurements(m, "ldaTri");
+		deTri.measurements(m, "deTri");
+		ldeTri.measurements(m, "ldeTri");
+
+		imTS.measurements(m, "imTS");
+		dlTS.measurements(m, "dlTS");
+		daTS.measurements(m, "daTS");
+		ldaTS.measurements(m, "ldaTS");
+		deTS.measurements(m, "deTS");
+		ldeTS.measurements(m, "ldeTS");
+
+		vboTri.measurements(m, "Tri");
+		vboTS.measurements(m, "TS");
 	}
 };
 
@@ -133,6 +248,7 @@ public:
 	GLEAN_CLASS_WHO(ColoredLitPerf, VPResult,
 			drawingSize, drawingSize, true);
 	void logStats(VPResult& r, GLEAN::Environment* env);
+	virtual bool isBenchmark() const { return true; }
 }; // class ColoredLitPerf
 
 class ColoredTexPerf: public BaseTest<VPResult> {
@@ -140,6 +256,7 @@ public:
 	GLEAN_CLASS_WHO(ColoredTexPerf, VPResult,
 			drawingSize, drawingSize, true);
 	void logStats(VPResult& r, GLEAN::Environment* env);
+	virtual bool isBenchmark() const { return true; }
 }; // class ColoredTexPerf
 
 } // namespace GLEAN
@@ -32,6 +32,7 @@
 // winsys.cpp:  implementation of window-system services class
 
 #include <iostream>
+#include <cstring>
 #include "options.h"
 #include "winsys.h"
 #include "dsconfig.h"
@@ -49,15 +50,10 @@ namespace GLEAN {
 ///////////////////////////////////////////////////////////////////////////////
 #if defined(__X11__)
 WindowSystem::WindowSystem(Options& o) {
-	// If running in "compare" mode we never actually use the window
-	// system, so we don't initialize it here.  This allows us to run
-	// on systems without graphics hardware/software.
-	if (o.mode == Options::compare) {
-		dpy = 0;
-		GLXVersMajor = GLXVersMinor = 0;
-		vip = 0;
-		return;
-	}
+	// Tests that run configs on several threads share this display
+	// connection, so Xlib must be told before it's opened:
+	if (o.threads > 1)
+		XInitThreads();
 
 	// Open the X11 display:
 	dpy = XOpenDisplay(o.dpyName.c_str());
@@ -96,6 +92,78 @@ WindowSystem::WindowSystem(Options& o) {
 	surfConfigs = f.filter(glxv, o.maxVisuals);
 } // WindowSystem::WindowSystem
 
+#elif defined(__EGL__)
+
+namespace {
+
+// Open an EGL display that doesn't need a window system.  Mesa's
+// surfaceless platform is preferred; otherwise fall back on the
+// default display, which for most headless drivers is a GPU device.
+EGLDisplay
+openDisplay() {
+	const char* ext = eglQueryString(EGL_NO_DISPLAY, EGL_EXTENSIONS);
+#   if defined(EGL_EXT_platform_base) && defined(EGL_PLATFORM_SURFACELESS_MESA)
+	if (ext && strstr(ext, "EGL_EXT_platform_base")
+	    && strstr(ext, "EGL_MESA_platform_surfaceless")) {
+		PFNEGLGETPLATFORMDISPLAYEXTPROC getPlatformDisplay =
+			reinterpret_cast<PFNEGLGETPLATFORMDISPLAYEXTPROC>(
+			eglGetProcAddress("eglGetPlatformDisplayEXT"));
+		if (getPlatformDisplay) {
+			EGLDisplay dpy = getPlatformDisplay(
+				EGL_PLATFORM_SURFACELESS_MESA,
+				EGL_DEFAULT_DISPLAY, 0);
+			if (dpy != EGL_NO_DISPLAY)
+				return dpy;
+		}
+	}
+#   else
+	(void) ext;
+#   endif
+	return eglGetDisplay(EGL_DEFAULT_DISPLAY);
+} // openDisplay
+
+} // anonymous namespace
+
+WindowSystem::WindowSystem(Options& o) {
+	dpy = EGL_NO_DISPLAY;
+	EGLVersMajor = EGLVersMinor = 0;
+	eglConfigs = 0;
+
+	dpy = openDisplay();
+	if (dpy == EGL_NO_DISPLAY
+	    || !eglInitialize(dpy, &EGLVersMajor, &EGLVersMinor))
+		throw CantOpenDisplay();
+
+	// We need desktop OpenGL, not OpenGL ES:
+	if (!eglBindAPI(EGL_OPENGL_API))
+		throw NoOpenGL();
+
+	EGLint n = 0;
+	eglGetConfigs(dpy, 0, 0, &n);
+	eglConfigs = new EGLConfig[n];
+	eglGetConfigs(dpy, eglConfigs, n, &n);
+
+	// Every Window is really a pbuffer, so keep only the configs that
+	// support OpenGL rendering to pbuffers:
+	vector<DrawingSurfaceConfig*> eglv;
+	for (int i = 0; i < n; ++i) {
+		EGLint renderable, surfaces;
+		eglGetConfigAttrib(dpy, eglConfigs[i], EGL_RENDERABLE_TYPE,
+			&renderable);
+		eglGetConfigAttrib(dpy, eglConfigs[i], EGL_SURFACE_TYPE,
+			&surfaces);
+		if ((renderable & EGL_OPENGL_BIT)
+		    && (surfaces & EGL_PBUFFER_BIT))
+			eglv.push_back(new DrawingSurfaceConfig(dpy,
+				eglConfigs[i]));
+	}
+	if (eglv.empty())
+		throw NoOpenGL();
+
+	DrawingSurfaceFilter f(o.visFilter);	// may throw an exception!
+	surfConfigs = f.filter(eglv, o.maxVisuals);
+} // WindowSystem::WindowSystem
+
 #elif defined(__WIN__)
 WindowSystem::WindowSystem(Options& o) {
 	// register an window class
@@ -214,6 +282,13 @@ WindowSystem::~WindowSystem() {
 	XFree(vip);
 } // WindowSystem:: ~WindowSystem
 
+#elif defined(__EGL__)
+WindowSystem::~WindowSystem() {
+	if (dpy != EGL_NO_DISPLAY)
+		eglTerminate(dpy);
+	delete[] eglConfigs;
+} // WindowSystem:: ~WindowSystem
+
 #elif defined(__WIN__)
 WindowSystem::~WindowSystem() {
 }
@@ -237,6 +312,12 @@ WindowSystem::makeCurrent() {
 	    // XXX Need to write GLX 1.3 MakeCurrent code
 #	endif
 	    return glXMakeCurrent(dpy, None, 0);
+#   elif defined(__EGL__)
+	    // The bound API is per-thread state, and the release acts
+	    // on the bound API's context:
+	    eglBindAPI(EGL_OPENGL_API);
+	    return eglMakeCurrent(dpy, EGL_NO_SURFACE, EGL_NO_SURFACE,
+		EGL_NO_CONTEXT);
 #   elif defined(__WIN__)
 		return wglMakeCurrent(0,0);
 #   elif defined(__AGL__)
@@ -251,6 +332,12 @@ WindowSystem::makeCurrent(RenderingContext& r, Window& w) {
 	    // XXX Need to write GLX 1.3 MakeCurrent code
 #	endif
 	    return glXMakeCurrent(dpy, w.xWindow, r.rc);
+#   elif defined(__EGL__)
+	    // Threads other than the one that opened the display start
+	    // with the OpenGL ES API bound:
+	    if (!eglBindAPI(EGL_OPENGL_API))
+		    return false;
+	    return eglMakeCurrent(dpy, w.eglSurface, w.eglSurface, r.rc);
 #   elif defined(__WIN__)
 		return wglMakeCurrent(w.get_dc(),r.rc);
 #   elif defined(__AGL__)
@@ -266,6 +353,8 @@ void
 WindowSystem::quiesce() {
 #   if defined(__X11__)
 	XSync(dpy, False);
+#   elif defined(__EGL__)
+	// There's no window system server to wait for.
 #   elif defined(__WIN__)
 #   endif
 } // WindowSystem::quiesce
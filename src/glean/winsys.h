@@ -103,6 +103,14 @@ class WindowSystem {
 
 	XVisualInfo* vip;	// Array of raw XVisualInfo structures.
 
+#   elif defined(__EGL__)
+	EGLDisplay dpy;		// EGL display; no window system involved.
+
+	EGLint EGLVersMajor;	// EGL major version number.
+	EGLint EGLVersMinor;	// EGL minor version number.
+
+	EGLConfig* eglConfigs;	// Array of raw EGLConfigs.
+
 #   elif defined(__WIN__)
 
 #   elif defined(__BEWIN__)
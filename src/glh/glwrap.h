@@ -35,8 +35,9 @@
 // have our source files #include "glwrap.h" instead.
 
 // As a bonus we ensure that all declarations for GLU are included,
-// and on X11-based systems, we cover X11 and GLX as well.  This
-// should cover nearly everything needed by a typical glean test.
+// and on X11-based systems, we cover X11 and GLX as well (or EGL, for
+// headless builds).  This should cover nearly everything needed by a
+// typical glean test.
 
 // It's unfortunate that both Windows and Xlib are so casual about
 // polluting the global namespace.  The problem isn't easily resolved,
@@ -70,6 +71,18 @@
 #      define GLCALLBACK
 #  endif
 #  include <GL/glext.h>
+#elif defined(__EGL__)
+#  include <EGL/egl.h>
+#  include <EGL/eglext.h>
+#  include <GL/gl.h>
+#  include <GL/glu.h>
+#  if !defined(GLAPIENTRY)
+#      define GLAPIENTRY
+#  endif
+#  if !defined(GLCALLBACK)
+#      define GLCALLBACK
+#  endif
+#  include <GL/glext.h>
 #elif defined(__AGL__)
 #  include <Carbon/Carbon.h>
 #  include <OpenGL/glu.h>
@@ -91,7 +104,7 @@
 #      define sqrtf sqrt
 #  endif
 #else
-#  error "Improper window system configuration; must be __WIN__ or __X11__."
+#  error "Improper window system configuration; must be __WIN__, __X11__, __EGL__ or __AGL__."
 #endif
 
 #ifndef GL_COMBINE_EXT
@@ -185,6 +198,12 @@
 #endif
 
 
+#ifndef GL_ARB_timer_query
+#define GL_TIME_ELAPSED                   0x88BF
+#define GL_TIMESTAMP                      0x8E28
+#endif
+
+
 #ifndef GL_ARB_map_buffer_range
 #define GL_MAP_READ_BIT                   0x0001
 #define GL_MAP_WRITE_BIT                  0x0002
@@ -195,6 +214,17 @@
 #endif
 
 
+#ifndef GL_ARB_sync
+typedef struct __GLsync *GLsync;
+#define GL_SYNC_GPU_COMMANDS_COMPLETE     0x9117
+#define GL_ALREADY_SIGNALED               0x911A
+#define GL_TIMEOUT_EXPIRED                0x911B
+#define GL_CONDITION_SATISFIED            0x911C
+#define GL_WAIT_FAILED                    0x911D
+#define GL_SYNC_FLUSH_COMMANDS_BIT        0x00000001
+#endif
+
+
 #ifdef __APPLE__
 typedef unsigned short GLhalfARB;
 #endif
@@ -627,10 +657,19 @@ typedef void (GLAPIENTRY * PFNGLGETQUERYIVARBPROC) (GLenum target, GLenum pname,
 typedef void (GLAPIENTRY * PFNGLGETQUERYOBJECTIVARBPROC) (GLuint id, GLenum pname, GLint *params);
 typedef void (GLAPIENTRY * PFNGLGETQUERYOBJECTUIVARBPROC) (GLuint id, GLenum pname, GLuint *params);
 
+// GL_ARB_timer_query
+typedef void (GLAPIENTRY * PFNGLQUERYCOUNTERPROC) (GLuint id, GLenum target);
+typedef void (GLAPIENTRY * PFNGLGETQUERYOBJECTUI64VPROC) (GLuint id, GLenum pname, GLuint64EXT *params);
+
 // GL_ARB_map_buffer_range
 typedef GLvoid* (GLAPIENTRY * PFNGLMAPBUFFERRANGEPROC) (GLenum target, GLintptr offset, GLsizeiptr length, GLbitfield access);
 typedef void (GLAPIENTRY * PFNGLFLUSHMAPPEDBUFFERRANGEPROC) (GLenum target, GLintptr offset, GLsizeiptr length);
 
+// GL_ARB_sync
+typedef GLsync (GLAPIENTRY * PFNGLFENCESYNCPROC) (GLenum condition, GLbitfield flags);
+typedef void (GLAPIENTRY * PFNGLDELETESYNCPROC) (GLsync sync);
+typedef GLenum (GLAPIENTRY * PFNGLCLIENTWAITSYNCPROC) (GLsync sync, GLbitfield flags, GLuint64EXT timeout);
+
 // GL_ARB_copy_buffer
 typedef void (GLAPIENTRY * PFNGLCOPYBUFFERSUBDATAPROC) (GLenum readTarget, GLenum writeTarget, GLintptr readOffset, GLintptr writeOffset, GLsizeiptr size);
 
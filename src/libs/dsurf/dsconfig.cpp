@@ -188,6 +188,8 @@ DrawingSurfaceConfig::zeroFields()
 #  if defined(GLX_VERSION_1_3)
 	fbcID = 0;
 #  endif
+#elif defined(__EGL__)
+	eglConfigID = 0;
 #elif defined(__WIN__)
 	pfdID = 0;
 #elif defined(__AGL__)
@@ -360,6 +362,76 @@ DrawingSurfaceConfig::DrawingSurfaceConfig(::Display* dpy, ::GLXFBConfig* pfbc)
 } // DrawingSurfaceConfig::DrawingSurfaceConfig
 #endif
 
+#elif defined(__EGL__)
+
+DrawingSurfaceConfig::DrawingSurfaceConfig(::EGLDisplay dpy, ::EGLConfig config)
+{
+	if (!mapsInitialized)
+		initializeMaps();
+
+	EGLint var;
+
+	eglConfig = config;
+	eglGetConfigAttrib(dpy, config, EGL_CONFIG_ID, &var);
+	eglConfigID = var;
+
+	eglGetConfigAttrib(dpy, config, EGL_COLOR_BUFFER_TYPE, &var);
+	canRGBA = (var == EGL_RGB_BUFFER);
+	canCI = false;
+
+	eglGetConfigAttrib(dpy, config, EGL_BUFFER_SIZE, &var);
+	bufSize = var;
+
+	eglGetConfigAttrib(dpy, config, EGL_LEVEL, &var);
+	level = var;
+
+	// EGL pbuffers have a single color buffer, which GL treats as the
+	// back buffer.  Swapping is a no-op that leaves its contents
+	// intact, so tests that draw to GL_BACK and swap behave as they
+	// would with a double-buffered window.
+	db = true;
+	stereo = false;
+	aux = 0;
+
+	eglGetConfigAttrib(dpy, config, EGL_RED_SIZE, &var);
+	r = var;
+	eglGetConfigAttrib(dpy, config, EGL_GREEN_SIZE, &var);
+	g = var;
+	eglGetConfigAttrib(dpy, config, EGL_BLUE_SIZE, &var);
+	b = var;
+	eglGetConfigAttrib(dpy, config, EGL_ALPHA_SIZE, &var);
+	a = var;
+
+	eglGetConfigAttrib(dpy, config, EGL_DEPTH_SIZE, &var);
+	z = var;
+
+	eglGetConfigAttrib(dpy, config, EGL_STENCIL_SIZE, &var);
+	s = var;
+
+	accR = accG = accB = accA = 0;
+
+	// As elsewhere, samples=0 means no multisampling.
+	samples = 0;
+	eglGetConfigAttrib(dpy, config, EGL_SAMPLE_BUFFERS, &var);
+	if (var) {
+		eglGetConfigAttrib(dpy, config, EGL_SAMPLES, &var);
+		samples = var;
+	}
+
+	// Windows are implemented with pbuffers, so every config we
+	// accept can be used for one.
+	canWindow = true;
+
+	canWinSysRender = false;
+
+	eglGetConfigAttrib(dpy, config, EGL_CONFIG_CAVEAT, &var);
+	fast = (var != EGL_SLOW_CONFIG);
+	conformant = (var != EGL_NON_CONFORMANT_CONFIG);
+
+	transparent = false;
+	transR = transG = transB = transA = transI = 0;
+} // DrawingSurfaceConfig::DrawingSurfaceConfig
+
 #elif defined(__WIN__)
 
 DrawingSurfaceConfig::DrawingSurfaceConfig(int id, ::PIXELFORMATDESCRIPTOR *ppfd)
@@ -564,6 +636,8 @@ DrawingSurfaceConfig::DrawingSurfaceConfig(string& str) {
 			case VID:
 #			    if defined(__X11__)
 				visID = lex.iValue;
+#			    elif defined(__EGL__)
+				eglConfigID = lex.iValue;
 #			    endif
 				break;
 			case VFBCID:
@@ -714,6 +788,8 @@ DrawingSurfaceConfig::canonicalDescription() {
 #	    if defined(GLX_VERSION_1_3)
 		s << ' ' << mapVarToName[VFBCID] << ' ' << fbcID;
 #	    endif
+#	elif defined(__EGL__)
+		s << mapVarToName[VID] << ' ' << eglConfigID;
 #	elif defined(__WIN__)
 		s << mapVarToName[VID] << ' ' << pfdID;	    
 #	endif
@@ -851,10 +927,15 @@ DrawingSurfaceConfig::conciseDescription() {
 
 	{
 	s << ", ";
-	bool sep = false;
+#	if defined(__X11__)
+		// Only X11 has drawable types other than windows:
+		bool sep = false;
+#	endif
 	if (canWindow) {
 		s << "win";
-		sep = true;
+#		if defined(__X11__)
+			sep = true;
+#		endif
 	}
 #	if defined(__X11__)
 		if (canPixmap) {
@@ -895,6 +976,8 @@ DrawingSurfaceConfig::conciseDescription() {
 			if (fbcID)
 				s << ", fbcid " << fbcID;
 #		endif
+#	elif defined(__EGL__)
+		s << ", id " << eglConfigID;
 #	elif defined(__WIN__)
 			s << ", id " << pfdID;
 #	endif
@@ -982,6 +1065,8 @@ DrawingSurfaceConfig::equal(const DrawingSurfaceConfig &config) const
 #  if defined(GLX_VERSION_1_3)
 	    fbcID == config.fbcID &&
 #  endif
+#elif defined(__EGL__)
+	    eglConfigID == config.eglConfigID &&
 #elif defined(__WIN__)
 	    pfdID == config.pfdID &&
 #elif defined(__AGL__)
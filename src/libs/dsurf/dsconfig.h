@@ -36,8 +36,8 @@
 // This class abstracts the basic characteristics of drawing surfaces
 // (size, depth, ancillary buffers, etc.) and operations on them.  It
 // serves as a wrapper for X11 Visual and FBConfig information on
-// X11-based systems, and PixelFormatDescriptor information on
-// Win32-based systems.
+// X11-based systems, EGLConfig information on headless EGL systems,
+// and PixelFormatDescriptor information on Win32-based systems.
 
 
 #ifndef __dsconfig_h__
@@ -61,6 +61,8 @@ class DrawingSurfaceConfig {
 #     if defined(GLX_VERSION_1_3)
 	DrawingSurfaceConfig(::Display* dpy, ::GLXFBConfig* pfbc);
 #     endif
+#   elif defined(__EGL__)
+	DrawingSurfaceConfig(::EGLDisplay dpy, ::EGLConfig config);
 #   elif defined(__WIN__)
 	DrawingSurfaceConfig(int id, ::PIXELFORMATDESCRIPTOR *ppfd);
 #   elif defined(__BEWIN__)
@@ -92,6 +94,9 @@ class DrawingSurfaceConfig {
 	::GLXFBConfig* fbc;
 	::XID fbcID;			// Framebuffer Config ID.
 #     endif
+#   elif defined(__EGL__)
+	::EGLConfig eglConfig;		// EGL config handle
+	int eglConfigID;		// EGL_CONFIG_ID
 #   elif defined(__WIN__)
 	::PIXELFORMATDESCRIPTOR *pfd;
 	int pfdID;
@@ -311,6 +311,8 @@ DrawingSurfaceFilter::FetchVariable(const DrawingSurfaceConfig& c, Token v) {
 	case VAR_ID:
 #		if defined(__X11__)
 			return c.visID;
+#		elif defined(__EGL__)
+			return c.eglConfigID;
 #		elif defined(__WIN__)
 			return c.pfdID;
 #		endif
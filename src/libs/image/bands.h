@@ -0,0 +1,114 @@
+// BEGIN_COPYRIGHT
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+
+
+
+// bands.h:  images processed a band of rows at a time
+
+// Very large images (readbacks of 8K offscreen surfaces, say) needn't be
+// held in memory whole.  A producer (such as glean's BandedReadback)
+// can deliver an image as a sequence of bands, each an Image a few rows
+// high, to any number of BandSinks, which write or examine each band and
+// then let it go.
+//
+// Bands are delivered top first, because that's the order of the strips
+// in a TIFF file.  Within a band, rows run bottom to top as in any other
+// Image, and y is the number of the band's bottom row in the whole
+// image.  All bands have the same height, except perhaps the last (the
+// bottom one).
+
+#ifndef __bands_h__
+#define __bands_h__
+
+#include <string>
+#include <vector>
+#include "image.h"
+
+namespace GLEAN {
+
+class BandSink {
+    public:
+	virtual ~BandSink() { }
+
+	// Called before the first band, with an image that has the
+	// size, format, and type of the whole image (but no pixels):
+	virtual void begin(Image& whole) { }
+
+	virtual void band(GLsizei y, Image& rows) = 0;
+
+	// Called after the last band:
+	virtual void end() { }
+}; // class BandSink
+
+// TIFFBandWriter writes the image to a TIFF file, one strip per band,
+// compressed as set by Image::setTIFFCompression().  (The file is always
+// written in strips; Image::setTIFFTileSize() doesn't apply.)
+class TIFFBandWriter: public BandSink {
+    public:
+	TIFFBandWriter(const std::string& filename);
+	virtual ~TIFFBandWriter();
+
+	virtual void begin(Image& whole);	// May throw Image::CantOpen,
+						// BadFormat, or BadType
+	virtual void band(GLsizei y, Image& rows);
+	virtual void end();
+
+    private:
+	std::string _filename;
+	::tiff* _tiff;
+	GLsizei _height;
+	GLsizei _rowsPerStrip;
+	std::vector<char> _strip;
+
+	TIFFBandWriter(const TIFFBandWriter&);		// not copyable
+	TIFFBandWriter& operator=(const TIFFBandWriter&);
+}; // class TIFFBandWriter
+
+// BandDiff compares each band to the same rows of a reference image, as
+// Image::diff() does, and accumulates the result.
+class BandDiff: public BandSink {
+    public:
+	BandDiff(Image& reference, double threshold = 0.0);
+
+	virtual void begin(Image& whole);	// May throw
+						// Image::SizeMismatch
+	virtual void band(GLsizei y, Image& rows);
+
+	const Image::Difference& difference() const
+		{ return _difference; }
+
+    private:
+	Image& _reference;
+	double _threshold;
+	Image::Difference _difference;
+}; // class BandDiff
+
+} // namespace GLEAN
+
+#endif // __bands_h__
@@ -0,0 +1,369 @@
+// BEGIN_COPYRIGHT
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+
+
+
+// Image comparison metrics.
+
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#include <vector>
+#include <string.h>
+#include "image.h"
+#include "simd.h"
+
+using namespace std;
+
+
+namespace GLEAN {
+
+namespace {
+
+// SSIM stabilizing constants, for a dynamic range of 1:
+const double C1 = 0.01 * 0.01;
+const double C2 = 0.03 * 0.03;
+
+///////////////////////////////////////////////////////////////////////////////
+// hasChannels:  note which of R, G, B, and A an image format supplies
+///////////////////////////////////////////////////////////////////////////////
+void
+hasChannels(GLenum format, bool* channel) {
+	switch (format) {
+	case GL_LUMINANCE:
+		channel[0] = true;
+		break;
+	case GL_LUMINANCE_ALPHA:
+		channel[0] = channel[3] = true;
+		break;
+	case GL_RGB:
+	case GL_BGR:
+		channel[0] = channel[1] = channel[2] = true;
+		break;
+	default:
+		channel[0] = channel[1] = channel[2] = channel[3] = true;
+		break;
+	}
+} // hasChannels
+
+///////////////////////////////////////////////////////////////////////////////
+// Components:  connected-component labeling of the differing pixels.
+//	Each row's differing pixels are recorded as runs, and each run is
+//	joined (with union-find) to the runs it touches in the row below,
+//	so only the runs are ever stored, never a label per pixel.
+///////////////////////////////////////////////////////////////////////////////
+class Components {
+public:
+	Components(): rowBegin(0) { }
+
+	// Add the runs of pixels in row y whose error exceeds the
+	// tolerance; returns the number of pixels in them.
+	GLsizei addRow(GLsizei y, GLsizei w, const float* error,
+		const float* tolerance, GLsizei toleranceStep);
+
+	// Note a row with no runs.
+	void skipRow() { rowBegin = runs.size(); }
+
+	// The regions, largest first.
+	void regions(vector<Image::Region>& result);
+
+private:
+	struct Run {
+		GLsizei y;
+		GLsizei begin, end;	// [begin, end)
+		size_t parent;
+	};
+	vector<Run> runs;
+	size_t rowBegin;		// first run in the latest row
+
+	size_t find(size_t i) {
+		while (runs[i].parent != i)
+			i = runs[i].parent = runs[runs[i].parent].parent;
+		return i;
+	}
+	void join(size_t i, size_t j) {
+		i = find(i);
+		j = find(j);
+		if (i < j)
+			runs[j].parent = i;
+		else
+			runs[i].parent = j;
+	}
+};
+
+GLsizei
+Components::addRow(GLsizei y, GLsizei w, const float* error,
+    const float* tolerance, GLsizei toleranceStep) {
+	size_t below = rowBegin;	// runs in row y - 1
+	size_t belowEnd = runs.size();
+	rowBegin = runs.size();
+
+	GLsizei count = 0;
+	for (GLsizei x = 0; x < w; ) {
+		if (!(error[x] > tolerance[x * toleranceStep])) {
+			++x;
+			continue;
+		}
+		Run r;
+		r.y = y;
+		r.begin = x;
+		while (x < w && error[x] > tolerance[x * toleranceStep])
+			++x;
+		r.end = x;
+		r.parent = runs.size();
+		runs.push_back(r);
+		count += r.end - r.begin;
+
+		// Runs below that touch this one, diagonals included:
+		while (below < belowEnd && runs[below].end < r.begin)
+			++below;
+		for (size_t i = below;
+		    i < belowEnd && runs[i].begin <= r.end; ++i)
+			join(i, r.parent);
+	}
+	return count;
+} // Components::addRow
+
+bool
+larger(const Image::Region& a, const Image::Region& b) {
+	if (a.pixels != b.pixels)
+		return a.pixels > b.pixels;
+	if (a.y != b.y)
+		return a.y < b.y;
+	return a.x < b.x;
+} // larger
+
+void
+Components::regions(vector<Image::Region>& result) {
+	result.clear();
+	vector<size_t> index(runs.size());
+	for (size_t i = 0; i < runs.size(); ++i) {
+		const Run& r = runs[i];
+		size_t root = find(i);
+		if (root == i) {
+			// Roots are always the earliest run in their
+			// region, so they're seen first.
+			index[i] = result.size();
+			Image::Region g;
+			g.pixels = 0;
+			g.x = r.begin;
+			g.y = r.y;
+			g.width = r.end;	// right edge, for now
+			g.height = r.y;		// top row, for now
+			result.push_back(g);
+		}
+		Image::Region& g = result[index[root]];
+		g.pixels += r.end - r.begin;
+		g.x = min(g.x, r.begin);
+		g.width = max(g.width, r.end);
+		g.height = r.y;
+	}
+	for (size_t i = 0; i < result.size(); ++i) {
+		result[i].width -= result[i].x;
+		result[i].height -= result[i].y - 1;
+	}
+	sort(result.begin(), result.end(), larger);
+} // Components::regions
+
+///////////////////////////////////////////////////////////////////////////////
+// addToHistogram:  count a row's pixels by error, in steps of 1/255.
+//	Pixels with no error are counted apart, since they're the majority.
+///////////////////////////////////////////////////////////////////////////////
+void
+addToHistogram(vector<GLsizei>& histogram, GLsizei w, const float* error,
+    float largest) {
+	GLsizei exact = w;
+	if (largest > 0.0f) {
+		exact = 0;
+		for (GLsizei j = 0; j < w; ++j) {
+			if (error[j] == 0.0f) {
+				++exact;
+				continue;
+			}
+			float e = error[j] * 255.0f + 0.5f;
+			++histogram[e < 255.0f? static_cast<int>(e): 255];
+		}
+	}
+	histogram[0] += exact;
+} // addToHistogram
+
+///////////////////////////////////////////////////////////////////////////////
+// loadTolerance:  unpack one row of a tolerance mask.  Negative tolerances
+//	(from masks with signed components) are treated as 0, so that pixels
+//	that match exactly never differ.
+///////////////////////////////////////////////////////////////////////////////
+void
+loadTolerance(Image& mask, GLsizei i, vector<float>& tol) {
+	mask.unpack(mask.width(), &tol[0], mask.row(i));
+	for (size_t j = 0; j < tol.size(); j += 4)
+		if (tol[j] < 0.0f)
+			tol[j] = 0.0f;
+} // loadTolerance
+
+///////////////////////////////////////////////////////////////////////////////
+// bandSSIM:  finish a band of SSIM windows (see SIMD::compare()) that's
+//	rows high, and clear the sums for the next one.  Returns the sum of
+//	the windows' SSIM, each weighted by the number of pixels it covers.
+///////////////////////////////////////////////////////////////////////////////
+double
+bandSSIM(vector<float>& window, GLsizei w, GLsizei rows) {
+	double total = 0.0;
+	for (GLsizei k = 0; 8 * k < w; ++k) {
+		double s[5] = {0.0, 0.0, 0.0, 0.0, 0.0};
+		for (int m = 0; m < 40; ++m)
+			s[m / 8] += window[40 * k + m];
+		double n = rows * min(8, w - 8 * k);
+		double mx = s[0] / n;
+		double my = s[1] / n;
+		double vx = s[2] / n - mx * mx;
+		double vy = s[3] / n - my * my;
+		double cxy = s[4] / n - mx * my;
+		total += n * (2.0 * mx * my + C1) * (2.0 * cxy + C2)
+			/ ((mx * mx + my * my + C1) * (vx + vy + C2));
+	}
+	fill(window.begin(), window.end(), 0.0f);
+	return total;
+} // bandSSIM
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// compare:  measure the differences between the current image and
+//	another of the same size.  Both are unpacked one row at a time, and
+//	SIMD::compare() finds the error at each pixel and the sums for PSNR
+//	and SSIM.  The rest (tolerance tests, histogram, and regions) works
+//	on the per-pixel errors, and is skipped for rows without any.  Bands
+//	of 8 rows (the height of the SSIM windows) whose bytes are identical
+//	aren't unpacked at all.
+///////////////////////////////////////////////////////////////////////////////
+Image::Comparison
+Image::compare(Image& img, double tolerance, Image* toleranceMask) {
+	GLsizei w = width();
+	GLsizei h = height();
+	if (img.width() != w || img.height() != h)
+		throw SizeMismatch();
+	if (toleranceMask && (toleranceMask->width() != w
+	    || toleranceMask->height() != h))
+		throw SizeMismatch();
+
+	Comparison c;
+	c.pixels = 0;
+	c.psnr = numeric_limits<double>::infinity();
+	c.ssim = 1.0;
+	c.histogram.resize(256, 0);
+	if (w == 0 || h == 0)
+		return c;
+
+	// PSNR counts only the components the images have, and SSIM
+	// weights them for luminance if there's any color:
+	bool channel[4] = {false, false, false, false};
+	hasChannels(format(), channel);
+	hasChannels(img.format(), channel);
+	float weights[3] = {1.0f, 0.0f, 0.0f};
+	if (channel[1]) {
+		weights[0] = 0.299f;
+		weights[1] = 0.587f;
+		weights[2] = 0.114f;
+	}
+
+	bool sameLayout = format() == img.format() && type() == img.type();
+	size_t rowBytes = static_cast<size_t>(w) * pixelSizeInBytes();
+	vector<float> a(4 * w);
+	vector<float> b(4 * w);
+	vector<float> error(w);
+	vector<float> tol(toleranceMask? 4 * w: 1,
+		static_cast<float>(max(tolerance, 0.0)));
+	vector<float> squares(32, 0.0f);
+	double sumSquares[4] = {0.0, 0.0, 0.0, 0.0};
+	vector<float> window(40 * ((w + 7) / 8), 0.0f);
+	double ssimSum = 0.0;
+	Components components;
+
+	for (GLsizei band = 0; band < h; band += 8) {
+		GLsizei rows = min(8, h - band);
+
+		// Most bands of most comparisons are identical; they have
+		// no error, and perfect similarity:
+		bool identical = sameLayout;
+		for (GLsizei i = band; identical && i < band + rows; ++i)
+			identical = !memcmp(row(i), img.row(i), rowBytes);
+		if (identical) {
+			c.histogram[0] += rows * w;
+			ssimSum += static_cast<double>(rows) * w;
+			for (GLsizei i = band; i < band + rows; ++i)
+				components.skipRow();
+			continue;
+		}
+
+		for (GLsizei i = band; i < band + rows; ++i) {
+			unpack(w, &a[0], row(i));
+			const float* other = &a[0];
+			if (!sameLayout
+			 || memcmp(row(i), img.row(i), rowBytes)) {
+				img.unpack(w, &b[0], img.row(i));
+				other = &b[0];
+			}
+			float largest = SIMD::compare(w, &a[0], other, weights,
+				&error[0], &squares[0], &window[0]);
+			for (int k = 0; k < 32; ++k) {
+				sumSquares[k / 8] += squares[k];
+				squares[k] = 0.0f;
+			}
+
+			addToHistogram(c.histogram, w, &error[0], largest);
+			if (largest == 0.0f
+			 || (!toleranceMask && largest <= tol[0]))
+				components.skipRow();
+			else {
+				if (toleranceMask)
+					loadTolerance(*toleranceMask, i, tol);
+				c.pixels += components.addRow(i, w, &error[0],
+					&tol[0], toleranceMask? 4: 0);
+			}
+		}
+
+		ssimSum += bandSSIM(window, w, rows);
+	}
+
+	double sum = 0.0;
+	int present = 0;
+	for (int k = 0; k < 4; ++k)
+		if (channel[k]) {
+			sum += sumSquares[k];
+			++present;
+		}
+	double mse = sum / (static_cast<double>(present) * w * h);
+	if (mse > 0.0)
+		c.psnr = -10.0 * log10(mse);
+	c.ssim = ssimSum / (static_cast<double>(w) * h);
+	components.regions(c.regions);
+	return c;
+} // Image::compare
+
+}; // namespace GLEAN
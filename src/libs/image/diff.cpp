@@ -0,0 +1,137 @@
+// BEGIN_COPYRIGHT
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+
+
+
+// Image difference.
+
+#include <vector>
+#include <string.h>
+#include "image.h"
+#include "bands.h"
+#include "simd.h"
+
+using namespace std;
+
+
+namespace GLEAN {
+
+///////////////////////////////////////////////////////////////////////////////
+// diff:  compare the current image with another of the same size.
+//	Both are unpacked to single-precision RGBA one row at a time, and
+//	each pixel is tested against the threshold with SIMD::exceeds().
+//	Rows whose bytes are identical (which is most of them, for most
+//	comparisons) are skipped when the two images have the same format
+//	and type, since they can't contribute anything.
+//
+//	Works on mapped images (see mapTIFF()) without copying them.
+///////////////////////////////////////////////////////////////////////////////
+Image::Difference
+Image::diff(Image& img, double threshold, Image* mask) {
+	GLsizei w = width();
+	GLsizei h = height();
+	if (img.width() != w || img.height() != h)
+		throw SizeMismatch();
+
+	Difference d;
+	d.pixels = 0;
+	for (int c = 0; c < 4; ++c)
+		d.maxError[c] = 0.0;
+
+	if (mask) {
+		Image m(w, h, GL_LUMINANCE, GL_UNSIGNED_BYTE);
+		mask->swap(m);
+	}
+	if (w == 0 || h == 0)
+		return d;
+
+	bool sameLayout = format() == img.format() && type() == img.type();
+	size_t rowBytes = static_cast<size_t>(w) * pixelSizeInBytes();
+	vector<float> a(4 * w);
+	vector<float> b(4 * w);
+	vector<GLubyte> rowMask(w);
+	float maxError[4] = {0.0f, 0.0f, 0.0f, 0.0f};
+	float t = static_cast<float>(threshold);
+
+	for (GLsizei i = 0; i < h; ++i) {
+		if (sameLayout && !memcmp(row(i), img.row(i), rowBytes))
+			continue;	// mask rows start out zero
+		unpack(w, &a[0], row(i));
+		img.unpack(w, &b[0], img.row(i));
+		d.pixels += SIMD::exceeds(w, &a[0], &b[0], t, &rowMask[0],
+			maxError);
+		if (mask)
+			memcpy(mask->writableRow(i), &rowMask[0], w);
+	}
+
+	for (int c = 0; c < 4; ++c)
+		d.maxError[c] = maxError[c];
+	return d;
+} // Image::diff
+
+///////////////////////////////////////////////////////////////////////////////
+// BandDiff - compare an image to a reference a band at a time (see bands.h)
+///////////////////////////////////////////////////////////////////////////////
+BandDiff::BandDiff(Image& reference, double threshold):
+    _reference(reference), _threshold(threshold) {
+	_difference.pixels = 0;
+	for (int c = 0; c < 4; ++c)
+		_difference.maxError[c] = 0.0;
+} // BandDiff::BandDiff
+
+void
+BandDiff::begin(Image& whole) {
+	if (whole.width() != _reference.width()
+	 || whole.height() != _reference.height())
+		throw Image::SizeMismatch();
+	_difference.pixels = 0;
+	for (int c = 0; c < 4; ++c)
+		_difference.maxError[c] = 0.0;
+} // BandDiff::begin
+
+// The reference rows are copied into a band of their own; that's cheap
+// next to unpacking them, and works for mapped references too.
+void
+BandDiff::band(GLsizei y, Image& rows) {
+	GLsizei n = rows.height();
+	Image part(_reference.width(), n, _reference.format(),
+		_reference.type());
+	size_t rowBytes = static_cast<size_t>(_reference.width())
+		* _reference.pixelSizeInBytes();
+	for (GLsizei i = 0; i < n; ++i)
+		memcpy(part.writableRow(i), _reference.row(y + i), rowBytes);
+
+	Image::Difference d = rows.diff(part, _threshold);
+	_difference.pixels += d.pixels;
+	for (int c = 0; c < 4; ++c)
+		if (d.maxError[c] > _difference.maxError[c])
+			_difference.maxError[c] = d.maxError[c];
+} // BandDiff::band
+
+}; // namespace GLEAN
@@ -40,9 +40,18 @@
 #define __image_h__
 
 #include <string>
+#include <vector>
 #include "glwrap.h"
 #include "stats.h"
 
+// Compilers with rvalue references get move construction and assignment
+// for Images; with older ones, use swap().
+#if __cplusplus >= 201103L || (defined(_MSC_VER) && _MSC_VER >= 1600)
+#define GLEAN_IMAGE_MOVE
+#endif
+
+struct tiff;				// libtiff's TIFF
+
 namespace GLEAN {
 
 class Image {
@@ -54,6 +63,8 @@ class Image {
 	GLenum _format;
 	GLenum _type;
 	char* _pixels;
+	void* _mapping;			// Memory-mapped file holding the
+	size_t _mappingSize;		// pixels (see mapTIFF()), or null
 	GLsizei _alignment;
 	GLsizei _rowSizeInBytes;
 	GLsizei _pixelSizeInBytes;
@@ -63,6 +74,7 @@ class Image {
 		vbPixelSizeInBytes = 2,
 		vbPacker = 4,
 		vbUnpacker = 8,
+		vbFloatUnpacker = 16,
 		vbAll = ~0
 	};
 	int _invalid;
@@ -74,9 +86,19 @@ class Image {
 	GLsizei validateRowSizeInBytes();
 	GLsizei validatePixelSizeInBytes();
 
-	typedef void Unpacker(GLsizei n, double* rgba, char* nextPixel);
+	void releasePixels();		// Free or unmap the pixel array
+
+	::tiff* createTIFF(const char* filename);
+					// Open a TIFF file for output, and
+					// describe the image in it; shared
+	friend class TIFFBandWriter;	// with TIFFBandWriter (bands.h)
+
+	typedef void Unpacker(GLsizei n, double* rgba, const char* nextPixel);
 	Unpacker* _unpacker;
 	Unpacker* validateUnpacker();
+	typedef void FloatUnpacker(GLsizei n, float* rgba, const char* nextPixel);
+	FloatUnpacker* _floatUnpacker;
+	FloatUnpacker* validateFloatUnpacker();
 	typedef void Packer(GLsizei n, char* nextPixel, double* rgba);
 	Packer* _packer;
 	Packer* validatePacker();
@@ -118,6 +140,8 @@ class Image {
 	};
 	struct RefImageTooLarge: public Error {	// Can't register ref image.
 	};
+	struct SizeMismatch: public Error {	// Images differ in size.
+	};
 
 	// Constructors/Destructor:
 
@@ -127,9 +151,20 @@ class Image {
 		double r, double g, double b, double a);
 	Image(Image& i);
 	Image& operator= (Image& i);
+#if defined(GLEAN_IMAGE_MOVE)
+	Image(Image&& i);
+	Image& operator= (Image&& i);
+#endif
 	~Image();
 
-	// Reserve space for the pixel array:
+	// Exchange everything, pixels included, with another image:
+
+	void swap(Image& i);
+
+	// Reserve space for the pixel array.  Pixel arrays come from a
+	// pool (see pool.h), so images that are created and destroyed
+	// over and over don't keep going back to the heap, and they're
+	// aligned on 64-byte boundaries.
 
 	void reserve();
 
@@ -152,7 +187,9 @@ class Image {
 		{ return _format; }	// these formats are supported:
 					// GL_LUMINANCE,
 					// GL_LUMINANCE_ALPHA,
-					// GL_RGB, GL_RGBA.
+					// GL_RGB, GL_RGBA,
+					// GL_BGR, GL_BGRA,
+					// GL_ABGR_EXT.
 					// It may be easiest to treat
 					// stencil, depth, etc. images
 					// as luminance images.
@@ -162,28 +199,60 @@ class Image {
 			  vbRowSizeInBytes
 			| vbPixelSizeInBytes
 			| vbPacker
-			| vbUnpacker);
+			| vbUnpacker
+			| vbFloatUnpacker);
 	}
 
 	inline GLenum type() const	// Pixel data type.  Currently
 		{ return _type; }	// these types are supported:
 					// GL_BYTE, GL_UNSIGNED_BYTE,
 					// GL_SHORT, GL_UNSIGNED_SHORT,
-					// GL_INT, GL_UNSIGNED_INT, GL_FLOAT.
+					// GL_INT, GL_UNSIGNED_INT, GL_FLOAT,
+					// and the packed types
+					// (GL_UNSIGNED_SHORT_5_6_5, etc.)
+					// with formats of matching size.
 	inline void type(GLenum t) {
 		_type = t;
 		invalidate(
 			  vbRowSizeInBytes
 			| vbPixelSizeInBytes
 			| vbPacker
-			| vbUnpacker);
+			| vbUnpacker
+			| vbFloatUnpacker);
 	}
 
-	inline char* pixels() 		// The pixels.
-		{ return _pixels; }
-	inline const char* pixels() const
-		{ return const_cast<const char*>(_pixels); }
-	void pixels(char* p);
+	inline char* pixels() {		// The pixels.  If the image is
+		if (_mapping)		// mapped (see mapTIFF()), they're
+			unmap();	// copied into memory first.
+		return _pixels;
+	}
+	inline const char* pixels() const	// Never copies; for a
+		{ return _pixels; }		// mapped image, this is
+						// the read-only bottom
+						// row (see row() below).
+	void pixels(char* p);		// p must come from
+					// PixelPool::allocate()
+
+	// Row access that works on mapped images (see mapTIFF()) without
+	// copying them.  A mapped image's rows are read-only, and are
+	// stored top to bottom, so the stride between them is negative.
+	// writableRow() copies a mapped image into memory first, as
+	// pixels() does.  Since that changes the image, a mapped image
+	// must be unmapped before it's shared among threads that might
+	// write to it.
+
+	inline bool mapped() const
+		{ return _mapping != 0; }
+	void unmap();			// Copy mapped pixels into memory
+	inline GLsizei rowStride()
+		{ return _mapping? -rowSizeInBytes(): rowSizeInBytes(); }
+	inline const char* row(GLsizei i)
+		{ return _pixels + i * rowStride(); }
+	inline char* writableRow(GLsizei i) {
+		if (_mapping)
+			unmap();
+		return _pixels + i * rowSizeInBytes();
+	}
 
 	inline GLsizei alignment() const	// Alignment.  See glPixelStore.
 		{ return _alignment; }
@@ -203,9 +272,16 @@ class Image {
 	// XXX Utilities to determine component size in bits/bytes?
 	// XXX Component range (min neg, max neg, min pos, max pos, eps?)
 
-	// Pixel packing/unpacking utilities:
+	// Pixel packing/unpacking utilities.  The common cases (RGB and
+	// RGBA images of unsigned bytes, unsigned shorts, or floats, and
+	// their BGR, BGRA, and ABGR orderings) use SSE2 or AVX2 where
+	// available; see simd.h.  Packed types are unpacked through tables
+	// of field values, and packed with rounding and clamping to [0,1].
+	// Single precision is plenty for images with 8- or 16-bit
+	// components, and unpacks faster.
 
-	void unpack(GLsizei n, double* rgba, char* nextPixel);
+	void unpack(GLsizei n, double* rgba, const char* nextPixel);
+	void unpack(GLsizei n, float* rgba, const char* nextPixel);
 	void pack(GLsizei n, char* nextPixel, double* rgba);
 	// XXX get(x, y, double* rgba);
 	// XXX put(x, y, double* rgba);
@@ -225,18 +301,98 @@ class Image {
 	};
 	Registration reg(Image& img);
 
+	// Image difference.  The utility compares the current image to
+	// another of the same size, pixel by pixel, after unpacking both
+	// to RGBA in [0,1].  It counts the pixels at which any component
+	// differs by more than the threshold, and notes the largest
+	// absolute error in each channel.  If a mask image is supplied,
+	// it's replaced by a GL_LUMINANCE, GL_UNSIGNED_BYTE image that's
+	// 255 where the pixels differ and 0 elsewhere.
+
+	struct Difference {
+		GLsizei pixels;		// pixels exceeding the threshold
+		double maxError[4];	// largest absolute error in
+					// R, G, B, and A
+	};
+	Difference diff(Image& img, double threshold = 0.0, Image* mask = 0);
+
+	// Image comparison metrics.  compare() measures how the current
+	// image differs from another of the same size, again after
+	// unpacking both to RGBA in [0,1], in ways that tell a little
+	// noise everywhere from one badly wrong primitive:
+	//
+	// A pixel differs if the largest absolute difference between its
+	// components exceeds the tolerance.  If a tolerance mask (an image
+	// of the same size) is supplied, the tolerance varies from pixel
+	// to pixel:  it's the first component of the mask pixel.  (So with
+	// an 8-bit mask, 0 demands an exact match and 255 accepts any.)
+	// Differing pixels that touch, even diagonally, are gathered into
+	// regions.
+	//
+	// The error histogram counts pixels by their largest component
+	// error, in steps of 1/255 (one 8-bit LSB); errors beyond 1 (in
+	// floating-point images) go in the last bin.  PSNR is computed
+	// from the mean squared error of the components the images have,
+	// and SSIM from their luminance, in 8x8 windows (weighted by the
+	// number of pixels they cover, for the partial ones at the edges).
+
+	struct Region {			// Connected region of differing pixels
+		GLsizei pixels;		// number of differing pixels
+		GLsizei x, y;		// lower left corner of bounding box
+		GLsizei width, height;	// size of bounding box
+	};
+	struct Comparison {
+		GLsizei pixels;		// pixels exceeding the tolerance
+		double psnr;		// peak signal-to-noise ratio, in dB;
+					// infinite if the images match
+		double ssim;		// mean structural similarity; 1 if
+					// the images match
+		std::vector<GLsizei> histogram;
+					// pixel counts by error, 256 bins
+		std::vector<Region> regions;
+					// largest first
+	};
+	Comparison compare(Image& img, double tolerance = 0.0,
+		Image* toleranceMask = 0);
+
         // test if images are identical
         bool operator==(const Image &ref) const;
 
 	// Image arithmetic
 	// XXX type and format conversions, with appropriate scaling.
-	// XXX image difference
 	// XXX minmax, histogram, contrast stretch?
 
-	// TIFF I/O utilities:
+	// TIFF I/O utilities.  readTIFF() handles strip- or tile-oriented
+	// files with any compression libtiff supports.  writeTIFF() uses
+	// the compression and layout set by setTIFFCompression() and
+	// setTIFFTileSize(); by default, LZW-compressed strips.
+
+	enum TIFFCompression {
+		tiffNone,
+		tiffLZW,
+		tiffDeflate		// Only if libtiff has zlib
+	};
+	static bool setTIFFCompression(TIFFCompression c);
+					// False if libtiff lacks the codec
+	static TIFFCompression getTIFFCompression();
+	static void setTIFFTileSize(GLsizei size);
+					// Square tiles of the given size
+					// (rounded up to a multiple of 16),
+					// or 0 for strips
 
 	void readTIFF(const char* filename);
 	inline void readTIFF(const std::string& s)  { readTIFF(s.c_str()); }
+
+	// mapTIFF() is readTIFF() for images that are only going to be
+	// examined.  If the file is uncompressed, in strips, and in native
+	// byte order (as writeTIFF() produces with tiffNone), the image
+	// refers to the pixels in a read-only mapping of the file instead
+	// of copying them.  TIFF stores the rows top to bottom, so row()
+	// and rowStride() must be used to walk them; anything that calls
+	// the non-const pixels() or writableRow() gets a copy in ordinary
+	// memory first.  Other files, and other platforms, are simply read.
+	void mapTIFF(const char* filename);
+	inline void mapTIFF(const std::string& s)  { mapTIFF(s.c_str()); }
 	void writeTIFF(const char* filename);
 	inline void writeTIFF(const std::string& s)  { writeTIFF(s.c_str()); }
 
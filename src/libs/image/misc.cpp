@@ -32,7 +32,11 @@
 // Implementation of image data, attribute, and I/O
 
 #include "image.h"
+#include "packed.h"
+#include "pool.h"
 #include <string.h>
+#include <algorithm>
+#include <vector>
 
 namespace GLEAN {
 
@@ -45,9 +49,12 @@ Image::Image() {
 	_format = GL_RGB;
 	_type = GL_UNSIGNED_BYTE;
 	_pixels = 0;
+	_mapping = 0;
+	_mappingSize = 0;
 	_alignment = 4;
 	_packer = 0;
 	_unpacker = 0;
+	_floatUnpacker = 0;
 	_invalid = vbAll;
 } // Image::Image
 
@@ -58,9 +65,12 @@ Image::Image(int aWidth, int aHeight, GLenum aFormat, GLenum aType) {
 	_format = aFormat;
 	_type = aType;
 	_pixels = 0;
+	_mapping = 0;
+	_mappingSize = 0;
 	_alignment = 4;
 	_packer = 0;
 	_unpacker = 0;
+	_floatUnpacker = 0;
 	_invalid = vbAll;
 	reserve();
 } // Image::Image(aWidth, aHeight, aFormat, aType)
@@ -73,15 +83,18 @@ Image::Image(int aWidth, int aHeight, GLenum aFormat, GLenum aType,
 	_format = aFormat;
 	_type = aType;
 	_pixels = 0;
+	_mapping = 0;
+	_mappingSize = 0;
 	_alignment = 4;
 	_packer = 0;
 	_unpacker = 0;
+	_floatUnpacker = 0;
 	_invalid = vbAll;
 	reserve();
 	int i;		// VC++ 6 doesn't handle the definition of variables in a 
 				// for-statement properly
 
-	double* solidColor = new double[4 * width()];
+	std::vector<double> solidColor(4 * width() + 4);
 	for (/*int */i = 0; i < 4 * width(); i += 4) {
 		solidColor[i + 0] = r;
 		solidColor[i + 1] = g;
@@ -91,7 +104,7 @@ Image::Image(int aWidth, int aHeight, GLenum aFormat, GLenum aType,
 
 	char* row = pixels();
 	for (/*int */i = 0; i < height(); ++i) {
-		pack(width(), row, solidColor);
+		pack(width(), row, &solidColor[0]);
 		row += rowSizeInBytes();
 	}
 } // Image::Image(aWidth, aHeight, aFormat, aType)
@@ -104,11 +117,15 @@ Image::Image(Image& i) {
 	_type = i.type();
 	_alignment = i.alignment();
 	_pixels = 0;
+	_mapping = 0;
+	_mappingSize = 0;
 	_packer = 0;
 	_unpacker = 0;
+	_floatUnpacker = 0;
 	_invalid = vbAll;
 	reserve();
-	memcpy(pixels(), i.pixels(), height() * rowSizeInBytes());
+	for (GLsizei r = 0; r < height(); ++r)
+		memcpy(writableRow(r), i.row(r), rowSizeInBytes());
 } // Image::Image(Image&)
 
 /*Image::*/Image&
@@ -122,15 +139,61 @@ Image::operator= (Image& i) {
 	alignment(i.alignment());
 	_invalid = vbAll;
 	reserve();
-	memcpy(pixels(), i.pixels(), height() * rowSizeInBytes());
+	for (GLsizei r = 0; r < height(); ++r)
+		memcpy(writableRow(r), i.row(r), rowSizeInBytes());
 	return *this;
 } // Image::operator=
 
+#if defined(GLEAN_IMAGE_MOVE)
+// Move constructor; leaves i empty:
+Image::Image(Image&& i) {
+	_width = _height = 0;
+	_format = GL_RGB;
+	_type = GL_UNSIGNED_BYTE;
+	_pixels = 0;
+	_mapping = 0;
+	_mappingSize = 0;
+	_alignment = 4;
+	_packer = 0;
+	_unpacker = 0;
+	_floatUnpacker = 0;
+	_invalid = vbAll;
+	swap(i);
+} // Image::Image(Image&&)
+
+// Move assignment; i gets our old pixels, and frees them when it goes:
+/*Image::*/Image&
+Image::operator= (Image&& i) {
+	swap(i);
+	return *this;
+} // Image::operator=(Image&&)
+#endif
+
 Image::~Image() {
-	if (_pixels)
-		delete[] _pixels;
+	releasePixels();
 }
 
+///////////////////////////////////////////////////////////////////////////////
+// swap - exchange contents with another image
+///////////////////////////////////////////////////////////////////////////////
+void
+Image::swap(Image& i) {
+	std::swap(_width, i._width);
+	std::swap(_height, i._height);
+	std::swap(_format, i._format);
+	std::swap(_type, i._type);
+	std::swap(_pixels, i._pixels);
+	std::swap(_mapping, i._mapping);
+	std::swap(_mappingSize, i._mappingSize);
+	std::swap(_alignment, i._alignment);
+	std::swap(_rowSizeInBytes, i._rowSizeInBytes);
+	std::swap(_pixelSizeInBytes, i._pixelSizeInBytes);
+	std::swap(_invalid, i._invalid);
+	std::swap(_unpacker, i._unpacker);
+	std::swap(_floatUnpacker, i._floatUnpacker);
+	std::swap(_packer, i._packer);
+} // Image::swap
+
 
 // Test if two images are identical
 bool Image::operator==(const Image &img) const
@@ -147,11 +210,10 @@ bool Image::operator==(const Image &img) const
 	    img1.rowSizeInBytes() != img2.rowSizeInBytes())
 		return false;
 
-	const char *p1 = img1.pixels();
-	const char *p2 = img2.pixels();
-	const int n = img1.rowSizeInBytes() * img1.height();
-	if (memcmp(p1, p2, n) != 0)
-		return false;
+	// Row by row, so that mapped images needn't be copied:
+	for (GLsizei r = 0; r < img1.height(); ++r)
+		if (memcmp(img1.row(r), img2.row(r), img1.rowSizeInBytes()))
+			return false;
 
 	return true;
 }
@@ -162,10 +224,9 @@ bool Image::operator==(const Image &img) const
 ///////////////////////////////////////////////////////////////////////////////
 void
 Image::pixels(char* p) {
-	// We always own our pixels, so delete the old ones (if any) before
+	// We always own our pixels, so release the old ones (if any) before
 	// installing new ones:
-	if (_pixels)
-		delete[] _pixels;
+	releasePixels();
 	_pixels = p;
 } // Image::pixels
 
@@ -174,13 +235,12 @@ Image::pixels(char* p) {
 ///////////////////////////////////////////////////////////////////////////////
 void
 Image::reserve() {
-	pixels(0);	// deallocate old pixel array
+	pixels(0);	// release old pixel array; an array of the same
+			// size will come straight back from the pool
 
 	const int size = height() * rowSizeInBytes();
-	char * const p = new char[size];
-	for (int i = 0; i < size; i++) {
-		p[i] = 0;
-	}
+	char * const p = PixelPool::allocate(size);
+	memset(p, 0, size);
 	pixels(p);
 } // Image::reserve
 
@@ -201,6 +261,13 @@ Image::validateRowSizeInBytes() {
 ///////////////////////////////////////////////////////////////////////////////
 GLsizei
 Image::validatePixelSizeInBytes() {
+	// Packed types hold a whole pixel, whatever the format:
+	_pixelSizeInBytes = Packed::pixelSize(type());
+	if (_pixelSizeInBytes) {
+		validate(vbPixelSizeInBytes);
+		return _pixelSizeInBytes;
+	}
+
 	switch (format()) {
 	case GL_LUMINANCE:
 		_pixelSizeInBytes = 1;
@@ -209,9 +276,12 @@ Image::validatePixelSizeInBytes() {
 		_pixelSizeInBytes = 2;
 		break;
 	case GL_RGB:
+	case GL_BGR:
 		_pixelSizeInBytes = 3;
 		break;
 	case GL_RGBA:
+	case GL_BGRA:
+	case GL_ABGR_EXT:
 		_pixelSizeInBytes = 4;
 		break;
 	default:
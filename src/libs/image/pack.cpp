@@ -33,6 +33,8 @@
 // the usual OpenGL conversions.  Also, see comments in unpack.cpp.
 
 #include "image.h"
+#include "packed.h"
+#include "simd.h"
 
 namespace {
 
@@ -118,11 +120,144 @@ public :
 		}
 	}
 
+	// pack_bgr
+	static void pack_bgr(GLsizei n, char* dst, double* rgba) 
+	{
+		component* out = reinterpret_cast<component*>(dst);
+		double* end = rgba + 4 * n;
+		for (; rgba != end; rgba += 4) {
+			if (bias) {
+				out[0] = static_cast<component>(SCALE * rgba[2] - BIAS);
+				out[1] = static_cast<component>(SCALE * rgba[1] - BIAS);
+				out[2] = static_cast<component>(SCALE * rgba[0] - BIAS);
+			} else {
+				out[0] = static_cast<component>(SCALE * rgba[2]);
+				out[1] = static_cast<component>(SCALE * rgba[1]);
+				out[2] = static_cast<component>(SCALE * rgba[0]);
+			}
+			out += 3;
+		}
+	}
+
+	// pack_bgra
+	static void pack_bgra(GLsizei n, char* dst, double* rgba) 
+	{
+		component* out = reinterpret_cast<component*>(dst);
+		double* end = rgba + 4 * n;
+		for (; rgba != end; rgba += 4) {
+			if (bias) {
+				out[0] = static_cast<component>(SCALE * rgba[2] - BIAS);
+				out[1] = static_cast<component>(SCALE * rgba[1] - BIAS);
+				out[2] = static_cast<component>(SCALE * rgba[0] - BIAS);
+				out[3] = static_cast<component>(SCALE * rgba[3] - BIAS);
+			} else {
+				out[0] = static_cast<component>(SCALE * rgba[2]);
+				out[1] = static_cast<component>(SCALE * rgba[1]);
+				out[2] = static_cast<component>(SCALE * rgba[0]);
+				out[3] = static_cast<component>(SCALE * rgba[3]);
+			}
+			out += 4;
+		}
+	}
+
+	// pack_abgr
+	static void pack_abgr(GLsizei n, char* dst, double* rgba) 
+	{
+		component* out = reinterpret_cast<component*>(dst);
+		double* end = rgba + 4 * n;
+		for (; rgba != end; rgba += 4) {
+			if (bias) {
+				out[0] = static_cast<component>(SCALE * rgba[3] - BIAS);
+				out[1] = static_cast<component>(SCALE * rgba[2] - BIAS);
+				out[2] = static_cast<component>(SCALE * rgba[1] - BIAS);
+				out[3] = static_cast<component>(SCALE * rgba[0] - BIAS);
+			} else {
+				out[0] = static_cast<component>(SCALE * rgba[3]);
+				out[1] = static_cast<component>(SCALE * rgba[2]);
+				out[2] = static_cast<component>(SCALE * rgba[1]);
+				out[3] = static_cast<component>(SCALE * rgba[0]);
+			}
+			out += 4;
+		}
+	}
+
 };	// class Pack
 
 #undef SCALE
 #undef BIAS
 
+// Packed pixel types (see packed.h).  Unlike the basic types, their
+// components are clamped to [0,1] and rounded to the nearest field
+// value, so that a component out of range can't spill into its
+// neighbors, and so that unpacking and packing again gives back the
+// same fields.
+
+inline GLuint
+field(double c, int bits) {
+	GLuint max = (1U << bits) - 1;
+	if (!(c > 0.0))			// Also catches NaN
+		return 0;
+	if (c >= 1.0)
+		return max;
+	return static_cast<GLuint>(c * max + 0.5);
+}
+
+// Pack a packed type, with component i (in format order) coming from
+// channel ci:
+
+template<class L, int c0, int c1, int c2, int c3>
+class PackPacked
+{
+public :
+	static void pack(GLsizei n, char* dst, double* rgba) 
+	{
+		typename L::Word* out =
+			reinterpret_cast<typename L::Word*>(dst);
+		double* end = rgba + 4 * n;
+		for (; rgba != end; rgba += 4) {
+			GLuint w = (field(rgba[c0], L::bits0) << L::shift0)
+				 | (field(rgba[c1], L::bits1) << L::shift1)
+				 | (field(rgba[c2], L::bits2) << L::shift2);
+			if (L::components == 4)
+				w |= field(rgba[c3], L::bits3) << L::shift3;
+			*out++ = static_cast<typename L::Word>(w);
+		}
+	}
+};	// class PackPacked
+
+// Select the packer for a packed type's layout and a format with the
+// right number of components:
+
+class PackedPackers
+{
+public :
+	typedef void Packer(GLsizei n, char* nextPixel, double* rgba);
+
+	GLenum format;
+	Packer* packer;
+
+	PackedPackers(GLenum f): format(f), packer(0) { }
+
+	template<class L> void visit()
+	{
+		if (L::components == 3) {
+			if (format == GL_RGB)
+				packer = PackPacked<L, 0, 1, 2, 3>::pack;
+			else if (format == GL_BGR)
+				packer = PackPacked<L, 2, 1, 0, 3>::pack;
+		} else {
+			if (format == GL_RGBA)
+				packer = PackPacked<L, 0, 1, 2, 3>::pack;
+			else if (format == GL_BGRA)
+				packer = PackPacked<L, 2, 1, 0, 3>::pack;
+			else if (format == GL_ABGR_EXT)
+				packer = PackPacked<L, 3, 2, 1, 0>::pack;
+		}
+		if (!packer)
+			throw GLEAN::Image::BadFormat(format);
+	}
+};	// class PackedPackers
+
 }; // anonymous namespace
 
 
@@ -142,6 +277,19 @@ Image::pack(GLsizei n, char* nextPixel, double* rgba) {
 
 Image::Packer*
 Image::validatePacker() {
+	_packer = SIMD::packer(format(), type());
+	if (_packer) {
+		validate(vbPacker);
+		return _packer;
+	}
+
+	PackedPackers packed(format());
+	if (Packed::forType(type(), packed)) {
+		_packer = packed.packer;
+		validate(vbPacker);
+		return _packer;
+	}
+
 	switch (format()) {
 	case GL_LUMINANCE:
 		switch (type()) {
@@ -251,6 +399,87 @@ Image::validatePacker() {
 			throw BadType(type());
 		}
 		break;
+	case GL_BGR:
+		switch (type()) {
+		case GL_BYTE:
+			_packer = Pack<GLbyte, 255, 2, 1>::pack_bgr;
+			break;
+		case GL_UNSIGNED_BYTE:
+			_packer = Pack<GLubyte, 255, 1, 0>::pack_bgr;
+			break;
+		case GL_SHORT:
+			_packer = Pack<GLshort, 65535, 2, 1>::pack_bgr;
+			break;
+		case GL_UNSIGNED_SHORT:
+			_packer = Pack<GLushort, 65535, 1, 0>::pack_bgr;
+			break;
+		case GL_INT:
+			_packer = Pack<GLint, 4294967295U, 2, 1>::pack_bgr;
+			break;
+		case GL_UNSIGNED_INT:
+			_packer = Pack<GLuint, 4294967295U, 1, 0>::pack_bgr;
+			break;
+		case GL_FLOAT:
+			_packer = Pack<GLfloat, 1, 1, 0>::pack_bgr;
+			break;
+		default:
+			throw BadType(type());
+		}
+		break;
+	case GL_BGRA:
+		switch (type()) {
+		case GL_BYTE:
+			_packer = Pack<GLbyte, 255, 2, 1>::pack_bgra;
+			break;
+		case GL_UNSIGNED_BYTE:
+			_packer = Pack<GLubyte, 255, 1, 0>::pack_bgra;
+			break;
+		case GL_SHORT:
+			_packer = Pack<GLshort, 65535, 2, 1>::pack_bgra;
+			break;
+		case GL_UNSIGNED_SHORT:
+			_packer = Pack<GLushort, 65535, 1, 0>::pack_bgra;
+			break;
+		case GL_INT:
+			_packer = Pack<GLint, 4294967295U, 2, 1>::pack_bgra;
+			break;
+		case GL_UNSIGNED_INT:
+			_packer = Pack<GLuint, 4294967295U, 1, 0>::pack_bgra;
+			break;
+		case GL_FLOAT:
+			_packer = Pack<GLfloat, 1, 1, 0>::pack_bgra;
+			break;
+		default:
+			throw BadType(type());
+		}
+		break;
+	case GL_ABGR_EXT:
+		switch (type()) {
+		case GL_BYTE:
+			_packer = Pack<GLbyte, 255, 2, 1>::pack_abgr;
+			break;
+		case GL_UNSIGNED_BYTE:
+			_packer = Pack<GLubyte, 255, 1, 0>::pack_abgr;
+			break;
+		case GL_SHORT:
+			_packer = Pack<GLshort, 65535, 2, 1>::pack_abgr;
+			break;
+		case GL_UNSIGNED_SHORT:
+			_packer = Pack<GLushort, 65535, 1, 0>::pack_abgr;
+			break;
+		case GL_INT:
+			_packer = Pack<GLint, 4294967295U, 2, 1>::pack_abgr;
+			break;
+		case GL_UNSIGNED_INT:
+			_packer = Pack<GLuint, 4294967295U, 1, 0>::pack_abgr;
+			break;
+		case GL_FLOAT:
+			_packer = Pack<GLfloat, 1, 1, 0>::pack_abgr;
+			break;
+		default:
+			throw BadType(type());
+		}
+		break;
 	default:
 		throw BadFormat(format());
 	}
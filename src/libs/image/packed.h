@@ -0,0 +1,147 @@
+// BEGIN_COPYRIGHT
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+
+
+// packed.h:  field layouts of the packed pixel types
+// (private to the image library)
+
+// A packed type (GL_UNSIGNED_SHORT_5_6_5 and the like) holds a whole
+// pixel in one byte, short, or int.  Components are numbered in the
+// order the format names them (R, G, B, A for GL_RGBA; B, G, R, A for
+// GL_BGRA; A, B, G, R for GL_ABGR_EXT).  In the plain types the first
+// component is in the most significant bits of the word; in the _REV
+// types, in the least significant.  Three-component types (which go
+// with GL_RGB or GL_BGR) have no fourth field.
+//
+// forType() calls the visitor's visit<Layout>() for a packed type's
+// layout and returns true, or returns false for any other type, so the
+// packing and unpacking code can select among templates instantiated
+// for every layout without repeating the list.
+
+
+#ifndef __packed_h__
+#define __packed_h__
+
+#include "glwrap.h"
+
+namespace GLEAN {
+
+namespace Packed {
+
+template<class w, int b0, int b1, int b2, int b3, bool rev>
+struct Layout {
+	typedef w Word;
+	enum {
+		components = b3? 4: 3,
+		bits0 = b0,
+		bits1 = b1,
+		bits2 = b2,
+		bits3 = b3,
+		size = 8 * sizeof(w),
+		shift0 = rev? 0: size - b0,
+		shift1 = rev? b0: size - b0 - b1,
+		shift2 = rev? b0 + b1: size - b0 - b1 - b2,
+		shift3 = rev? b0 + b1 + b2: 0
+	};
+};
+
+template<class Visitor>
+bool
+forType(GLenum type, Visitor& v) {
+	switch (type) {
+	case GL_UNSIGNED_BYTE_3_3_2:
+		v.template visit<Layout<GLubyte, 3, 3, 2, 0, false> >();
+		return true;
+	case GL_UNSIGNED_BYTE_2_3_3_REV:
+		v.template visit<Layout<GLubyte, 3, 3, 2, 0, true> >();
+		return true;
+	case GL_UNSIGNED_SHORT_5_6_5:
+		v.template visit<Layout<GLushort, 5, 6, 5, 0, false> >();
+		return true;
+	case GL_UNSIGNED_SHORT_5_6_5_REV:
+		v.template visit<Layout<GLushort, 5, 6, 5, 0, true> >();
+		return true;
+	case GL_UNSIGNED_SHORT_4_4_4_4:
+		v.template visit<Layout<GLushort, 4, 4, 4, 4, false> >();
+		return true;
+	case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+		v.template visit<Layout<GLushort, 4, 4, 4, 4, true> >();
+		return true;
+	case GL_UNSIGNED_SHORT_5_5_5_1:
+		v.template visit<Layout<GLushort, 5, 5, 5, 1, false> >();
+		return true;
+	case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+		v.template visit<Layout<GLushort, 5, 5, 5, 1, true> >();
+		return true;
+	case GL_UNSIGNED_INT_8_8_8_8:
+		v.template visit<Layout<GLuint, 8, 8, 8, 8, false> >();
+		return true;
+	case GL_UNSIGNED_INT_8_8_8_8_REV:
+		v.template visit<Layout<GLuint, 8, 8, 8, 8, true> >();
+		return true;
+	case GL_UNSIGNED_INT_10_10_10_2:
+		v.template visit<Layout<GLuint, 10, 10, 10, 2, false> >();
+		return true;
+	case GL_UNSIGNED_INT_2_10_10_10_REV:
+		v.template visit<Layout<GLuint, 10, 10, 10, 2, true> >();
+		return true;
+	default:
+		return false;
+	}
+}
+
+// Size in bytes of a packed type's pixels, or 0 for other types:
+inline GLsizei
+pixelSize(GLenum type) {
+	switch (type) {
+	case GL_UNSIGNED_BYTE_3_3_2:
+	case GL_UNSIGNED_BYTE_2_3_3_REV:
+		return 1;
+	case GL_UNSIGNED_SHORT_5_6_5:
+	case GL_UNSIGNED_SHORT_5_6_5_REV:
+	case GL_UNSIGNED_SHORT_4_4_4_4:
+	case GL_UNSIGNED_SHORT_4_4_4_4_REV:
+	case GL_UNSIGNED_SHORT_5_5_5_1:
+	case GL_UNSIGNED_SHORT_1_5_5_5_REV:
+		return 2;
+	case GL_UNSIGNED_INT_8_8_8_8:
+	case GL_UNSIGNED_INT_8_8_8_8_REV:
+	case GL_UNSIGNED_INT_10_10_10_2:
+	case GL_UNSIGNED_INT_2_10_10_10_REV:
+		return 4;
+	default:
+		return 0;
+	}
+}
+
+} // namespace Packed
+
+} // namespace GLEAN
+
+#endif // __packed_h__
@@ -0,0 +1,170 @@
+// BEGIN_COPYRIGHT
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+
+
+// pool.cpp:  pooled, aligned storage for image pixels
+
+#include "pool.h"
+#include <cstdlib>
+#include <new>
+
+#if defined(__UNIX__)
+#include <pthread.h>
+#endif
+
+namespace GLEAN {
+
+namespace PixelPool {
+
+namespace {
+
+const size_t alignment = 64;		// Alignment of every array
+const size_t smallest = 64;		// Size of size class 0
+const int nClasses = 26;		// Largest class is 2 GB
+const size_t maxCached = 64 << 20;	// Most free memory kept for reuse
+
+// Each array is preceded by the bookkeeping for its block:
+struct Block {
+	void* raw;		// What malloc() returned
+	Block* next;		// Next free block of the same class
+	int sizeClass;		// Or -1 if too large to pool
+};
+
+struct Pool {
+	Block* freeLists[nClasses];
+	size_t cached;		// Total size of the free blocks
+#if defined(__UNIX__)
+	pthread_mutex_t mutex;
+#endif
+
+	Pool(): cached(0) {
+		for (int i = 0; i < nClasses; ++i)
+			freeLists[i] = 0;
+#if defined(__UNIX__)
+		pthread_mutex_init(&mutex, 0);
+#endif
+	}
+	void lock() {
+#if defined(__UNIX__)
+		pthread_mutex_lock(&mutex);
+#endif
+	}
+	void unlock() {
+#if defined(__UNIX__)
+		pthread_mutex_unlock(&mutex);
+#endif
+	}
+};
+
+// The pool is never destroyed, because static Images (and there are
+// some) may release their pixels after it would have been:
+Pool&
+pool() {
+	static Pool* p = new Pool;
+	return *p;
+}
+
+inline size_t
+classSize(int c) {
+	return smallest << c;
+}
+
+inline Block*
+blockOf(char* p) {
+	return reinterpret_cast<Block*>(p) - 1;
+}
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// allocate:  get an array from the pool, or from the heap if the pool has
+//	none of the right size
+///////////////////////////////////////////////////////////////////////////////
+char*
+allocate(size_t bytes) {
+	int c = 0;
+	while (c < nClasses && classSize(c) < bytes)
+		++c;
+
+	if (c < nClasses) {
+		Pool& p = pool();
+		p.lock();
+		Block* b = p.freeLists[c];
+		if (b) {
+			p.freeLists[c] = b->next;
+			p.cached -= classSize(c);
+		}
+		p.unlock();
+		if (b)
+			return reinterpret_cast<char*>(b + 1);
+	}
+
+	size_t size = (c < nClasses)? classSize(c): bytes;
+	void* raw = malloc(size + sizeof(Block) + alignment - 1);
+	if (!raw)
+		throw std::bad_alloc();
+	size_t start = reinterpret_cast<size_t>(raw) + sizeof(Block);
+	start = (start + alignment - 1) & ~(alignment - 1);
+	char* array = reinterpret_cast<char*>(start);
+	Block* b = blockOf(array);
+	b->raw = raw;
+	b->next = 0;
+	b->sizeClass = (c < nClasses)? c: -1;
+	return array;
+} // allocate
+
+///////////////////////////////////////////////////////////////////////////////
+// release:  return an array to the pool, or to the heap if the pool is
+//	full
+///////////////////////////////////////////////////////////////////////////////
+void
+release(char* array) {
+	if (!array)
+		return;
+	Block* b = blockOf(array);
+	if (b->sizeClass >= 0) {
+		Pool& p = pool();
+		bool kept = false;
+		p.lock();
+		if (p.cached + classSize(b->sizeClass) <= maxCached) {
+			b->next = p.freeLists[b->sizeClass];
+			p.freeLists[b->sizeClass] = b;
+			p.cached += classSize(b->sizeClass);
+			kept = true;
+		}
+		p.unlock();
+		if (kept)
+			return;
+	}
+	free(b->raw);
+} // release
+
+} // namespace PixelPool
+
+} // namespace GLEAN
@@ -0,0 +1,65 @@
+// BEGIN_COPYRIGHT
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+
+
+// pool.h:  pooled, aligned storage for image pixels
+
+// Tests create and destroy images of the same few sizes over and over,
+// so pixel arrays are recycled rather than returned to the heap.  Each
+// array starts on a 64-byte boundary (a cache line, and the widest
+// vector the pack/unpack code uses).
+//
+// Arrays are kept on free lists by size class (powers of two), up to a
+// fixed total; beyond that, released arrays go back to the heap.  On
+// __UNIX__ systems, where glean runs tests in threads, the pool is
+// protected by a mutex.
+
+
+#ifndef __pool_h__
+#define __pool_h__
+
+#include <cstddef>
+
+namespace GLEAN {
+
+namespace PixelPool {
+
+// Allocate an array of at least the given size; throws std::bad_alloc
+// if there's no memory.  The contents are undefined.
+char* allocate(size_t bytes);
+
+// Return an array obtained from allocate() to the pool.  Null is
+// ignored.
+void release(char* p);
+
+} // namespace PixelPool
+
+} // namespace GLEAN
+
+#endif // __pool_h__
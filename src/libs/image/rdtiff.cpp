@@ -30,57 +30,62 @@
 
 
 #include "image.h"
+#include "pool.h"
 #include "tiffio.h"
+#include <string.h>
+#include <vector>
+
+#if defined(__UNIX__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
 
 namespace GLEAN {
 
+namespace {
+
 ///////////////////////////////////////////////////////////////////////////////
-// readTIFF - read image from TIFF file, set attributes to match the file
+// setAttributes - set an image's size, format, type, and alignment to match
+//	an open TIFF file.  Closes the file and throws UnsupportedTIFF if the
+//	image is one we can't handle.
 ///////////////////////////////////////////////////////////////////////////////
 void
-Image::readTIFF(const char* filename) {
-	// XXX Things we explicitly don't handle:
-	//	Varying number of bits per sample.  Sam's library doesn't
-	//		handle that.
-	//	Bits per sample other than 8, 16, or 32.
-	//	Tile-oriented TIFF files.  We only do strip-oriented files.
-	//	Planar configurations other than contiguous (R,G,B,R,G,B,...).
-	//	Premultiplied alpha.  If there's a fourth color channel,
-	//		we just assume it's non-premultiplied alpha.
-	// Eventually would be good to add a ``validation'' function which
-	// checks a file before attempting to read the image it contains.
-	// Also:  need error-reporting code.
-
-	TIFF* tf = TIFFOpen(filename, "r");
-	if (!tf)
-		throw CantOpen(filename);
-
+setAttributes(Image& img, TIFF* tf) {
 	uint32 u32;
 
 	TIFFGetFieldDefaulted(tf, TIFFTAG_IMAGELENGTH, &u32);
-	height(u32);
+	img.height(u32);
 
 	TIFFGetFieldDefaulted(tf, TIFFTAG_IMAGEWIDTH, &u32);
-	width(u32);
+	img.width(u32);
 
 	uint16 samplesPerPixel;
 	TIFFGetFieldDefaulted(tf, TIFFTAG_SAMPLESPERPIXEL, &samplesPerPixel);
 	switch (samplesPerPixel) {
 	case 1:
-		format(GL_LUMINANCE);
+		img.format(GL_LUMINANCE);
 		break;
 	case 2:
-		format(GL_LUMINANCE_ALPHA);
+		img.format(GL_LUMINANCE_ALPHA);
 		break;
 	case 3:
-		format(GL_RGB);
+		img.format(GL_RGB);
 		break;
 	case 4:
-		format(GL_RGBA);
+		img.format(GL_RGBA);
 		break;
 	default:
 		TIFFClose(tf);
-		throw UnsupportedTIFF();
+		throw Image::UnsupportedTIFF();
+	}
+
+	uint16 planarConfig;
+	TIFFGetFieldDefaulted(tf, TIFFTAG_PLANARCONFIG, &planarConfig);
+	if (samplesPerPixel > 1 && planarConfig != PLANARCONFIG_CONTIG) {
+		TIFFClose(tf);
+		throw Image::UnsupportedTIFF();
 	}
 
 	uint16 bitsPerSample;
@@ -90,67 +95,246 @@ Image::readTIFF(const char* filename) {
 		sampleFormat = SAMPLEFORMAT_UINT;
 	switch ((sampleFormat << 8) | bitsPerSample) {
 	case (SAMPLEFORMAT_UINT << 8) | 8:
-		type(GL_UNSIGNED_BYTE);
+		img.type(GL_UNSIGNED_BYTE);
 		break;
 	case (SAMPLEFORMAT_UINT << 8) | 16:
-		type(GL_UNSIGNED_SHORT);
+		img.type(GL_UNSIGNED_SHORT);
 		break;
 	case (SAMPLEFORMAT_UINT << 8) | 32:
-		type(GL_UNSIGNED_INT);
+		img.type(GL_UNSIGNED_INT);
 		break;
 	case (SAMPLEFORMAT_INT << 8) | 8:
-		type(GL_BYTE);
+		img.type(GL_BYTE);
 		break;
 	case (SAMPLEFORMAT_INT << 8) | 16:
-		type(GL_SHORT);
+		img.type(GL_SHORT);
 		break;
 	case (SAMPLEFORMAT_INT << 8) | 32:
-		type(GL_INT);
+		img.type(GL_INT);
 		break;
 	case (SAMPLEFORMAT_IEEEFP << 8) | 32:
-		type(GL_FLOAT);
+		img.type(GL_FLOAT);
 		break;
 	default:
 		TIFFClose(tf);
-		throw UnsupportedTIFF();
+		throw Image::UnsupportedTIFF();
 	}
 
 	// At the moment it's not obvious whether we should pad
 	// scanlines to achieve a preferred alignment, so we'll just
 	// return an alignment that matches the data.
-	alignment(1);
-	switch (rowSizeInBytes() & 0x7) {
+	img.alignment(1);
+	switch (img.rowSizeInBytes() & 0x7) {
 	case 0:
-		alignment(8);
+		img.alignment(8);
 		break;
 	case 4:
-		alignment(4);
+		img.alignment(4);
 		break;
 	case 2:
 	case 6:
-		alignment(2);
+		img.alignment(2);
 		break;
 	case 1:
 	case 3:
 	case 5:
 	case 7:
-		alignment(1);
+		img.alignment(1);
 		break;
 	}
+} // setAttributes
+
+///////////////////////////////////////////////////////////////////////////////
+// pixelOffset - if an open TIFF file's pixels can be used where they lie,
+//	store the file offset of its top row in offset and return true.
+//	That takes uncompressed strips, in native byte order, stored one
+//	after the other with nothing in between.
+///////////////////////////////////////////////////////////////////////////////
+bool
+pixelOffset(Image& img, TIFF* tf, toff_t& offset) {
+	uint16 compression;
+	TIFFGetFieldDefaulted(tf, TIFFTAG_COMPRESSION, &compression);
+	if (compression != COMPRESSION_NONE || TIFFIsTiled(tf)
+	 || TIFFIsByteSwapped(tf) || img.width() == 0 || img.height() == 0)
+		return false;
+
+	uint32 rowsPerStrip;
+	TIFFGetFieldDefaulted(tf, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip);
+	if (rowsPerStrip > static_cast<uint32>(img.height()))
+		rowsPerStrip = img.height();
+	toff_t* offsets;
+	toff_t* byteCounts;
+	if (!TIFFGetField(tf, TIFFTAG_STRIPOFFSETS, &offsets)
+	 || !TIFFGetField(tf, TIFFTAG_STRIPBYTECOUNTS, &byteCounts))
+		return false;
+
+	toff_t stripBytes = rowsPerStrip * img.rowSizeInBytes();
+	toff_t remaining = img.height() * img.rowSizeInBytes();
+	tstrip_t strips = TIFFNumberOfStrips(tf);
+	for (tstrip_t i = 0; i < strips && remaining > 0; ++i) {
+		toff_t expected = (remaining < stripBytes)?
+			remaining: stripBytes;
+		if (offsets[i] != offsets[0] + i * stripBytes
+		 || byteCounts[i] < expected)
+			return false;
+		remaining -= expected;
+	}
+	if (remaining > 0)
+		return false;
+
+	offset = offsets[0];
+	return true;
+} // pixelOffset
+
+} // anonymous namespace
+
+///////////////////////////////////////////////////////////////////////////////
+// readTIFF - read image from TIFF file, set attributes to match the file
+///////////////////////////////////////////////////////////////////////////////
+void
+Image::readTIFF(const char* filename) {
+	// XXX Things we explicitly don't handle:
+	//	Varying number of bits per sample.  Sam's library doesn't
+	//		handle that.
+	//	Bits per sample other than 8, 16, or 32.
+	//	Planar configurations other than contiguous (R,G,B,R,G,B,...).
+	//	Premultiplied alpha.  If there's a fourth color channel,
+	//		we just assume it's non-premultiplied alpha.
+	// Eventually would be good to add a ``validation'' function which
+	// checks a file before attempting to read the image it contains.
+	// Also:  need error-reporting code.
+
+	TIFF* tf = TIFFOpen(filename, "r");
+	if (!tf)
+		throw CantOpen(filename);
+
+	setAttributes(*this, tf);
 
 	reserve();
 
-	{
-		// Store rows in reverse order, so that the default TIFF
-		// orientation won't result in an upside-down image for
-		// OpenGL:
-		GLsizei rowStep = rowSizeInBytes();
-		char* row = pixels() + (height() - 1) * rowStep;
-		for (GLsizei r = 0; r < height(); ++r, row -= rowStep)
-			TIFFReadScanline(tf, row, r);
+	// Store rows in reverse order, so that the default TIFF orientation
+	// won't result in an upside-down image for OpenGL.  Whole strips or
+	// tiles are decoded at once, and their rows copied into place.
+	GLsizei rowStep = rowSizeInBytes();
+	GLsizei pixelSize = pixelSizeInBytes();
+	GLsizei rowBytes = width() * pixelSize;
+	char* lastRow = pixels() + (height() - 1) * rowStep;
+	if (TIFFIsTiled(tf)) {
+		uint32 tileWidth;
+		uint32 tileLength;
+		TIFFGetField(tf, TIFFTAG_TILEWIDTH, &tileWidth);
+		TIFFGetField(tf, TIFFTAG_TILELENGTH, &tileLength);
+		GLsizei tileRowBytes = tileWidth * pixelSize;
+		std::vector<char> tile(TIFFTileSize(tf) + 1);
+		for (GLsizei y = 0; y < height(); y += tileLength)
+			for (GLsizei x = 0; x < width(); x += tileWidth) {
+				TIFFReadEncodedTile(tf,
+					TIFFComputeTile(tf, x, y, 0, 0),
+					&tile[0], -1);
+				GLsizei rows = height() - y;
+				if (rows > static_cast<GLsizei>(tileLength))
+					rows = tileLength;
+				GLsizei cols = width() - x;
+				if (cols > static_cast<GLsizei>(tileWidth))
+					cols = tileWidth;
+				for (GLsizei r = 0; r < rows; ++r)
+					memcpy(lastRow - (y + r) * rowStep
+							+ x * pixelSize,
+						&tile[r * tileRowBytes],
+						cols * pixelSize);
+			}
+	} else {
+		uint32 rowsPerStrip;
+		TIFFGetFieldDefaulted(tf, TIFFTAG_ROWSPERSTRIP, &rowsPerStrip);
+		GLsizei stripRows = height();
+		if (rowsPerStrip < static_cast<uint32>(stripRows))
+			stripRows = rowsPerStrip;
+		if (stripRows < 1)
+			stripRows = 1;
+		std::vector<char> strip(stripRows * rowBytes + 1);
+		for (GLsizei y = 0; y < height(); y += stripRows) {
+			GLsizei n = height() - y;
+			if (n > stripRows)
+				n = stripRows;
+			TIFFReadEncodedStrip(tf, TIFFComputeStrip(tf, y, 0),
+				&strip[0], n * rowBytes);
+			for (GLsizei r = 0; r < n; ++r)
+				memcpy(lastRow - (y + r) * rowStep,
+					&strip[r * rowBytes], rowBytes);
+		}
 	}
 
 	TIFFClose(tf);
 } // Image::readTIFF
 
+///////////////////////////////////////////////////////////////////////////////
+// mapTIFF - like readTIFF, but refer to the pixels in the file if possible
+///////////////////////////////////////////////////////////////////////////////
+void
+Image::mapTIFF(const char* filename) {
+#if defined(__UNIX__)
+	TIFF* tf = TIFFOpen(filename, "r");
+	if (!tf)
+		throw CantOpen(filename);
+	setAttributes(*this, tf);
+	toff_t offset = 0;
+	bool usable = pixelOffset(*this, tf, offset);
+	TIFFClose(tf);
+
+	if (usable) {
+		int fd = open(filename, O_RDONLY);
+		struct stat st;
+		void* base = MAP_FAILED;
+		size_t end = offset + height() * rowSizeInBytes();
+		if (fd >= 0 && fstat(fd, &st) == 0
+		 && static_cast<size_t>(st.st_size) >= end)
+			base = mmap(0, st.st_size, PROT_READ, MAP_PRIVATE,
+				fd, 0);
+		if (fd >= 0)
+			close(fd);
+		if (base != MAP_FAILED) {
+			releasePixels();
+			_mapping = base;
+			_mappingSize = st.st_size;
+			// Row 0 is the last one in the file:
+			_pixels = static_cast<char*>(base) + end
+				- rowSizeInBytes();
+			return;
+		}
+	}
+#endif
+
+	// Not mappable; read it the ordinary way:
+	readTIFF(filename);
+} // Image::mapTIFF
+
+///////////////////////////////////////////////////////////////////////////////
+// releasePixels - free or unmap the pixel array
+///////////////////////////////////////////////////////////////////////////////
+void
+Image::releasePixels() {
+	if (_mapping) {
+#if defined(__UNIX__)
+		munmap(_mapping, _mappingSize);
+#endif
+		_mapping = 0;
+		_mappingSize = 0;
+	} else
+		PixelPool::release(_pixels);
+	_pixels = 0;
+} // Image::releasePixels
+
+///////////////////////////////////////////////////////////////////////////////
+// unmap - copy a mapped image's pixels into memory, in the usual order
+///////////////////////////////////////////////////////////////////////////////
+void
+Image::unmap() {
+	GLsizei size = height() * rowSizeInBytes();
+	char* p = PixelPool::allocate(size);
+	for (GLsizei r = 0; r < height(); ++r)
+		memcpy(p + r * rowSizeInBytes(), row(r), rowSizeInBytes());
+	releasePixels();
+	_pixels = p;
+} // Image::unmap
+
 }; // namespace GLEAN
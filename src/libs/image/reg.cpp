@@ -32,13 +32,308 @@
 // Image registration.
 
 #include <cfloat>
+#include <vector>
+#include <string.h>
 #include "image.h"
+#include "simd.h"
 
 #include <cmath>	// for fabs
 
+#if defined(__UNIX__)
+#include <pthread.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+
 
 namespace GLEAN {
 
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+// expand:  copy n pixels of an image with integer components into RGBA
+//	components of the same type, filling in the missing components with
+//	zero just as Image::unpack() does.  Returns false if the format
+//	isn't one that unpack() handles.
+///////////////////////////////////////////////////////////////////////////////
+template<class component>
+bool
+expand(GLenum format, GLsizei n, component* rgba, const char* nextPixel) {
+	const component* p = reinterpret_cast<const component*>(nextPixel);
+	switch (format) {
+	case GL_LUMINANCE:
+		for (; n > 0; --n, rgba += 4, p += 1) {
+			rgba[0] = p[0];
+			rgba[1] = rgba[2] = rgba[3] = 0;
+		}
+		return true;
+	case GL_LUMINANCE_ALPHA:
+		for (; n > 0; --n, rgba += 4, p += 2) {
+			rgba[0] = p[0];
+			rgba[1] = rgba[2] = 0;
+			rgba[3] = p[1];
+		}
+		return true;
+	case GL_RGB:
+		for (; n > 0; --n, rgba += 4, p += 3) {
+			rgba[0] = p[0];
+			rgba[1] = p[1];
+			rgba[2] = p[2];
+			rgba[3] = 0;
+		}
+		return true;
+	case GL_RGBA:
+		memcpy(rgba, p, 4 * n * sizeof(component));
+		return true;
+	default:
+		return false;
+	}
+} // expand
+
+///////////////////////////////////////////////////////////////////////////////
+// Position:  a candidate offset of the reference image within the test
+//	image, and the error found there.  Positions are ranked by error;
+//	ties go to the one a serial search would have reached first (the
+//	lower row, then the lower column), so searches that divide the work
+//	among threads pick the same position as a serial search.
+///////////////////////////////////////////////////////////////////////////////
+struct Position {
+	double error;
+	int hOffset;
+	int wOffset;
+
+	Position(): error(DBL_MAX), hOffset(0), wOffset(0) { }
+
+	bool operator<(const Position& p) const {
+		if (error != p.error)
+			return error < p.error;
+		if (hOffset != p.hOffset)
+			return hOffset < p.hOffset;
+		return wOffset < p.wOffset;
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// IntegerSearch:  find the offset of the reference image within the test
+//	image that minimizes the sum of absolute differences of the raw
+//	8- or 16-bit components.  Both images have the same component type,
+//	so they're unpacked with the same scale factor, and the offset with
+//	the smallest integer sum is the one with the smallest sum of mean
+//	absolute errors.  The sums are exact, so no rounding can change
+//	the outcome.
+//
+//	An offset is abandoned as soon as its partial sum reaches the best
+//	complete sum found so far; for images that register well, that
+//	happens within the first few rows at nearly every offset.
+///////////////////////////////////////////////////////////////////////////////
+template<class component>
+class IntegerSearch {
+public:
+	// Copy both images; returns false if either has a format that
+	// expand() doesn't handle.
+	bool load(Image& test, Image& ref);
+
+	// Search rows first, first + step, first + 2 * step, ... of
+	// candidate offsets, improving on best.
+	void search(int first, int step, Position& best) const;
+
+private:
+	vector<component> testPix;
+	vector<component> refPix;
+	int wt4;		// Width of test image, in RGBA samples.
+	int wr4;		// Width of ref image, in RGBA samples.
+	int dh;			// Difference in heights, in pixels.
+	int hr;			// Height of ref image, in pixels.
+};
+
+template<class component>
+bool
+IntegerSearch<component>::load(Image& test, Image& ref) {
+	wt4 = 4 * test.width();
+	wr4 = 4 * ref.width();
+	dh = test.height() - ref.height();
+	hr = ref.height();
+
+	testPix.resize(wt4 * test.height() + 1);
+	refPix.resize(wr4 * hr + 1);
+	for (int i = 0; i < test.height(); ++i)
+		if (!expand(test.format(), test.width(), &testPix[i * wt4],
+		    test.row(i)))
+			return false;
+	for (int i = 0; i < hr; ++i)
+		if (!expand(ref.format(), ref.width(), &refPix[i * wr4],
+		    ref.row(i)))
+			return false;
+	return true;
+} // IntegerSearch::load
+
+template<class component>
+void
+IntegerSearch<component>::search(int first, int step, Position& best) const {
+	for (int i = first; i <= dh; i += step)
+		for (int j = 0; j <= wt4 - wr4; j += 4) {
+			double sad = 0.0;
+			for (int k = 0; k < hr && sad < best.error; ++k)
+				sad += SIMD::sad(wr4, &refPix[k * wr4],
+					&testPix[(i + k) * wt4 + j]);
+			if (sad < best.error) {
+				best.error = sad;
+				best.hOffset = i;
+				best.wOffset = j / 4;
+			}
+		}
+} // IntegerSearch::search
+
+///////////////////////////////////////////////////////////////////////////////
+// DoubleSearch:  find the offset of the reference image within the test
+//	image that minimizes the sum of the mean absolute errors of the four
+//	channels, for images that don't share an integer component type.
+//	The sums are accumulated in the same order, and the means computed
+//	the same way, as in BasicStats, so the choice of offset is exactly
+//	what it would be if every offset were given a full set of
+//	statistics.  As in IntegerSearch, an offset is abandoned as soon
+//	as it can't win.
+///////////////////////////////////////////////////////////////////////////////
+class DoubleSearch {
+public:
+	void load(Image& test, Image& ref);
+	void search(int first, int step, Position& best) const;
+
+private:
+	vector<double> testPix;
+	vector<double> refPix;
+	int wt4;		// Width of test image, in RGBA samples.
+	int wr4;		// Width of ref image, in RGBA samples.
+	int dh;			// Difference in heights, in pixels.
+	int hr;			// Height of ref image, in pixels.
+	double n;		// Number of samples per channel.
+};
+
+void
+DoubleSearch::load(Image& test, Image& ref) {
+	wt4 = 4 * test.width();
+	wr4 = 4 * ref.width();
+	dh = test.height() - ref.height();
+	hr = ref.height();
+	n = static_cast<double>(ref.width() * hr);
+
+	testPix.resize(wt4 * test.height() + 1);
+	refPix.resize(wr4 * hr + 1);
+	for (int i = 0; i < test.height(); ++i)
+		test.unpack(test.width(), &testPix[i * wt4],
+			test.row(i));
+	for (int i = 0; i < hr; ++i)
+		ref.unpack(ref.width(), &refPix[i * wr4],
+			ref.row(i));
+} // DoubleSearch::load
+
+void
+DoubleSearch::search(int first, int step, Position& best) const {
+	for (int i = first; i <= dh; i += step)
+		for (int j = 0; j <= wt4 - wr4; j += 4) {
+			double sum[4] = {0.0, 0.0, 0.0, 0.0};
+			double errorSum = 0.0;
+			for (int k = 0; k < hr && errorSum < best.error; ++k) {
+				const double* r = &refPix[k * wr4];
+				const double* t = &testPix[(i + k) * wt4 + j];
+				for (int m = 0; m < wr4; m += 4) {
+					sum[0] += fabs(r[m+0] - t[m+0]);
+					sum[1] += fabs(r[m+1] - t[m+1]);
+					sum[2] += fabs(r[m+2] - t[m+2]);
+					sum[3] += fabs(r[m+3] - t[m+3]);
+				}
+				// Each mean can only grow from here on:
+				errorSum = sum[0] / n + sum[1] / n
+					+ sum[2] / n + sum[3] / n;
+			}
+			if (errorSum < best.error) {
+				best.error = errorSum;
+				best.hOffset = i;
+				best.wOffset = j / 4;
+			}
+		}
+} // DoubleSearch::search
+
+///////////////////////////////////////////////////////////////////////////////
+// searchAll:  run a search over all candidate offsets.  Large searches
+//	deal the rows of offsets out to one thread per processor, round-robin
+//	so that each thread gets a share of the rows that register well
+//	(which are cheap, thanks to early termination) and of those that
+//	don't.  Each thread keeps its own best position, and the best of
+//	those is the position a serial search would find.
+///////////////////////////////////////////////////////////////////////////////
+template<class Search>
+struct SearchJob {
+	const Search* search;
+	int first;
+	int step;
+	Position best;
+};
+
+template<class Search>
+void*
+runSearchJob(void* p) {
+	SearchJob<Search>* job = static_cast<SearchJob<Search>*>(p);
+	job->search->search(job->first, job->step, job->best);
+	return 0;
+}
+
+int
+threadCount(int rows, double work) {
+#if defined(__UNIX__)
+	// Below a million or so absolute differences, starting threads
+	// costs more than it saves:
+	if (work < 1.0e6)
+		return 1;
+	long cpus = sysconf(_SC_NPROCESSORS_ONLN);
+	if (cpus < 1)
+		cpus = 1;
+	return (cpus < rows)? static_cast<int>(cpus): rows;
+#else
+	(void) rows;
+	(void) work;
+	return 1;
+#endif
+} // threadCount
+
+template<class Search>
+Position
+searchAll(const Search& s, int rows, double work) {
+	int n = threadCount(rows, work);
+	vector<SearchJob<Search> > jobs(n);
+	for (int t = 0; t < n; ++t) {
+		jobs[t].search = &s;
+		jobs[t].first = t;
+		jobs[t].step = n;
+	}
+
+#if defined(__UNIX__)
+	vector<pthread_t> ids(n);
+	vector<bool> started(n, false);
+	for (int t = 1; t < n; ++t)
+		started[t] = pthread_create(&ids[t], 0, runSearchJob<Search>,
+			&jobs[t]) == 0;
+	runSearchJob<Search>(&jobs[0]);
+	for (int t = 1; t < n; ++t) {
+		if (started[t])
+			pthread_join(ids[t], 0);
+		else	// Out of threads; run this one here.
+			runSearchJob<Search>(&jobs[t]);
+	}
+#else
+	runSearchJob<Search>(&jobs[0]);
+#endif
+
+	Position best = jobs[0].best;
+	for (int t = 1; t < n; ++t)
+		if (jobs[t].best < best)
+			best = jobs[t].best;
+	return best;
+} // searchAll
+
+} // anonymous namespace
+
 ///////////////////////////////////////////////////////////////////////////////
 // register:  compare a reference image to the current (``test'') image.
 //
@@ -48,127 +343,75 @@ namespace GLEAN {
 //
 //	The reference image will be slid into all possible positions over
 //	the current image, and the sum of the mean absolute errors for all
-//	four color channels computed at each position.
+//	four color channels computed at each position.  When both images
+//	have GL_UNSIGNED_BYTE or both have GL_UNSIGNED_SHORT components, the
+//	search works on the raw components; otherwise it works on unpacked
+//	RGBA values.
+//
+//	Large searches are divided among threads, without changing the
+//	result.
 //
 //	Returns an Image::Registration struct that specifies the position at
 //	which the sum of mean absolute errors was minimal, plus the statistics
-//	at that position.
+//	at that position.  Only that one position gets full statistics,
+//	gathered serially so that they're summed in the same order as ever.
 ///////////////////////////////////////////////////////////////////////////////
 Image::Registration
 Image::reg(Image& ref) {
 	int wt = width();		// Width of test image, in pixels.
 	int ht = height();		// Height of test image, in pixels.
 	int wr = ref.width();		// Width of reference image, in pixels.
-	int hr = ref.height();		// Height of test image, in pixels.
-	int dh = ht - hr;		// Difference in heights, in pixels.
-	int dw = wt - wr;		// Difference in widths, in pixels.
-	int i;
+	int hr = ref.height();		// Height of reference image, in pixels.
 
-	if (dh < 0 || dw < 0)
+	if (ht < hr || wt < wr)
 		throw RefImageTooLarge();
 
-	int wt4 = 4 * wt;		// Width of test image, in RGBA samples.
-	int wr4 = 4 * wr;		// Width of ref image, in RGBA samples.
-	int dw4 = 4 * dw;		// Difference in widths, in samples.
-
-	double** testPix;		// Buffers containing all the rows of
-					// the test image that need to be
-					// accessed concurrently.
-	// XXX sure would be nice to use auto_ptr to allocate this stuff,
-	// but it isn't supported in the STL that came with egcs 1.1.2.
-	
-	// XXX testPix = new (double*) [dh + 1];
-	// VC 6 seems to misinterpret this as a c-style cast
-	testPix = new double* [dh + 1];
-
-	
-	for (/*int */i = 0; i <= dh; ++i)
-		testPix[i] = new double [wt4];
-
-	double* refPix = new double [wr4];
-					// Buffer containing the one row of
-					// the reference image that's accessed
-					// at any given time.
-
-	BasicStats** stats;		// Buffers containing a statistics-
-					// gathering structure for each of
-					// the possible reference image
-					// positions.
-	// XXX stats = new (BasicStats*) [dh + 1];
-	// VC 6 seems to misinterpret this as a c-style cast
-	stats = new BasicStats * [dh + 1];
-
-	for (/*int*/ i = 0; i <= dh; ++i)
-		stats[i] = new BasicStats [dw4 + 4];
-
-	// Prime the pump by unpacking the first few rows of the test image:
-	char* testRow = pixels();
-	for (/*int*/ i = 0; i < dh; ++i) {
-		unpack(wt, testPix[i], testRow);
-		testRow += rowSizeInBytes();
-	}
+	Registration r;
+	r.wOffset = 0;
+	r.hOffset = 0;
+	if (wr == 0 || hr == 0)
+		return r;
 
-	// Now accumulate statistics for one row of the reference image
-	// at a time, in all possible positions:
-	char* refRow = ref.pixels();
-	for (/*int*/ i = 0; i < hr; ++i) {
-		// Get the next row of the reference image:
-		ref.unpack(wr, refPix, refRow);
-		refRow += ref.rowSizeInBytes();
-
-		// Get the next row of the test image:
-		unpack(wt, testPix[dh], testRow);
-		testRow += rowSizeInBytes();
-
-		// Accumulate absolute error for R,G,B,A in all positions:
-		for (int j = 0; j <= dh; ++j)
-			for (int k = 0; k <= dw4; k += 4)
-				for (int m = 0; m < wr4; m += 4) {
-					stats[j][k+0].sample( fabs(
-						refPix[m+0]-testPix[j][m+k+0]));
-					stats[j][k+1].sample( fabs(
-						refPix[m+1]-testPix[j][m+k+1]));
-					stats[j][k+2].sample( fabs(
-						refPix[m+2]-testPix[j][m+k+2]));
-					stats[j][k+3].sample( fabs(
-						refPix[m+3]-testPix[j][m+k+3]));
-				}
+	// Images of the same size (the usual case) have only one position;
+	// otherwise, search for the best one:
+	if (wt != wr || ht != hr) {
+		int rows = ht - hr + 1;
+		double work = 4.0 * rows * (wt - wr + 1) * wr * hr;
+		Position best;
+		IntegerSearch<GLubyte> bytes;
+		IntegerSearch<GLushort> shorts;
+		DoubleSearch doubles;
+		if (type() == GL_UNSIGNED_BYTE
+		 && ref.type() == GL_UNSIGNED_BYTE
+		 && bytes.load(*this, ref))
+			best = searchAll(bytes, rows, work);
+		else if (type() == GL_UNSIGNED_SHORT
+		      && ref.type() == GL_UNSIGNED_SHORT
+		      && shorts.load(*this, ref))
+			best = searchAll(shorts, rows, work);
+		else {
+			doubles.load(*this, ref);
+			best = searchAll(doubles, rows, work);
+		}
+		r.hOffset = best.hOffset;
+		r.wOffset = best.wOffset;
 	}
 
-	// Now find the position for which the sum of the mean absolute errors
-	// is minimal:
-	double minErrorSum = DBL_MAX;
-	int minI = 0;
-	int minJ = 0;
-	for (/*int*/ i = 0; i <= dh; ++i)
-		for (int j = 0; j <= dw4; j += 4) {
-			double errorSum = stats[i][j+0].mean()
-				+ stats[i][j+1].mean()
-				+ stats[i][j+2].mean()
-				+ stats[i][j+3].mean();
-			if (errorSum < minErrorSum) {
-				minErrorSum = errorSum;
-				minI = i;
-				minJ = j;
-			}
-		}
+	// Gather the statistics for the winning position, one row at a time:
+	vector<double> testPix(4 * wt);
+	vector<double> refPix(4 * wr);
+	for (int i = 0; i < hr; ++i) {
+		unpack(wt, &testPix[0], row(r.hOffset + i));
+		ref.unpack(wr, &refPix[0], ref.row(i));
 
-	Registration r;
-	r.wOffset = minJ / 4;
-	r.hOffset = minI;
-	r.stats[0] = stats[minI][minJ+0];
-	r.stats[1] = stats[minI][minJ+1];
-	r.stats[2] = stats[minI][minJ+2];
-	r.stats[3] = stats[minI][minJ+3];
-
-	// Clean up:
-	for (/*int*/ i = 0; i <= dh; ++i)
-		delete[] testPix[i];
-	delete[] testPix;
-	delete[] refPix;
-	for (/*int*/ i = 0; i <= dh; ++i)
-		delete[] stats[i];
-	delete[] stats;
+		const double* t = &testPix[4 * r.wOffset];
+		for (int m = 0; m < 4 * wr; m += 4) {
+			r.stats[0].sample(fabs(refPix[m+0] - t[m+0]));
+			r.stats[1].sample(fabs(refPix[m+1] - t[m+1]));
+			r.stats[2].sample(fabs(refPix[m+2] - t[m+2]));
+			r.stats[3].sample(fabs(refPix[m+3] - t[m+3]));
+		}
+	}
 
 	return r;
 } // Image::register
@@ -0,0 +1,1137 @@
+// BEGIN_COPYRIGHT
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+
+
+
+// simd.cpp:  vectorized pixel packing, unpacking, and differencing
+
+// Only GCC-compatible compilers targeting x86-64 get the vector code.
+// SSE2 is part of the x86-64 base architecture, so the SSE2 functions
+// need nothing special; the AVX2 functions are compiled for AVX2 one by
+// one (with the target attribute), and are only called if the processor
+// has it.
+
+#include <math.h>
+#include <algorithm>
+#include "simd.h"
+
+#if defined(__GNUC__) && defined(__x86_64__)
+#define GLEAN_SIMD_X86
+#include <immintrin.h>
+#include <string.h>
+#endif
+
+namespace GLEAN {
+
+namespace SIMD {
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+// sadPortable:  sum of absolute differences, for any processor.  Blocks of
+//	32768 components are summed in an unsigned long, which can't
+//	overflow even for 16-bit components.
+///////////////////////////////////////////////////////////////////////////////
+template<class component>
+double
+sadPortable(GLsizei n, const component* a, const component* b) {
+	double sum = 0.0;
+	while (n > 0) {
+		GLsizei m = (n < 32768)? n: 32768;
+		unsigned long s = 0;
+		for (GLsizei i = 0; i < m; ++i)
+			s += (a[i] > b[i])? a[i] - b[i]: b[i] - a[i];
+		sum += s;
+		a += m;
+		b += m;
+		n -= m;
+	}
+	return sum;
+} // sadPortable
+
+///////////////////////////////////////////////////////////////////////////////
+// exceedsPortable:  threshold test, for any processor
+///////////////////////////////////////////////////////////////////////////////
+GLsizei
+exceedsPortable(GLsizei n, const float* a, const float* b, float threshold,
+    GLubyte* mask, float* maxError) {
+	GLsizei count = 0;
+	for (GLsizei i = 0; i < n; ++i, a += 4, b += 4) {
+		bool over = false;
+		for (int c = 0; c < 4; ++c) {
+			float d = fabsf(a[c] - b[c]);
+			if (d > maxError[c])
+				maxError[c] = d;
+			over |= d > threshold;
+		}
+		mask[i] = over? 255: 0;
+		count += over;
+	}
+	return count;
+} // exceedsPortable
+
+///////////////////////////////////////////////////////////////////////////////
+// comparePortable:  comparison metrics, for any processor.  Each sum is
+//	formed in exactly the same order as in the vector versions.
+///////////////////////////////////////////////////////////////////////////////
+float
+comparePortable(GLsizei n, const float* a, const float* b,
+    const float* weights, float* error, float* squares, float* window) {
+	float largest = 0.0f;
+	for (GLsizei j = 0; j < n; ++j) {
+		const float* p = a + 4 * j;
+		const float* q = b + 4 * j;
+		int column = j % 8;
+		float e = 0.0f;
+		for (int c = 0; c < 4; ++c) {
+			float d = fabsf(p[c] - q[c]);
+			if (d != d)
+				d = 0.0f;
+			if (d > e)
+				e = d;
+			squares[8 * c + column] += d * d;
+		}
+		error[j] = e;
+		if (e > largest)
+			largest = e;
+
+		float x = weights[0] * p[0] + weights[1] * p[1]
+			+ weights[2] * p[2];
+		float y = weights[0] * q[0] + weights[1] * q[1]
+			+ weights[2] * q[2];
+		float* s = window + 40 * (j / 8) + column;
+		s[0] += x;
+		s[8] += y;
+		s[16] += x * x;
+		s[24] += y * y;
+		s[32] += x * y;
+	}
+	return largest;
+} // comparePortable
+
+} // anonymous namespace
+
+#if defined(GLEAN_SIMD_X86)
+
+namespace {
+
+#define AVX2 __attribute__((target("avx2")))
+
+// Scale factors; these must match SCALE in unpack.cpp and pack.cpp.
+template<class component> struct Range { };
+template<> struct Range<GLubyte> {
+	static double unpackScale() { return 1.0 / 255.0; }
+	static double packScale() { return 255.0 / 1.0; }
+};
+template<> struct Range<GLushort> {
+	static double unpackScale() { return 1.0 / 65535.0; }
+	static double packScale() { return 65535.0 / 1.0; }
+};
+template<> struct Range<GLfloat> {
+	static double unpackScale() { return 1.0 / 1.0; }
+	static double packScale() { return 1.0 / 1.0; }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Loading components.  Pixels are loaded in blocks, as single-precision
+//	vectors holding one pixel each (sse2()) or two pixels each (avx2());
+//	one() loads a single pixel, for the pixels left over.  (For AVX2,
+//	integer components stay integers; see Wide below.)  Integer
+//	components of 16 bits or less convert to float exactly, and from
+//	there to double exactly, so nothing is lost on the way to double.
+//	Missing alpha is zero, as in unpack.cpp.
+//
+//	A block may read a little beyond its last pixel, so ``needed'' is
+//	the number of pixels that must remain for a block to be loaded.
+///////////////////////////////////////////////////////////////////////////////
+template<class component, int channels> struct Load { };
+
+// avx2() yields integers for integer components, which convert straight
+// to double:
+template<class component> struct Wide {
+	typedef __m256i Vector;
+};
+template<> struct Wide<GLfloat> {
+	typedef __m256 Vector;
+};
+
+AVX2 inline __m256 toFloat(__m256i c) { return _mm256_cvtepi32_ps(c); }
+AVX2 inline __m256 toFloat(__m256 c) { return c; }
+AVX2 inline __m256d lowDouble(__m256i c) {
+	return _mm256_cvtepi32_pd(_mm256_castsi256_si128(c));
+}
+AVX2 inline __m256d lowDouble(__m256 c) {
+	return _mm256_cvtps_pd(_mm256_castps256_ps128(c));
+}
+AVX2 inline __m256d highDouble(__m256i c) {
+	return _mm256_cvtepi32_pd(_mm256_extracti128_si256(c, 1));
+}
+AVX2 inline __m256d highDouble(__m256 c) {
+	return _mm256_cvtps_pd(_mm256_extractf128_ps(c, 1));
+}
+
+template<> struct Load<GLubyte, 4> {
+	enum { block = 4, needed = 4 };
+	static __m128 one(const GLubyte* p) {
+		int w;
+		memcpy(&w, p, 4);
+		__m128i z = _mm_setzero_si128();
+		__m128i c = _mm_unpacklo_epi8(_mm_cvtsi32_si128(w), z);
+		return _mm_cvtepi32_ps(_mm_unpacklo_epi16(c, z));
+	}
+	static void sse2(const GLubyte* p, __m128* px) {
+		__m128i z = _mm_setzero_si128();
+		__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		__m128i lo = _mm_unpacklo_epi8(c, z);
+		__m128i hi = _mm_unpackhi_epi8(c, z);
+		px[0] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(lo, z));
+		px[1] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(lo, z));
+		px[2] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(hi, z));
+		px[3] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(hi, z));
+	}
+	AVX2 static void avx2(const GLubyte* p, __m256i* px) {
+		__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		px[0] = _mm256_cvtepu8_epi32(c);
+		px[1] = _mm256_cvtepu8_epi32(_mm_srli_si128(c, 8));
+	}
+};
+
+template<> struct Load<GLubyte, 3> {
+	// Four pixels are loaded with one 16-byte read, so two more
+	// must follow them.
+	enum { block = 4, needed = 6 };
+	static __m128 one(const GLubyte* p) {
+		return _mm_setr_ps(p[0], p[1], p[2], 0);
+	}
+	AVX2 static void avx2(const GLubyte* p, __m256i* px) {
+		// Spread RGBRGBRGBRGB to RGB0RGB0RGB0RGB0:
+		const __m128i spread = _mm_setr_epi8(0, 1, 2, -1, 3, 4, 5, -1,
+			6, 7, 8, -1, 9, 10, 11, -1);
+		__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		c = _mm_shuffle_epi8(c, spread);
+		px[0] = _mm256_cvtepu8_epi32(c);
+		px[1] = _mm256_cvtepu8_epi32(_mm_srli_si128(c, 8));
+	}
+};
+
+template<> struct Load<GLushort, 4> {
+	enum { block = 2, needed = 2 };
+	static __m128 one(const GLushort* p) {
+		__m128i c = _mm_loadl_epi64(reinterpret_cast<const __m128i*>(p));
+		return _mm_cvtepi32_ps(
+			_mm_unpacklo_epi16(c, _mm_setzero_si128()));
+	}
+	static void sse2(const GLushort* p, __m128* px) {
+		__m128i z = _mm_setzero_si128();
+		__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		px[0] = _mm_cvtepi32_ps(_mm_unpacklo_epi16(c, z));
+		px[1] = _mm_cvtepi32_ps(_mm_unpackhi_epi16(c, z));
+	}
+	AVX2 static void avx2(const GLushort* p, __m256i* px) {
+		__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		px[0] = _mm256_cvtepu16_epi32(c);
+	}
+};
+
+template<> struct Load<GLushort, 3> {
+	// Two pixels are loaded with one 16-byte read, so one more must
+	// follow them.
+	enum { block = 2, needed = 3 };
+	static __m128 one(const GLushort* p) {
+		return _mm_setr_ps(p[0], p[1], p[2], 0);
+	}
+	AVX2 static void avx2(const GLushort* p, __m256i* px) {
+		const __m128i spread = _mm_setr_epi8(0, 1, 2, 3, 4, 5, -1, -1,
+			6, 7, 8, 9, 10, 11, -1, -1);
+		__m128i c = _mm_loadu_si128(reinterpret_cast<const __m128i*>(p));
+		c = _mm_shuffle_epi8(c, spread);
+		px[0] = _mm256_cvtepu16_epi32(c);
+	}
+};
+
+template<> struct Load<GLfloat, 4> {
+	enum { block = 2, needed = 2 };
+	static __m128 one(const GLfloat* p) {
+		return _mm_loadu_ps(p);
+	}
+	static void sse2(const GLfloat* p, __m128* px) {
+		px[0] = _mm_loadu_ps(p);
+		px[1] = _mm_loadu_ps(p + 4);
+	}
+	AVX2 static void avx2(const GLfloat* p, __m256* px) {
+		px[0] = _mm256_loadu_ps(p);
+	}
+};
+
+template<> struct Load<GLfloat, 3> {
+	enum { block = 2, needed = 2 };
+	static __m128 one(const GLfloat* p) {
+		return _mm_setr_ps(p[0], p[1], p[2], 0);
+	}
+	AVX2 static void avx2(const GLfloat* p, __m256* px) {
+		// Masked loads don't touch the memory they skip:
+		const __m128i rgb = _mm_setr_epi32(-1, -1, -1, 0);
+		px[0] = _mm256_insertf128_ps(
+			_mm256_castps128_ps256(_mm_maskload_ps(p, rgb)),
+			_mm_maskload_ps(p + 3, rgb), 1);
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Storing components (RGBA only).  Integer components arrive as 32-bit
+//	integers, already truncated toward zero, and are narrowed by keeping
+//	their low-order bits, just as the conversions in pack.cpp do.
+///////////////////////////////////////////////////////////////////////////////
+template<class component> struct Convert {
+	typedef __m128i Vector;
+	static Vector sse2(__m128d lo, __m128d hi) {
+		return _mm_unpacklo_epi64(_mm_cvttpd_epi32(lo),
+			_mm_cvttpd_epi32(hi));
+	}
+	AVX2 static Vector avx2(__m256d c) {
+		return _mm256_cvttpd_epi32(c);
+	}
+};
+
+template<> struct Convert<GLfloat> {
+	typedef __m128 Vector;
+	static Vector sse2(__m128d lo, __m128d hi) {
+		return _mm_movelh_ps(_mm_cvtpd_ps(lo), _mm_cvtpd_ps(hi));
+	}
+	AVX2 static Vector avx2(__m256d c) {
+		return _mm256_cvtpd_ps(c);
+	}
+};
+
+template<class component> struct Store { };
+
+template<> struct Store<GLubyte> {
+	enum { block = 4 };
+	static __m128i low8(__m128i c) {
+		return _mm_and_si128(c, _mm_set1_epi32(0xFF));
+	}
+	static void one(GLubyte* p, __m128i c) {
+		c = _mm_packs_epi32(low8(c), c);
+		int w = _mm_cvtsi128_si32(_mm_packus_epi16(c, c));
+		memcpy(p, &w, 4);
+	}
+	static void some(GLubyte* p, const __m128i* c) {
+		__m128i lo = _mm_packs_epi32(low8(c[0]), low8(c[1]));
+		__m128i hi = _mm_packs_epi32(low8(c[2]), low8(c[3]));
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(p),
+			_mm_packus_epi16(lo, hi));
+	}
+};
+
+template<> struct Store<GLushort> {
+	enum { block = 2 };
+	// Sign-extend the low 16 bits, so that the saturating pack leaves
+	// them alone:
+	static __m128i low16(__m128i c) {
+		return _mm_srai_epi32(_mm_slli_epi32(c, 16), 16);
+	}
+	static void one(GLushort* p, __m128i c) {
+		c = low16(c);
+		_mm_storel_epi64(reinterpret_cast<__m128i*>(p),
+			_mm_packs_epi32(c, c));
+	}
+	static void some(GLushort* p, const __m128i* c) {
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(p),
+			_mm_packs_epi32(low16(c[0]), low16(c[1])));
+	}
+};
+
+template<> struct Store<GLfloat> {
+	enum { block = 1 };
+	static void one(GLfloat* p, __m128 c) {
+		_mm_storeu_ps(p, c);
+	}
+	static void some(GLfloat* p, const __m128* c) {
+		_mm_storeu_ps(p, c[0]);
+	}
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// Component order.  Loaded pixels have their components in memory order;
+//	for BGR, BGRA, and ABGR images a shuffle (with the control given as
+//	_MM_SHUFFLE() would) puts them in RGBA order.  In 256-bit vectors
+//	each 128-bit lane holds one pixel, and gets the same shuffle.
+///////////////////////////////////////////////////////////////////////////////
+enum Order {
+	rgbaOrder = _MM_SHUFFLE(3, 2, 1, 0),
+	bgraOrder = _MM_SHUFFLE(3, 0, 1, 2),	// Also BGR, with 0 for A
+	abgrOrder = _MM_SHUFFLE(0, 1, 2, 3),
+	argbOrder = _MM_SHUFFLE(0, 3, 2, 1)	// Only GL_BGRA with
+						// GL_UNSIGNED_INT_8_8_8_8
+};
+
+template<int order> inline __m128
+swizzle(__m128 c) {
+	return (order == rgbaOrder)? c: _mm_shuffle_ps(c, c, order);
+}
+template<int order> AVX2 inline __m256i
+swizzle(__m256i c) {
+	return (order == rgbaOrder)? c: _mm256_shuffle_epi32(c, order);
+}
+template<int order> AVX2 inline __m256
+swizzle(__m256 c) {
+	return (order == rgbaOrder)? c: _mm256_shuffle_ps(c, c, order);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// SSE2 kernels
+///////////////////////////////////////////////////////////////////////////////
+inline void
+storeDouble(double* rgba, __m128 c, __m128d scale) {
+	_mm_storeu_pd(rgba, _mm_mul_pd(_mm_cvtps_pd(c), scale));
+	_mm_storeu_pd(rgba + 2,
+		_mm_mul_pd(_mm_cvtps_pd(_mm_movehl_ps(c, c)), scale));
+}
+
+template<class component, int channels, int order>
+void
+unpackDoubleSSE2(GLsizei n, double* rgba, const char* nextPixel) {
+	typedef Load<component, channels> L;
+	const component* in = reinterpret_cast<const component*>(nextPixel);
+	const __m128d scale = _mm_set1_pd(Range<component>::unpackScale());
+	GLsizei i;
+	for (i = 0; i + L::needed <= n; i += L::block) {
+		__m128 px[L::block];
+		L::sse2(in, px);
+		for (int k = 0; k < L::block; ++k, rgba += 4)
+			storeDouble(rgba, swizzle<order>(px[k]), scale);
+		in += L::block * channels;
+	}
+	for (; i < n; ++i, rgba += 4, in += channels)
+		storeDouble(rgba, swizzle<order>(L::one(in)), scale);
+}
+
+template<class component, int channels, int order>
+void
+unpackFloatSSE2(GLsizei n, float* rgba, const char* nextPixel) {
+	typedef Load<component, channels> L;
+	const component* in = reinterpret_cast<const component*>(nextPixel);
+	const __m128 scale = _mm_set1_ps(
+		static_cast<float>(Range<component>::unpackScale()));
+	GLsizei i;
+	for (i = 0; i + L::needed <= n; i += L::block) {
+		__m128 px[L::block];
+		L::sse2(in, px);
+		for (int k = 0; k < L::block; ++k, rgba += 4)
+			_mm_storeu_ps(rgba,
+				_mm_mul_ps(swizzle<order>(px[k]), scale));
+		in += L::block * channels;
+	}
+	for (; i < n; ++i, rgba += 4, in += channels)
+		_mm_storeu_ps(rgba,
+			_mm_mul_ps(swizzle<order>(L::one(in)), scale));
+}
+
+template<class component>
+void
+packSSE2(GLsizei n, char* nextPixel, double* rgba) {
+	typedef Store<component> S;
+	typedef typename Convert<component>::Vector Vector;
+	component* out = reinterpret_cast<component*>(nextPixel);
+	const __m128d scale = _mm_set1_pd(Range<component>::packScale());
+	GLsizei i;
+	for (i = 0; i + S::block <= n; i += S::block) {
+		Vector px[S::block];
+		for (int k = 0; k < S::block; ++k, rgba += 4)
+			px[k] = Convert<component>::sse2(
+				_mm_mul_pd(_mm_loadu_pd(rgba), scale),
+				_mm_mul_pd(_mm_loadu_pd(rgba + 2), scale));
+		S::some(out, px);
+		out += 4 * S::block;
+	}
+	for (; i < n; ++i, rgba += 4, out += 4)
+		S::one(out, Convert<component>::sse2(
+			_mm_mul_pd(_mm_loadu_pd(rgba), scale),
+			_mm_mul_pd(_mm_loadu_pd(rgba + 2), scale)));
+}
+
+// PSADBW sums eight byte differences at a time into 64 bits.  There's no
+// 16-bit equivalent, so the 16-bit version takes |a - b| with two
+// saturating subtractions, and widens into 32-bit lanes that are flushed
+// to 64 bits before they can overflow.
+double
+sadSSE2(GLsizei n, const GLubyte* a, const GLubyte* b) {
+	__m128i acc = _mm_setzero_si128();
+	GLsizei i = 0;
+	for (; i + 16 <= n; i += 16)
+		acc = _mm_add_epi64(acc, _mm_sad_epu8(
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(a + i)),
+			_mm_loadu_si128(reinterpret_cast<const __m128i*>(b + i))));
+	acc = _mm_add_epi64(acc, _mm_unpackhi_epi64(acc, acc));
+	return static_cast<double>(_mm_cvtsi128_si64(acc))
+		+ sadPortable(n - i, a + i, b + i);
+}
+
+double
+sadSSE2(GLsizei n, const GLushort* a, const GLushort* b) {
+	const __m128i zero = _mm_setzero_si128();
+	__m128i acc = zero;
+	GLsizei i = 0;
+	while (i + 8 <= n) {
+		__m128i acc32 = zero;
+		// Each pass adds at most 2 * 65535 to each 32-bit lane:
+		for (int k = 0; k < 16384 && i + 8 <= n; ++k, i += 8) {
+			__m128i x = _mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(a + i));
+			__m128i y = _mm_loadu_si128(
+				reinterpret_cast<const __m128i*>(b + i));
+			__m128i d = _mm_or_si128(_mm_subs_epu16(x, y),
+				_mm_subs_epu16(y, x));
+			acc32 = _mm_add_epi32(acc32, _mm_add_epi32(
+				_mm_unpacklo_epi16(d, zero),
+				_mm_unpackhi_epi16(d, zero)));
+		}
+		acc = _mm_add_epi64(acc, _mm_add_epi64(
+			_mm_unpacklo_epi32(acc32, zero),
+			_mm_unpackhi_epi32(acc32, zero)));
+	}
+	acc = _mm_add_epi64(acc, _mm_unpackhi_epi64(acc, acc));
+	return static_cast<double>(_mm_cvtsi128_si64(acc))
+		+ sadPortable(n - i, a + i, b + i);
+}
+
+// One RGBA pixel per 4-wide vector; the sign bit is masked off for the
+// absolute value.  MAXPS returns its second operand if either is NaN, so
+// NaN differences leave the maxima alone, as in the portable code.
+GLsizei
+exceedsSSE2(GLsizei n, const float* a, const float* b, float threshold,
+    GLubyte* mask, float* maxError) {
+	const __m128 magnitude = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	const __m128 t = _mm_set1_ps(threshold);
+	__m128 maxv = _mm_loadu_ps(maxError);
+	GLsizei count = 0;
+	for (GLsizei i = 0; i < n; ++i) {
+		__m128 d = _mm_and_ps(magnitude, _mm_sub_ps(
+			_mm_loadu_ps(a + 4 * i), _mm_loadu_ps(b + 4 * i)));
+		maxv = _mm_max_ps(d, maxv);
+		bool over = _mm_movemask_ps(_mm_cmpgt_ps(d, t)) != 0;
+		mask[i] = over? 255: 0;
+		count += over;
+	}
+	_mm_storeu_ps(maxError, maxv);
+	return count;
+}
+
+// Absolute difference, with NaN replaced by 0:
+inline __m128
+absDiff(__m128 a, __m128 b) {
+	const __m128 magnitude = _mm_castsi128_ps(_mm_set1_epi32(0x7fffffff));
+	__m128 d = _mm_and_ps(magnitude, _mm_sub_ps(a, b));
+	return _mm_and_ps(d, _mm_cmpord_ps(d, d));
+}
+
+inline void
+accumulate(float* sum, __m128 v) {
+	_mm_storeu_ps(sum, _mm_add_ps(_mm_loadu_ps(sum), v));
+}
+
+// Four RGBA pixels at a time (half a window); transposing them puts
+// each component in a vector of its own, one pixel per lane.
+float
+compareSSE2(GLsizei n, const float* a, const float* b, const float* weights,
+    float* error, float* squares, float* window) {
+	const __m128 wr = _mm_set1_ps(weights[0]);
+	const __m128 wg = _mm_set1_ps(weights[1]);
+	const __m128 wb = _mm_set1_ps(weights[2]);
+	__m128 largest = _mm_setzero_ps();
+	GLsizei i = 0;
+	for (; i + 8 <= n; i += 8, window += 40)
+		for (int h = 0; h < 8; h += 4) {
+			const float* p = a + 4 * (i + h);
+			const float* q = b + 4 * (i + h);
+			__m128 a0 = _mm_loadu_ps(p);
+			__m128 a1 = _mm_loadu_ps(p + 4);
+			__m128 a2 = _mm_loadu_ps(p + 8);
+			__m128 a3 = _mm_loadu_ps(p + 12);
+			__m128 b0 = _mm_loadu_ps(q);
+			__m128 b1 = _mm_loadu_ps(q + 4);
+			__m128 b2 = _mm_loadu_ps(q + 8);
+			__m128 b3 = _mm_loadu_ps(q + 12);
+
+			__m128 d0 = absDiff(a0, b0);
+			__m128 d1 = absDiff(a1, b1);
+			__m128 d2 = absDiff(a2, b2);
+			__m128 d3 = absDiff(a3, b3);
+			_MM_TRANSPOSE4_PS(d0, d1, d2, d3);
+			__m128 e = _mm_max_ps(_mm_max_ps(d0, d1),
+				_mm_max_ps(d2, d3));
+			_mm_storeu_ps(error + i + h, e);
+			largest = _mm_max_ps(largest, e);
+			accumulate(squares + h, _mm_mul_ps(d0, d0));
+			accumulate(squares + 8 + h, _mm_mul_ps(d1, d1));
+			accumulate(squares + 16 + h, _mm_mul_ps(d2, d2));
+			accumulate(squares + 24 + h, _mm_mul_ps(d3, d3));
+
+			_MM_TRANSPOSE4_PS(a0, a1, a2, a3);
+			_MM_TRANSPOSE4_PS(b0, b1, b2, b3);
+			__m128 x = _mm_add_ps(_mm_add_ps(_mm_mul_ps(wr, a0),
+				_mm_mul_ps(wg, a1)), _mm_mul_ps(wb, a2));
+			__m128 y = _mm_add_ps(_mm_add_ps(_mm_mul_ps(wr, b0),
+				_mm_mul_ps(wg, b1)), _mm_mul_ps(wb, b2));
+			accumulate(window + h, x);
+			accumulate(window + 8 + h, y);
+			accumulate(window + 16 + h, _mm_mul_ps(x, x));
+			accumulate(window + 24 + h, _mm_mul_ps(y, y));
+			accumulate(window + 32 + h, _mm_mul_ps(x, y));
+		}
+
+	float l[4];
+	_mm_storeu_ps(l, largest);
+	float rest = comparePortable(n - i, a + 4 * i, b + 4 * i, weights,
+		error + i, squares, window);
+	return std::max(std::max(std::max(l[0], l[1]), std::max(l[2], l[3])),
+		rest);
+}
+
+///////////////////////////////////////////////////////////////////////////////
+// AVX2 kernels
+///////////////////////////////////////////////////////////////////////////////
+template<class component, int channels, int order>
+AVX2 void
+unpackDoubleAVX2(GLsizei n, double* rgba, const char* nextPixel) {
+	typedef Load<component, channels> L;
+	const component* in = reinterpret_cast<const component*>(nextPixel);
+	const __m256d scale = _mm256_set1_pd(Range<component>::unpackScale());
+	GLsizei i;
+	for (i = 0; i + L::needed <= n; i += L::block) {
+		typename Wide<component>::Vector px[L::block / 2];
+		L::avx2(in, px);
+		for (int k = 0; k < L::block / 2; ++k, rgba += 8) {
+			px[k] = swizzle<order>(px[k]);
+			_mm256_storeu_pd(rgba,
+				_mm256_mul_pd(lowDouble(px[k]), scale));
+			_mm256_storeu_pd(rgba + 4,
+				_mm256_mul_pd(highDouble(px[k]), scale));
+		}
+		in += L::block * channels;
+	}
+	for (; i < n; ++i, rgba += 4, in += channels)
+		_mm256_storeu_pd(rgba, _mm256_mul_pd(
+			_mm256_cvtps_pd(swizzle<order>(L::one(in))), scale));
+}
+
+template<class component, int channels, int order>
+AVX2 void
+unpackFloatAVX2(GLsizei n, float* rgba, const char* nextPixel) {
+	typedef Load<component, channels> L;
+	const component* in = reinterpret_cast<const component*>(nextPixel);
+	const __m256 scale = _mm256_set1_ps(
+		static_cast<float>(Range<component>::unpackScale()));
+	GLsizei i;
+	for (i = 0; i + L::needed <= n; i += L::block) {
+		typename Wide<component>::Vector px[L::block / 2];
+		L::avx2(in, px);
+		for (int k = 0; k < L::block / 2; ++k, rgba += 8)
+			_mm256_storeu_ps(rgba, _mm256_mul_ps(
+				toFloat(swizzle<order>(px[k])), scale));
+		in += L::block * channels;
+	}
+	for (; i < n; ++i, rgba += 4, in += channels)
+		_mm_storeu_ps(rgba, _mm_mul_ps(swizzle<order>(L::one(in)),
+			_mm256_castps256_ps128(scale)));
+}
+
+template<class component>
+AVX2 void
+packAVX2(GLsizei n, char* nextPixel, double* rgba) {
+	typedef Store<component> S;
+	typedef typename Convert<component>::Vector Vector;
+	component* out = reinterpret_cast<component*>(nextPixel);
+	const __m256d scale = _mm256_set1_pd(Range<component>::packScale());
+	GLsizei i;
+	for (i = 0; i + S::block <= n; i += S::block) {
+		Vector px[S::block];
+		for (int k = 0; k < S::block; ++k, rgba += 4)
+			px[k] = Convert<component>::avx2(
+				_mm256_mul_pd(_mm256_loadu_pd(rgba), scale));
+		S::some(out, px);
+		out += 4 * S::block;
+	}
+	for (; i < n; ++i, rgba += 4, out += 4)
+		S::one(out, Convert<component>::avx2(
+			_mm256_mul_pd(_mm256_loadu_pd(rgba), scale)));
+}
+
+AVX2 inline long long
+sum64(__m256i acc) {
+	__m128i s = _mm_add_epi64(_mm256_castsi256_si128(acc),
+		_mm256_extracti128_si256(acc, 1));
+	s = _mm_add_epi64(s, _mm_unpackhi_epi64(s, s));
+	return _mm_cvtsi128_si64(s);
+}
+
+AVX2 double
+sadAVX2(GLsizei n, const GLubyte* a, const GLubyte* b) {
+	__m256i acc = _mm256_setzero_si256();
+	GLsizei i = 0;
+	for (; i + 32 <= n; i += 32)
+		acc = _mm256_add_epi64(acc, _mm256_sad_epu8(
+			_mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(a + i)),
+			_mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(b + i))));
+	return static_cast<double>(sum64(acc))
+		+ sadPortable(n - i, a + i, b + i);
+}
+
+AVX2 double
+sadAVX2(GLsizei n, const GLushort* a, const GLushort* b) {
+	const __m256i zero = _mm256_setzero_si256();
+	__m256i acc = zero;
+	GLsizei i = 0;
+	while (i + 16 <= n) {
+		__m256i acc32 = zero;
+		for (int k = 0; k < 16384 && i + 16 <= n; ++k, i += 16) {
+			__m256i x = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(a + i));
+			__m256i y = _mm256_loadu_si256(
+				reinterpret_cast<const __m256i*>(b + i));
+			__m256i d = _mm256_or_si256(_mm256_subs_epu16(x, y),
+				_mm256_subs_epu16(y, x));
+			acc32 = _mm256_add_epi32(acc32, _mm256_add_epi32(
+				_mm256_unpacklo_epi16(d, zero),
+				_mm256_unpackhi_epi16(d, zero)));
+		}
+		acc = _mm256_add_epi64(acc, _mm256_add_epi64(
+			_mm256_unpacklo_epi32(acc32, zero),
+			_mm256_unpackhi_epi32(acc32, zero)));
+	}
+	return static_cast<double>(sum64(acc))
+		+ sadPortable(n - i, a + i, b + i);
+}
+
+AVX2 GLsizei
+exceedsAVX2(GLsizei n, const float* a, const float* b, float threshold,
+    GLubyte* mask, float* maxError) {
+	const __m256 magnitude =
+		_mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+	const __m256 t = _mm256_set1_ps(threshold);
+	__m256 maxv = _mm256_castps128_ps256(_mm_loadu_ps(maxError));
+	maxv = _mm256_insertf128_ps(maxv, _mm_loadu_ps(maxError), 1);
+	GLsizei count = 0;
+	GLsizei i = 0;
+	for (; i + 2 <= n; i += 2) {
+		__m256 d = _mm256_and_ps(magnitude, _mm256_sub_ps(
+			_mm256_loadu_ps(a + 4 * i),
+			_mm256_loadu_ps(b + 4 * i)));
+		maxv = _mm256_max_ps(d, maxv);
+		int bits = _mm256_movemask_ps(_mm256_cmp_ps(d, t, _CMP_GT_OQ));
+		mask[i] = (bits & 0x0f)? 255: 0;
+		mask[i + 1] = (bits & 0xf0)? 255: 0;
+		count += ((bits & 0x0f) != 0) + ((bits & 0xf0) != 0);
+	}
+	_mm_storeu_ps(maxError, _mm_max_ps(_mm256_castps256_ps128(maxv),
+		_mm256_extractf128_ps(maxv, 1)));
+	return count + exceedsPortable(n - i, a + 4 * i, b + 4 * i, threshold,
+		mask + i, maxError);
+}
+
+// Pixels j and j + 4, in the low and high halves:
+AVX2 inline __m256
+loadPair(const float* p) {
+	return _mm256_insertf128_ps(_mm256_castps128_ps256(_mm_loadu_ps(p)),
+		_mm_loadu_ps(p + 16), 1);
+}
+
+// _MM_TRANSPOSE4_PS, in each half:
+AVX2 inline void
+transpose(__m256& v0, __m256& v1, __m256& v2, __m256& v3) {
+	__m256 t0 = _mm256_unpacklo_ps(v0, v1);
+	__m256 t1 = _mm256_unpackhi_ps(v0, v1);
+	__m256 t2 = _mm256_unpacklo_ps(v2, v3);
+	__m256 t3 = _mm256_unpackhi_ps(v2, v3);
+	v0 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(1, 0, 1, 0));
+	v1 = _mm256_shuffle_ps(t0, t2, _MM_SHUFFLE(3, 2, 3, 2));
+	v2 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(1, 0, 1, 0));
+	v3 = _mm256_shuffle_ps(t1, t3, _MM_SHUFFLE(3, 2, 3, 2));
+}
+
+AVX2 inline __m256
+absDiff(__m256 a, __m256 b) {
+	const __m256 magnitude =
+		_mm256_castsi256_ps(_mm256_set1_epi32(0x7fffffff));
+	__m256 d = _mm256_and_ps(magnitude, _mm256_sub_ps(a, b));
+	return _mm256_and_ps(d, _mm256_cmp_ps(d, d, _CMP_ORD_Q));
+}
+
+AVX2 inline void
+accumulate(float* sum, __m256 v) {
+	_mm256_storeu_ps(sum, _mm256_add_ps(_mm256_loadu_ps(sum), v));
+}
+
+// A whole window of 8 pixels at a time.  Pixels 0-3 are loaded into the
+// low halves of four vectors and pixels 4-7 into the high halves, so
+// that transposing the halves leaves each component of the 8 pixels in
+// order in a vector of its own.
+AVX2 float
+compareAVX2(GLsizei n, const float* a, const float* b, const float* weights,
+    float* error, float* squares, float* window) {
+	const __m256 wr = _mm256_set1_ps(weights[0]);
+	const __m256 wg = _mm256_set1_ps(weights[1]);
+	const __m256 wb = _mm256_set1_ps(weights[2]);
+	__m256 largest = _mm256_setzero_ps();
+	__m256 sr = _mm256_loadu_ps(squares);
+	__m256 sg = _mm256_loadu_ps(squares + 8);
+	__m256 sb = _mm256_loadu_ps(squares + 16);
+	__m256 sa = _mm256_loadu_ps(squares + 24);
+	GLsizei i = 0;
+	for (; i + 8 <= n; i += 8, window += 40) {
+		const float* p = a + 4 * i;
+		const float* q = b + 4 * i;
+		__m256 a0 = loadPair(p);
+		__m256 a1 = loadPair(p + 4);
+		__m256 a2 = loadPair(p + 8);
+		__m256 a3 = loadPair(p + 12);
+		__m256 b0 = loadPair(q);
+		__m256 b1 = loadPair(q + 4);
+		__m256 b2 = loadPair(q + 8);
+		__m256 b3 = loadPair(q + 12);
+
+		__m256 d0 = absDiff(a0, b0);
+		__m256 d1 = absDiff(a1, b1);
+		__m256 d2 = absDiff(a2, b2);
+		__m256 d3 = absDiff(a3, b3);
+		transpose(d0, d1, d2, d3);
+		__m256 e = _mm256_max_ps(_mm256_max_ps(d0, d1),
+			_mm256_max_ps(d2, d3));
+		_mm256_storeu_ps(error + i, e);
+		largest = _mm256_max_ps(largest, e);
+		sr = _mm256_add_ps(sr, _mm256_mul_ps(d0, d0));
+		sg = _mm256_add_ps(sg, _mm256_mul_ps(d1, d1));
+		sb = _mm256_add_ps(sb, _mm256_mul_ps(d2, d2));
+		sa = _mm256_add_ps(sa, _mm256_mul_ps(d3, d3));
+
+		transpose(a0, a1, a2, a3);
+		transpose(b0, b1, b2, b3);
+		__m256 x = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(wr, a0),
+			_mm256_mul_ps(wg, a1)), _mm256_mul_ps(wb, a2));
+		__m256 y = _mm256_add_ps(_mm256_add_ps(_mm256_mul_ps(wr, b0),
+			_mm256_mul_ps(wg, b1)), _mm256_mul_ps(wb, b2));
+		accumulate(window, x);
+		accumulate(window + 8, y);
+		accumulate(window + 16, _mm256_mul_ps(x, x));
+		accumulate(window + 24, _mm256_mul_ps(y, y));
+		accumulate(window + 32, _mm256_mul_ps(x, y));
+	}
+	_mm256_storeu_ps(squares, sr);
+	_mm256_storeu_ps(squares + 8, sg);
+	_mm256_storeu_ps(squares + 16, sb);
+	_mm256_storeu_ps(squares + 24, sa);
+
+	__m128 l = _mm_max_ps(_mm256_castps256_ps128(largest),
+		_mm256_extractf128_ps(largest, 1));
+	l = _mm_max_ps(l, _mm_movehl_ps(l, l));
+	l = _mm_max_ss(l, _mm_shuffle_ps(l, l, 1));
+	float rest = comparePortable(n - i, a + 4 * i, b + 4 * i, weights,
+		error + i, squares, window);
+	return std::max(_mm_cvtss_f32(l), rest);
+}
+
+#undef AVX2
+
+///////////////////////////////////////////////////////////////////////////////
+// Kernel tables, indexed by level and by kernelIndex().  The compiler
+//	vectorizes the portable code well enough for the cases that SSE2
+//	can't shuffle cheaply (RGB and BGR), so those are left to it.
+//	Packing is vectorized for RGB and RGBA only.
+///////////////////////////////////////////////////////////////////////////////
+enum {				// Component order, for each type
+	inRGB, inBGR, inRGBA, inBGRA, inABGR, inARGB,
+	orders
+};
+
+#define GLEAN_RGB_KERNELS(kernel, component)				\
+	kernel<component, 3, rgbaOrder>, kernel<component, 3, bgraOrder>
+#define GLEAN_RGBA_KERNELS(kernel, component)				\
+	kernel<component, 4, rgbaOrder>, kernel<component, 4, bgraOrder>, \
+	kernel<component, 4, abgrOrder>, kernel<component, 4, argbOrder>
+
+DoubleUnpacker* const doubleUnpackers[2][3 * orders] = {
+	{ 0, 0, GLEAN_RGBA_KERNELS(unpackDoubleSSE2, GLubyte),
+	  0, 0, GLEAN_RGBA_KERNELS(unpackDoubleSSE2, GLushort),
+	  0, 0, GLEAN_RGBA_KERNELS(unpackDoubleSSE2, GLfloat) },
+	{ GLEAN_RGB_KERNELS(unpackDoubleAVX2, GLubyte),
+	  GLEAN_RGBA_KERNELS(unpackDoubleAVX2, GLubyte),
+	  GLEAN_RGB_KERNELS(unpackDoubleAVX2, GLushort),
+	  GLEAN_RGBA_KERNELS(unpackDoubleAVX2, GLushort),
+	  GLEAN_RGB_KERNELS(unpackDoubleAVX2, GLfloat),
+	  GLEAN_RGBA_KERNELS(unpackDoubleAVX2, GLfloat) }
+};
+FloatUnpacker* const floatUnpackers[2][3 * orders] = {
+	{ 0, 0, GLEAN_RGBA_KERNELS(unpackFloatSSE2, GLubyte),
+	  0, 0, GLEAN_RGBA_KERNELS(unpackFloatSSE2, GLushort),
+	  0, 0, GLEAN_RGBA_KERNELS(unpackFloatSSE2, GLfloat) },
+	{ GLEAN_RGB_KERNELS(unpackFloatAVX2, GLubyte),
+	  GLEAN_RGBA_KERNELS(unpackFloatAVX2, GLubyte),
+	  GLEAN_RGB_KERNELS(unpackFloatAVX2, GLushort),
+	  GLEAN_RGBA_KERNELS(unpackFloatAVX2, GLushort),
+	  GLEAN_RGB_KERNELS(unpackFloatAVX2, GLfloat),
+	  GLEAN_RGBA_KERNELS(unpackFloatAVX2, GLfloat) }
+};
+
+#undef GLEAN_RGB_KERNELS
+#undef GLEAN_RGBA_KERNELS
+
+DoublePacker* const packers[2][3] = {
+	{ packSSE2<GLubyte>, packSSE2<GLushort>, packSSE2<GLfloat> },
+	{ packAVX2<GLubyte>, packAVX2<GLushort>, packAVX2<GLfloat> }
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// kernelIndex:  find the kernels for a format and type.  Sets t to the
+//	component type (0 for unsigned bytes, 1 for unsigned shorts, 2 for
+//	floats) and o to the component order, and returns orders * t + o;
+//	or returns -1 if there are none.  x86 is little-endian, so the
+//	GL_UNSIGNED_INT_8_8_8_8 types are just bytes in some order.
+///////////////////////////////////////////////////////////////////////////////
+int
+kernelIndex(GLenum format, GLenum type, int& t, int& o) {
+	switch (type) {
+	case GL_UNSIGNED_BYTE:
+		t = 0;
+		break;
+	case GL_UNSIGNED_SHORT:
+		t = 1;
+		break;
+	case GL_FLOAT:
+		t = 2;
+		break;
+	case GL_UNSIGNED_INT_8_8_8_8_REV:
+		// First component in the first byte:
+		if (format == GL_RGB || format == GL_BGR)
+			return -1;
+		t = 0;
+		break;
+	case GL_UNSIGNED_INT_8_8_8_8:
+		// First component in the last byte:
+		t = 0;
+		switch (format) {
+		case GL_RGBA:
+			o = inABGR;
+			return o;
+		case GL_BGRA:
+			o = inARGB;
+			return o;
+		case GL_ABGR_EXT:
+			o = inRGBA;
+			return o;
+		default:
+			return -1;
+		}
+	default:
+		return -1;
+	}
+	switch (format) {
+	case GL_RGB:
+		o = inRGB;
+		break;
+	case GL_BGR:
+		o = inBGR;
+		break;
+	case GL_RGBA:
+		o = inRGBA;
+		break;
+	case GL_BGRA:
+		o = inBGRA;
+		break;
+	case GL_ABGR_EXT:
+		o = inABGR;
+		break;
+	default:
+		return -1;
+	}
+	return orders * t + o;
+}
+
+Level
+bestLevel() {
+	__builtin_cpu_init();
+	return __builtin_cpu_supports("avx2")? avx2: sse2;
+}
+
+Level&
+currentLevel() {
+	static Level l = bestLevel();
+	return l;
+}
+
+} // anonymous namespace
+
+Level
+level() {
+	return currentLevel();
+}
+
+Level
+setLevel(Level l) {
+	Level best = bestLevel();
+	return currentLevel() = (l < best)? l: best;
+}
+
+DoubleUnpacker*
+unpacker(GLenum format, GLenum type) {
+	int t, o;
+	int i = kernelIndex(format, type, t, o);
+	if (i < 0 || level() == none)
+		return 0;
+	return doubleUnpackers[level() - sse2][i];
+}
+
+FloatUnpacker*
+floatUnpacker(GLenum format, GLenum type) {
+	int t, o;
+	int i = kernelIndex(format, type, t, o);
+	if (i < 0 || level() == none)
+		return 0;
+	return floatUnpackers[level() - sse2][i];
+}
+
+DoublePacker*
+packer(GLenum format, GLenum type) {
+	int t, o;
+	int i = kernelIndex(format, type, t, o);
+	if (i < 0 || o != inRGBA || level() == none)
+		return 0;
+	// Packed types round and clamp (see pack.cpp); these kernels don't.
+	if (type == GL_UNSIGNED_INT_8_8_8_8
+	 || type == GL_UNSIGNED_INT_8_8_8_8_REV)
+		return 0;
+	return packers[level() - sse2][t];
+}
+
+double
+sad(GLsizei n, const GLubyte* a, const GLubyte* b) {
+	switch (level()) {
+	case avx2:
+		return sadAVX2(n, a, b);
+	case sse2:
+		return sadSSE2(n, a, b);
+	default:
+		return sadPortable(n, a, b);
+	}
+}
+
+double
+sad(GLsizei n, const GLushort* a, const GLushort* b) {
+	switch (level()) {
+	case avx2:
+		return sadAVX2(n, a, b);
+	case sse2:
+		return sadSSE2(n, a, b);
+	default:
+		return sadPortable(n, a, b);
+	}
+}
+
+GLsizei
+exceeds(GLsizei n, const float* a, const float* b, float threshold,
+    GLubyte* mask, float* maxError) {
+	switch (level()) {
+	case avx2:
+		return exceedsAVX2(n, a, b, threshold, mask, maxError);
+	case sse2:
+		return exceedsSSE2(n, a, b, threshold, mask, maxError);
+	default:
+		return exceedsPortable(n, a, b, threshold, mask, maxError);
+	}
+}
+
+float
+compare(GLsizei n, const float* a, const float* b, const float* weights,
+    float* error, float* squares, float* window) {
+	switch (level()) {
+	case avx2:
+		return compareAVX2(n, a, b, weights, error, squares, window);
+	case sse2:
+		return compareSSE2(n, a, b, weights, error, squares, window);
+	default:
+		return comparePortable(n, a, b, weights, error, squares,
+			window);
+	}
+}
+
+#else // !GLEAN_SIMD_X86
+
+Level
+level() {
+	return none;
+}
+
+Level
+setLevel(Level) {
+	return none;
+}
+
+DoubleUnpacker*
+unpacker(GLenum, GLenum) {
+	return 0;
+}
+
+FloatUnpacker*
+floatUnpacker(GLenum, GLenum) {
+	return 0;
+}
+
+DoublePacker*
+packer(GLenum, GLenum) {
+	return 0;
+}
+
+double
+sad(GLsizei n, const GLubyte* a, const GLubyte* b) {
+	return sadPortable(n, a, b);
+}
+
+double
+sad(GLsizei n, const GLushort* a, const GLushort* b) {
+	return sadPortable(n, a, b);
+}
+
+GLsizei
+exceeds(GLsizei n, const float* a, const float* b, float threshold,
+    GLubyte* mask, float* maxError) {
+	return exceedsPortable(n, a, b, threshold, mask, maxError);
+}
+
+float
+compare(GLsizei n, const float* a, const float* b, const float* weights,
+    float* error, float* squares, float* window) {
+	return comparePortable(n, a, b, weights, error, squares, window);
+}
+
+#endif // GLEAN_SIMD_X86
+
+} // namespace SIMD
+
+} // namespace GLEAN
@@ -0,0 +1,120 @@
+// BEGIN_COPYRIGHT
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+
+
+
+// simd.h:  vectorized pixel packing, unpacking, and differencing
+// (private to the image library)
+
+// Image::unpack() and Image::pack() are on the path of every image
+// comparison, so the common cases (GL_RGB and GL_RGBA images of
+// GL_UNSIGNED_BYTE, GL_UNSIGNED_SHORT or GL_FLOAT) have SSE2 and AVX2
+// versions.  Unpacking also handles the BGR, BGRA, and ABGR orders with
+// a shuffle, and GL_UNSIGNED_INT_8_8_8_8 and its _REV as bytes.  The
+// instruction set is chosen at run time; other formats and types, and
+// other processors and compilers, use the portable code in pack.cpp
+// and unpack.cpp.
+//
+// The vector code produces exactly the same values as the portable
+// code.  Integer components are converted exactly, and then scaled by
+// the same constant the portable code uses, in the same precision.
+//
+// Image::reg() searches for the best alignment of two images by summing
+// absolute differences of raw 8- or 16-bit components, Image::diff()
+// tests unpacked pixels against a threshold, and Image::compare()
+// gathers error statistics; those are here too.
+
+
+#ifndef __simd_h__
+#define __simd_h__
+
+#include "glwrap.h"
+
+namespace GLEAN {
+
+namespace SIMD {
+
+enum Level {
+	none,			// Portable code only
+	sse2,
+	avx2
+};
+
+Level level();			// Level in use; initially the best the
+				// processor supports
+Level setLevel(Level l);	// Use at most the given level (e.g. to
+				// compare against the portable code).
+				// Returns the level actually set.  Images
+				// that have already chosen their packers
+				// keep them until their format or type
+				// changes.
+
+typedef void DoubleUnpacker(GLsizei n, double* rgba, const char* nextPixel);
+typedef void FloatUnpacker(GLsizei n, float* rgba, const char* nextPixel);
+typedef void DoublePacker(GLsizei n, char* nextPixel, double* rgba);
+
+// Vectorized utilities for the given format and type at the current
+// level, or null if there are none:
+DoubleUnpacker* unpacker(GLenum format, GLenum type);
+FloatUnpacker* floatUnpacker(GLenum format, GLenum type);
+DoublePacker* packer(GLenum format, GLenum type);
+
+// Sum of the absolute differences of n components of a and b.  The
+// result is an exact integer (for any n an image can have).
+double sad(GLsizei n, const GLubyte* a, const GLubyte* b);
+double sad(GLsizei n, const GLushort* a, const GLushort* b);
+
+// Threshold test for n RGBA pixels:  returns the number of pixels at
+// which any component of a and b differs by more than threshold, sets
+// mask[i] to 255 for each of those and to 0 for the others, and raises
+// maxError[0..3] to the largest absolute difference in R, G, B, and A.
+// Differences involving NaN are ignored.
+GLsizei exceeds(GLsizei n, const float* a, const float* b, float threshold,
+	GLubyte* mask, float* maxError);
+
+// Comparison metrics for n RGBA pixels, taken 8 at a time in windows,
+// with pixel j in column j % 8 of window j / 8.  Sets error[j] to the
+// largest absolute difference between the components of pixel j of a
+// and b, and returns the largest error[j].  Adds the squared differences
+// in R, G, B, and A to squares[c], squares[8 + c], squares[16 + c], and
+// squares[24 + c], where c is the pixel's column.  For SSIM, with x and
+// y the luminances (weights[0] * R + weights[1] * G + weights[2] * B) of
+// the pixels of a and b, adds x, y, x * x, y * y, and x * y to window[s
+// + c], window[s + 8 + c], and so on, where s = 40 * (j / 8).  Keeping
+// the sums by column lets every instruction set form them in the same
+// order, so they're the same everywhere.  Differences involving NaN
+// count as 0.
+float compare(GLsizei n, const float* a, const float* b, const float* weights,
+	float* error, float* squares, float* window);
+
+} // namespace SIMD
+
+} // namespace GLEAN
+
+#endif // __simd_h__
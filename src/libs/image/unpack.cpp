@@ -38,41 +38,46 @@
 // declarations.
 
 #include "image.h"
+#include "packed.h"
+#include "simd.h"
 
 namespace {
 
-#define SCALE (static_cast<double>(num) / static_cast<double>(denom))
-#define BIAS (static_cast<double>(bias) / static_cast<double>(denom))
+// The scale and bias are computed in double precision, then rounded to
+// the precision of the result (``real''), so that the vectorized code
+// in simd.cpp can match them exactly.
+#define SCALE static_cast<real>(static_cast<double>(num) / static_cast<double>(denom))
+#define BIAS static_cast<real>(static_cast<double>(bias) / static_cast<double>(denom))
 
 // See comments in pack.cpp concerning this workaround for a VC6 problem.
 
-template<class component, int num, unsigned int denom, int bias>
+template<class component, int num, unsigned int denom, int bias, class real>
 class Unpack
 {
 public :
 	// unpack_l
-	static void unpack_l(GLsizei n, double* rgba, char* src) 
+	static void unpack_l(GLsizei n, real* rgba, const char* src) 
 	{
-		component* in = reinterpret_cast<component*>(src);
+		const component* in = reinterpret_cast<const component*>(src);
 			// XXX It seems to me that static_cast should be sufficient,
 			// but egcs 1.1.2 thinks otherwise.
 
-		double* end = rgba + 4 * n;
+		real* end = rgba + 4 * n;
 		for (; rgba != end; rgba += 4) {
 			if (bias)
 				rgba[0] = SCALE * in[0] + BIAS;
 			else
 				rgba[0] = SCALE * in[0];
-			rgba[1] = rgba[2] = rgba[3] = 0.0;
+			rgba[1] = rgba[2] = rgba[3] = 0;
 			in += 1;
 		}
 	}
 
 	// unpack_la
-	static void unpack_la(GLsizei n, double* rgba, char* src) 
+	static void unpack_la(GLsizei n, real* rgba, const char* src) 
 	{
-		component* in = reinterpret_cast<component*>(src);
-		double* end = rgba + 4 * n;
+		const component* in = reinterpret_cast<const component*>(src);
+		real* end = rgba + 4 * n;
 		for (; rgba != end; rgba += 4) {
 			if (bias) {
 				rgba[0] = SCALE * in[0] + BIAS;
@@ -81,16 +86,16 @@ public :
 				rgba[0] = SCALE * in[0];
 				rgba[3] = SCALE * in[1];
 			}
-			rgba[1] = rgba[2] = 0.0;
+			rgba[1] = rgba[2] = 0;
 			in += 2;
 		}
 	}
 
 	// unpack_rgb
-	static void unpack_rgb(GLsizei n, double* rgba, char* src) 
+	static void unpack_rgb(GLsizei n, real* rgba, const char* src) 
 	{
-		component* in = reinterpret_cast<component*>(src);
-		double* end = rgba + 4 * n;
+		const component* in = reinterpret_cast<const component*>(src);
+		real* end = rgba + 4 * n;
 		for (; rgba != end; rgba += 4) {
 			if (bias) {
 				rgba[0] = SCALE * in[0] + BIAS;
@@ -101,16 +106,16 @@ public :
 				rgba[1] = SCALE * in[1];
 				rgba[2] = SCALE * in[2];
 			}
-			rgba[3] = 0.0;
+			rgba[3] = 0;
 			in += 3;
 		}
 	}
 
 	// unpack_rgba
-	static void unpack_rgba(GLsizei n, double* rgba, char* src) 
+	static void unpack_rgba(GLsizei n, real* rgba, const char* src) 
 	{
-		component* in = reinterpret_cast<component*>(src);
-		double* end = rgba + 4 * n;
+		const component* in = reinterpret_cast<const component*>(src);
+		real* end = rgba + 4 * n;
 		for (; rgba != end; rgba += 4) {
 			if (bias) {
 				rgba[0] = SCALE * in[0] + BIAS;
@@ -127,11 +132,330 @@ public :
 		}
 	}
 
+	// unpack_bgr
+	static void unpack_bgr(GLsizei n, real* rgba, const char* src) 
+	{
+		const component* in = reinterpret_cast<const component*>(src);
+		real* end = rgba + 4 * n;
+		for (; rgba != end; rgba += 4) {
+			if (bias) {
+				rgba[0] = SCALE * in[2] + BIAS;
+				rgba[1] = SCALE * in[1] + BIAS;
+				rgba[2] = SCALE * in[0] + BIAS;
+			} else {
+				rgba[0] = SCALE * in[2];
+				rgba[1] = SCALE * in[1];
+				rgba[2] = SCALE * in[0];
+			}
+			rgba[3] = 0;
+			in += 3;
+		}
+	}
+
+	// unpack_bgra
+	static void unpack_bgra(GLsizei n, real* rgba, const char* src) 
+	{
+		const component* in = reinterpret_cast<const component*>(src);
+		real* end = rgba + 4 * n;
+		for (; rgba != end; rgba += 4) {
+			if (bias) {
+				rgba[0] = SCALE * in[2] + BIAS;
+				rgba[1] = SCALE * in[1] + BIAS;
+				rgba[2] = SCALE * in[0] + BIAS;
+				rgba[3] = SCALE * in[3] + BIAS;
+			} else {
+				rgba[0] = SCALE * in[2];
+				rgba[1] = SCALE * in[1];
+				rgba[2] = SCALE * in[0];
+				rgba[3] = SCALE * in[3];
+			}
+			in += 4;
+		}
+	}
+
+	// unpack_abgr
+	static void unpack_abgr(GLsizei n, real* rgba, const char* src) 
+	{
+		const component* in = reinterpret_cast<const component*>(src);
+		real* end = rgba + 4 * n;
+		for (; rgba != end; rgba += 4) {
+			if (bias) {
+				rgba[0] = SCALE * in[3] + BIAS;
+				rgba[1] = SCALE * in[2] + BIAS;
+				rgba[2] = SCALE * in[1] + BIAS;
+				rgba[3] = SCALE * in[0] + BIAS;
+			} else {
+				rgba[0] = SCALE * in[3];
+				rgba[1] = SCALE * in[2];
+				rgba[2] = SCALE * in[1];
+				rgba[3] = SCALE * in[0];
+			}
+			in += 4;
+		}
+	}
+
 };	// class Unpack
 
+// Component values for fields of 1 to 10 bits:  table(b)[v] is the value
+// of the b-bit field v, scaled as SCALE scales the basic types, so an
+// 8-bit field unpacks exactly as a GL_UNSIGNED_BYTE component does.
+// Looking the fields up saves converting and scaling each one.
+
+template<class real>
+class Levels
+{
+public :
+	enum { maxBits = 10 };
+
+	static const real* table(int bits)
+	{
+		static const Levels levels;
+		return levels.tables[bits];
+	}
+
+private :
+	real values[(2 << maxBits) - 2];
+	real* tables[maxBits + 1];
+
+	Levels()
+	{
+		real* t = values;
+		tables[0] = 0;
+		for (int bits = 1; bits <= maxBits; ++bits) {
+			GLuint max = (1U << bits) - 1;
+			real scale = static_cast<real>(1.0 / max);
+			tables[bits] = t;
+			for (GLuint v = 0; v <= max; ++v)
+				*t++ = scale * static_cast<real>(v);
+		}
+	}
+};	// class Levels
+
+// Unpack a packed type, with component i (in format order) going to
+// channel ci of the result:
+
+template<class L, int c0, int c1, int c2, int c3, class real>
+class UnpackPacked
+{
+public :
+	static void unpack(GLsizei n, real* rgba, const char* src) 
+	{
+		const typename L::Word* in =
+			reinterpret_cast<const typename L::Word*>(src);
+		const real* t0 = Levels<real>::table(L::bits0);
+		const real* t1 = Levels<real>::table(L::bits1);
+		const real* t2 = Levels<real>::table(L::bits2);
+		const real* t3 = Levels<real>::table(L::bits3);
+		const GLuint m0 = (1U << L::bits0) - 1;
+		const GLuint m1 = (1U << L::bits1) - 1;
+		const GLuint m2 = (1U << L::bits2) - 1;
+		const GLuint m3 = (1U << L::bits3) - 1;
+
+		real* end = rgba + 4 * n;
+		for (; rgba != end; rgba += 4) {
+			GLuint w = *in++;
+			rgba[c0] = t0[(w >> L::shift0) & m0];
+			rgba[c1] = t1[(w >> L::shift1) & m1];
+			rgba[c2] = t2[(w >> L::shift2) & m2];
+			if (L::components == 4)
+				rgba[c3] = t3[(w >> L::shift3) & m3];
+			else
+				rgba[3] = 0;
+		}
+	}
+};	// class UnpackPacked
+
+// Select the unpacker for a packed type's layout (see packed.h) and a
+// format with the right number of components:
+
+template<class real>
+class PackedUnpackers
+{
+public :
+	typedef void Unpacker(GLsizei n, real* rgba, const char* nextPixel);
+
+	GLenum format;
+	Unpacker* unpacker;
+
+	PackedUnpackers(GLenum f): format(f), unpacker(0) { }
+
+	template<class L> void visit()
+	{
+		if (L::components == 3) {
+			if (format == GL_RGB)
+				unpacker = UnpackPacked<L, 0, 1, 2, 3, real>::unpack;
+			else if (format == GL_BGR)
+				unpacker = UnpackPacked<L, 2, 1, 0, 3, real>::unpack;
+		} else {
+			if (format == GL_RGBA)
+				unpacker = UnpackPacked<L, 0, 1, 2, 3, real>::unpack;
+			else if (format == GL_BGRA)
+				unpacker = UnpackPacked<L, 2, 1, 0, 3, real>::unpack;
+			else if (format == GL_ABGR_EXT)
+				unpacker = UnpackPacked<L, 3, 2, 1, 0, real>::unpack;
+		}
+		if (!unpacker)
+			throw GLEAN::Image::BadFormat(format);
+	}
+};	// class PackedUnpackers
+
 #undef SCALE
 #undef BIAS
 
+// Select the unpacking utility for a format and type, producing
+// components of the given precision:
+template<class real>
+class Unpackers
+{
+public :
+	typedef void Unpacker(GLsizei n, real* rgba, const char* nextPixel);
+
+	static Unpacker* select(GLenum format, GLenum type)
+	{
+		PackedUnpackers<real> packed(format);
+		if (GLEAN::Packed::forType(type, packed))
+			return packed.unpacker;
+
+		switch (format) {
+		case GL_LUMINANCE:
+			switch (type) {
+			case GL_BYTE:
+				return Unpack<GLbyte, 2, 255, 1, real>::unpack_l;
+			case GL_UNSIGNED_BYTE:
+				return Unpack<GLubyte, 1, 255, 0, real>::unpack_l;
+			case GL_SHORT:
+				return Unpack<GLshort, 2, 65535, 1, real>::unpack_l;
+			case GL_UNSIGNED_SHORT:
+				return Unpack<GLushort, 1, 65535, 0, real>::unpack_l;
+			case GL_INT:
+				return Unpack<GLint, 2, 4294967295U, 1, real>::unpack_l;
+			case GL_UNSIGNED_INT:
+				return Unpack<GLuint, 1, 4294967295U, 0, real>::unpack_l;
+			case GL_FLOAT:
+				return Unpack<GLfloat, 1, 1, 0, real>::unpack_l;
+			default:
+				throw GLEAN::Image::BadType(type);
+			}
+		case GL_LUMINANCE_ALPHA:
+			switch (type) {
+			case GL_BYTE:
+				return Unpack<GLbyte, 2, 255, 1, real>::unpack_la;
+			case GL_UNSIGNED_BYTE:
+				return Unpack<GLubyte, 1, 255, 0, real>::unpack_la;
+			case GL_SHORT:
+				return Unpack<GLshort, 2, 65535, 1, real>::unpack_la;
+			case GL_UNSIGNED_SHORT:
+				return Unpack<GLushort, 1, 65535, 0, real>::unpack_la;
+			case GL_INT:
+				return Unpack<GLint, 2, 4294967295U, 1, real>::unpack_la;
+			case GL_UNSIGNED_INT:
+				return Unpack<GLuint, 2, 4294967295U, 0, real>::unpack_la;
+			case GL_FLOAT:
+				return Unpack<GLfloat, 1, 1, 0, real>::unpack_la;
+			default:
+				throw GLEAN::Image::BadType(type);
+			}
+		case GL_RGB:
+			switch (type) {
+			case GL_BYTE:
+				return Unpack<GLbyte, 2, 255, 1, real>::unpack_rgb;
+			case GL_UNSIGNED_BYTE:
+				return Unpack<GLubyte, 1, 255, 0, real>::unpack_rgb;
+			case GL_SHORT:
+				return Unpack<GLshort, 2, 65535, 1, real>::unpack_rgb;
+			case GL_UNSIGNED_SHORT:
+				return Unpack<GLushort, 1, 65535, 0, real>::unpack_rgb;
+			case GL_INT:
+				return Unpack<GLint, 2, 4294967295U, 1, real>::unpack_rgb;
+			case GL_UNSIGNED_INT:
+				return Unpack<GLuint, 1, 4294967295U, 0, real>::unpack_rgb;
+			case GL_FLOAT:
+				return Unpack<GLfloat, 1, 1, 0, real>::unpack_rgb;
+			default:
+				throw GLEAN::Image::BadType(type);
+			}
+		case GL_RGBA:
+			switch (type) {
+			case GL_BYTE:
+				return Unpack<GLbyte, 2, 255, 1, real>::unpack_rgba;
+			case GL_UNSIGNED_BYTE:
+				return Unpack<GLubyte, 1, 255, 0, real>::unpack_rgba;
+			case GL_SHORT:
+				return Unpack<GLshort, 2, 65535, 1, real>::unpack_rgba;
+			case GL_UNSIGNED_SHORT:
+				return Unpack<GLushort, 1, 65535, 0, real>::unpack_rgba;
+			case GL_INT:
+				return Unpack<GLint, 2, 4294967295U, 1, real>::unpack_rgba;
+			case GL_UNSIGNED_INT:
+				return Unpack<GLuint, 1, 4294967295U, 0, real>::unpack_rgba;
+			case GL_FLOAT:
+				return Unpack<GLfloat, 1, 1, 0, real>::unpack_rgba;
+			default:
+				throw GLEAN::Image::BadType(type);
+			}
+		case GL_BGR:
+			switch (type) {
+			case GL_BYTE:
+				return Unpack<GLbyte, 2, 255, 1, real>::unpack_bgr;
+			case GL_UNSIGNED_BYTE:
+				return Unpack<GLubyte, 1, 255, 0, real>::unpack_bgr;
+			case GL_SHORT:
+				return Unpack<GLshort, 2, 65535, 1, real>::unpack_bgr;
+			case GL_UNSIGNED_SHORT:
+				return Unpack<GLushort, 1, 65535, 0, real>::unpack_bgr;
+			case GL_INT:
+				return Unpack<GLint, 2, 4294967295U, 1, real>::unpack_bgr;
+			case GL_UNSIGNED_INT:
+				return Unpack<GLuint, 1, 4294967295U, 0, real>::unpack_bgr;
+			case GL_FLOAT:
+				return Unpack<GLfloat, 1, 1, 0, real>::unpack_bgr;
+			default:
+				throw GLEAN::Image::BadType(type);
+			}
+		case GL_BGRA:
+			switch (type) {
+			case GL_BYTE:
+				return Unpack<GLbyte, 2, 255, 1, real>::unpack_bgra;
+			case GL_UNSIGNED_BYTE:
+				return Unpack<GLubyte, 1, 255, 0, real>::unpack_bgra;
+			case GL_SHORT:
+				return Unpack<GLshort, 2, 65535, 1, real>::unpack_bgra;
+			case GL_UNSIGNED_SHORT:
+				return Unpack<GLushort, 1, 65535, 0, real>::unpack_bgra;
+			case GL_INT:
+				return Unpack<GLint, 2, 4294967295U, 1, real>::unpack_bgra;
+			case GL_UNSIGNED_INT:
+				return Unpack<GLuint, 1, 4294967295U, 0, real>::unpack_bgra;
+			case GL_FLOAT:
+				return Unpack<GLfloat, 1, 1, 0, real>::unpack_bgra;
+			default:
+				throw GLEAN::Image::BadType(type);
+			}
+		case GL_ABGR_EXT:
+			switch (type) {
+			case GL_BYTE:
+				return Unpack<GLbyte, 2, 255, 1, real>::unpack_abgr;
+			case GL_UNSIGNED_BYTE:
+				return Unpack<GLubyte, 1, 255, 0, real>::unpack_abgr;
+			case GL_SHORT:
+				return Unpack<GLshort, 2, 65535, 1, real>::unpack_abgr;
+			case GL_UNSIGNED_SHORT:
+				return Unpack<GLushort, 1, 65535, 0, real>::unpack_abgr;
+			case GL_INT:
+				return Unpack<GLint, 2, 4294967295U, 1, real>::unpack_abgr;
+			case GL_UNSIGNED_INT:
+				return Unpack<GLuint, 1, 4294967295U, 0, real>::unpack_abgr;
+			case GL_FLOAT:
+				return Unpack<GLfloat, 1, 1, 0, real>::unpack_abgr;
+			default:
+				throw GLEAN::Image::BadType(type);
+			}
+		default:
+			throw GLEAN::Image::BadFormat(format);
+		}
+	}
+};	// class Unpackers
+
 }; // anonymous namespace
 
 
@@ -141,131 +465,36 @@ namespace GLEAN {
 // Public interface
 ///////////////////////////////////////////////////////////////////////////////
 void
-Image::unpack(GLsizei n, double* rgba, char* nextPixel) {
+Image::unpack(GLsizei n, double* rgba, const char* nextPixel) {
 	(*(valid(vbUnpacker)? _unpacker: validateUnpacker()))
 		(n, rgba, nextPixel);
 }
 
+void
+Image::unpack(GLsizei n, float* rgba, const char* nextPixel) {
+	(*(valid(vbFloatUnpacker)? _floatUnpacker: validateFloatUnpacker()))
+		(n, rgba, nextPixel);
+}
+
 ///////////////////////////////////////////////////////////////////////////////
 // validateUnpacker - select appropriate pixel-unpacking utility
 ///////////////////////////////////////////////////////////////////////////////
 Image::Unpacker*
 Image::validateUnpacker() {
-	switch (format()) {
-	case GL_LUMINANCE:
-		switch (type()) {
-		case GL_BYTE:
-			_unpacker = Unpack<GLbyte, 2, 255, 1>::unpack_l;
-			break;
-		case GL_UNSIGNED_BYTE:
-			_unpacker = Unpack<GLubyte, 1, 255, 0>::unpack_l;
-			break;
-		case GL_SHORT:
-			_unpacker = Unpack<GLshort, 2, 65535, 1>::unpack_l;
-			break;
-		case GL_UNSIGNED_SHORT:
-			_unpacker = Unpack<GLushort, 1, 65535, 0>::unpack_l;
-			break;
-		case GL_INT:
-			_unpacker = Unpack<GLint, 2, 4294967295U, 1>::unpack_l;
-			break;
-		case GL_UNSIGNED_INT:
-			_unpacker = Unpack<GLuint, 1, 4294967295U, 0>::unpack_l;
-			break;
-		case GL_FLOAT:
-			_unpacker = Unpack<GLfloat, 1, 1, 0>::unpack_l;
-			break;
-		default:
-			throw BadType(type());
-		}
-		break;
-	case GL_LUMINANCE_ALPHA:
-		switch (type()) {
-		case GL_BYTE:
-			_unpacker = Unpack<GLbyte, 2, 255, 1>::unpack_la;
-			break;
-		case GL_UNSIGNED_BYTE:
-			_unpacker = Unpack<GLubyte, 1, 255, 0>::unpack_la;
-			break;
-		case GL_SHORT:
-			_unpacker = Unpack<GLshort, 2, 65535, 1>::unpack_la;
-			break;
-		case GL_UNSIGNED_SHORT:
-			_unpacker = Unpack<GLushort, 1, 65535, 0>::unpack_la;
-			break;
-		case GL_INT:
-			_unpacker = Unpack<GLint, 2, 4294967295U, 1>::unpack_la;
-			break;
-		case GL_UNSIGNED_INT:
-			_unpacker = Unpack<GLuint, 2, 4294967295U, 0>::unpack_la;
-			break;
-		case GL_FLOAT:
-			_unpacker = Unpack<GLfloat, 1, 1, 0>::unpack_la;
-			break;
-		default:
-			throw BadType(type());
-		}
-		break;
-	case GL_RGB:
-		switch (type()) {
-		case GL_BYTE:
-			_unpacker = Unpack<GLbyte, 2, 255, 1>::unpack_rgb;
-			break;
-		case GL_UNSIGNED_BYTE:
-			_unpacker = Unpack<GLubyte, 1, 255, 0>::unpack_rgb;
-			break;
-		case GL_SHORT:
-			_unpacker = Unpack<GLshort, 2, 65535, 1>::unpack_rgb;
-			break;
-		case GL_UNSIGNED_SHORT:
-			_unpacker = Unpack<GLushort, 1, 65535, 0>::unpack_rgb;
-			break;
-		case GL_INT:
-			_unpacker = Unpack<GLint, 2, 4294967295U, 1>::unpack_rgb;
-			break;
-		case GL_UNSIGNED_INT:
-			_unpacker = Unpack<GLuint, 1, 4294967295U, 0>::unpack_rgb;
-			break;
-		case GL_FLOAT:
-			_unpacker = Unpack<GLfloat, 1, 1, 0>::unpack_rgb;
-			break;
-		default:
-			throw BadType(type());
-		}
-		break;
-	case GL_RGBA:
-		switch (type()) {
-		case GL_BYTE:
-			_unpacker = Unpack<GLbyte, 2, 255, 1>::unpack_rgba;
-			break;
-		case GL_UNSIGNED_BYTE:
-			_unpacker = Unpack<GLubyte, 1, 255, 0>::unpack_rgba;
-			break;
-		case GL_SHORT:
-			_unpacker = Unpack<GLshort, 2, 65535, 1>::unpack_rgba;
-			break;
-		case GL_UNSIGNED_SHORT:
-			_unpacker = Unpack<GLushort, 1, 65535, 0>::unpack_rgba;
-			break;
-		case GL_INT:
-			_unpacker = Unpack<GLint, 2, 4294967295U, 1>::unpack_rgba;
-			break;
-		case GL_UNSIGNED_INT:
-			_unpacker = Unpack<GLuint, 1, 4294967295U, 0>::unpack_rgba;
-			break;
-		case GL_FLOAT:
-			_unpacker = Unpack<GLfloat, 1, 1, 0>::unpack_rgba;
-			break;
-		default:
-			throw BadType(type());
-		}
-		break;
-	default:
-		throw BadFormat(format());
-	}
-
+	_unpacker = SIMD::unpacker(format(), type());
+	if (!_unpacker)
+		_unpacker = Unpackers<double>::select(format(), type());
 	validate(vbUnpacker);
 	return _unpacker;
 }
 
+Image::FloatUnpacker*
+Image::validateFloatUnpacker() {
+	_floatUnpacker = SIMD::floatUnpacker(format(), type());
+	if (!_floatUnpacker)
+		_floatUnpacker = Unpackers<float>::select(format(), type());
+	validate(vbFloatUnpacker);
+	return _floatUnpacker;
+}
+
 }; // namespace GLEAN
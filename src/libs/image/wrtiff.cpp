@@ -32,17 +32,60 @@
 // Implementation of image data, attribute, and I/O
 
 #include "image.h"
+#include "bands.h"
 #include "tiffio.h"
+#include <string.h>
+#include <vector>
 
 namespace GLEAN {
 
+namespace {
+
+Image::TIFFCompression compression = Image::tiffLZW;
+GLsizei tileSize = 0;
+
+uint16
+codec(Image::TIFFCompression c) {
+	switch (c) {
+	case Image::tiffLZW:
+		return COMPRESSION_LZW;
+	case Image::tiffDeflate:
+		return COMPRESSION_ADOBE_DEFLATE;
+	default:
+		return COMPRESSION_NONE;
+	}
+}
+
+} // anonymous namespace
+
 ///////////////////////////////////////////////////////////////////////////////
-// writeTIFF - write image to TIFF file
+// TIFF output options
 ///////////////////////////////////////////////////////////////////////////////
+bool
+Image::setTIFFCompression(TIFFCompression c) {
+	if (!TIFFIsCODECConfigured(codec(c)))
+		return false;
+	compression = c;
+	return true;
+} // Image::setTIFFCompression
+
+Image::TIFFCompression
+Image::getTIFFCompression() {
+	return compression;
+} // Image::getTIFFCompression
+
 void
-Image::writeTIFF(const char* filename) {
+Image::setTIFFTileSize(GLsizei size) {
+	tileSize = (size > 0)? (size + 15) & ~15: 0;
+} // Image::setTIFFTileSize
+
+///////////////////////////////////////////////////////////////////////////////
+// createTIFF - create a TIFF file for an image, and set everything but the
+//	layout (strips or tiles)
+///////////////////////////////////////////////////////////////////////////////
+TIFF*
+Image::createTIFF(const char* filename) {
 	static uint16 unassocAlpha[] = {EXTRASAMPLE_UNASSALPHA};
-	GLsizei rowStep = rowSizeInBytes();
 
 	TIFF* tf = TIFFOpen(filename, "w");
 	if (!tf)
@@ -55,10 +98,7 @@ Image::writeTIFF(const char* filename) {
 	TIFFSetField(tf, TIFFTAG_RESOLUTIONUNIT, RESUNIT_INCH);
 	TIFFSetField(tf, TIFFTAG_ORIENTATION, ORIENTATION_TOPLEFT);
 	TIFFSetField(tf, TIFFTAG_PLANARCONFIG, PLANARCONFIG_CONTIG);
-	TIFFSetField(tf, TIFFTAG_COMPRESSION, COMPRESSION_NONE);
-		// LZW would have been acceptable, were it not for patent
-		// issues.
-	TIFFSetField(tf, TIFFTAG_ROWSPERSTRIP, height());
+	TIFFSetField(tf, TIFFTAG_COMPRESSION, codec(compression));
 
 	switch (format()) {
 	case GL_LUMINANCE:
@@ -118,17 +158,149 @@ Image::writeTIFF(const char* filename) {
 		throw BadType(type());
 	}
 
-	{
-		// Write rows in reverse order, so that the usual OpenGL
-		// orientation won't result in an upside-down image for
-		// naive TIFF readers:
-		char* row = pixels() + (height() - 1) * rowStep;
-		for (GLsizei r = 0; r < height(); ++r, row -= rowStep)
-			TIFFWriteScanline(tf, row, r, 0);
+	// Differencing neighboring pixels first makes smooth images (most
+	// of ours) compress much better:
+	if (compression != tiffNone) {
+		switch (type()) {
+		case GL_BYTE:
+		case GL_UNSIGNED_BYTE:
+		case GL_SHORT:
+		case GL_UNSIGNED_SHORT:
+			TIFFSetField(tf, TIFFTAG_PREDICTOR,
+				PREDICTOR_HORIZONTAL);
+			break;
+		case GL_FLOAT:
+			TIFFSetField(tf, TIFFTAG_PREDICTOR,
+				PREDICTOR_FLOATINGPOINT);
+			break;
+		}
+	}
+
+	return tf;
+} // Image::createTIFF
+
+///////////////////////////////////////////////////////////////////////////////
+// writeTIFF - write image to TIFF file
+///////////////////////////////////////////////////////////////////////////////
+void
+Image::writeTIFF(const char* filename) {
+	TIFF* tf = createTIFF(filename);
+
+	// Write rows in reverse order, so that the usual OpenGL
+	// orientation won't result in an upside-down image for naive TIFF
+	// readers.  Whole strips or tiles are gathered in a buffer and
+	// written at once; the buffer is needed anyway, because the
+	// predictors work in place.
+	GLsizei pixelSize = pixelSizeInBytes();
+	GLsizei rowBytes = width() * pixelSize;
+	const char* lastRow = row(height() - 1);	// Works for mapped images too
+	GLsizei rowStep = rowStride();
+	if (tileSize == 0) {
+		// Strips of about 64KB:
+		GLsizei rowsPerStrip = rowBytes? 65536 / rowBytes: 1;
+		if (rowsPerStrip > height())
+			rowsPerStrip = height();
+		if (rowsPerStrip < 1)
+			rowsPerStrip = 1;
+		TIFFSetField(tf, TIFFTAG_ROWSPERSTRIP, rowsPerStrip);
+
+		std::vector<char> strip(rowsPerStrip * rowBytes + 1);
+		for (GLsizei y = 0; y < height(); y += rowsPerStrip) {
+			GLsizei n = height() - y;
+			if (n > rowsPerStrip)
+				n = rowsPerStrip;
+			for (GLsizei r = 0; r < n; ++r)
+				memcpy(&strip[r * rowBytes],
+					lastRow - (y + r) * rowStep, rowBytes);
+			if (TIFFWriteEncodedStrip(tf, y / rowsPerStrip,
+			    &strip[0], n * rowBytes) < 0) {
+				TIFFClose(tf);
+				throw CantOpen(filename);
+			}
+		}
+	} else {
+		TIFFSetField(tf, TIFFTAG_TILEWIDTH, tileSize);
+		TIFFSetField(tf, TIFFTAG_TILELENGTH, tileSize);
+
+		// Tiles hanging off the right or bottom edge are padded
+		// with zeros:
+		GLsizei tileRowBytes = tileSize * pixelSize;
+		std::vector<char> tile(tileSize * tileRowBytes);
+		for (GLsizei y = 0; y < height(); y += tileSize)
+			for (GLsizei x = 0; x < width(); x += tileSize) {
+				GLsizei rows = height() - y;
+				if (rows > tileSize)
+					rows = tileSize;
+				GLsizei cols = width() - x;
+				if (cols > tileSize)
+					cols = tileSize;
+				memset(&tile[0], 0, tile.size());
+				for (GLsizei r = 0; r < rows; ++r)
+					memcpy(&tile[r * tileRowBytes],
+						lastRow - (y + r) * rowStep
+							+ x * pixelSize,
+						cols * pixelSize);
+				if (TIFFWriteEncodedTile(tf,
+				    TIFFComputeTile(tf, x, y, 0, 0),
+				    &tile[0], tile.size()) < 0) {
+					TIFFClose(tf);
+					throw CantOpen(filename);
+				}
+			}
 	}
 
 	TIFFClose(tf);
 }; // Image::writeTIFF
 
+///////////////////////////////////////////////////////////////////////////////
+// TIFFBandWriter - write a TIFF file a band at a time (see bands.h)
+///////////////////////////////////////////////////////////////////////////////
+TIFFBandWriter::TIFFBandWriter(const std::string& filename):
+    _filename(filename), _tiff(0), _height(0), _rowsPerStrip(0) {
+} // TIFFBandWriter::TIFFBandWriter
+
+TIFFBandWriter::~TIFFBandWriter() {
+	if (_tiff)
+		TIFFClose(_tiff);
+} // TIFFBandWriter::~TIFFBandWriter
+
+void
+TIFFBandWriter::begin(Image& whole) {
+	_tiff = whole.createTIFF(_filename.c_str());
+	_height = whole.height();
+	_rowsPerStrip = 0;
+} // TIFFBandWriter::begin
+
+// The first band (the top one) sets the strip height, and each band is
+// a strip; as with writeTIFF(), the rows are reversed on the way out.
+void
+TIFFBandWriter::band(GLsizei y, Image& rows) {
+	if (!_tiff)
+		return;
+	GLsizei n = rows.height();
+	if (_rowsPerStrip == 0) {
+		_rowsPerStrip = n;
+		TIFFSetField(_tiff, TIFFTAG_ROWSPERSTRIP, n);
+	}
+	GLsizei rowBytes = rows.width() * rows.pixelSizeInBytes();
+	_strip.resize(static_cast<size_t>(n) * rowBytes + 1);
+	for (GLsizei r = 0; r < n; ++r)
+		memcpy(&_strip[r * rowBytes], rows.row(n - 1 - r), rowBytes);
+	if (TIFFWriteEncodedStrip(_tiff, (_height - y - n) / _rowsPerStrip,
+	    &_strip[0], n * rowBytes) < 0) {
+		TIFFClose(_tiff);
+		_tiff = 0;
+		throw Image::CantOpen(_filename.c_str());
+	}
+} // TIFFBandWriter::band
+
+void
+TIFFBandWriter::end() {
+	if (_tiff)
+		TIFFClose(_tiff);
+	_tiff = 0;
+	std::vector<char>().swap(_strip);
+} // TIFFBandWriter::end
+
 
 }; // namespace GLEAN
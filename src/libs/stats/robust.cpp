@@ -0,0 +1,167 @@
+// BEGIN_COPYRIGHT
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+
+
+
+// robust.cpp:  order statistics and bootstrap confidence intervals
+
+#include <algorithm>
+#include <cmath>
+#include "stats.h"
+#include "rand.h"
+
+namespace GLEAN {
+
+void
+RobustStats::init() {
+	_samples.clear();
+	_sorted.clear();
+	_sortedValid = true;
+}
+
+const std::vector<double>&
+RobustStats::sorted() const {
+	if (!_sortedValid) {
+		_sorted = _samples;
+		std::sort(_sorted.begin(), _sorted.end());
+		_sortedValid = true;
+	}
+	return _sorted;
+}
+
+namespace {
+
+// Percentile of an already-sorted vector, interpolating linearly between
+// the closest ranks:
+double
+sortedPercentile(const std::vector<double>& v, double p) {
+	if (v.empty())
+		return 0.0;
+	if (p <= 0.0)
+		return v.front();
+	if (p >= 100.0)
+		return v.back();
+	const double rank = p / 100.0 * (v.size() - 1);
+	const size_t i = static_cast<size_t>(rank);
+	const double frac = rank - i;
+	if (i + 1 >= v.size())
+		return v.back();
+	return v[i] + frac * (v[i + 1] - v[i]);
+}
+
+} // anonymous namespace
+
+double
+RobustStats::mean() const {
+	if (_samples.empty())
+		return 0.0;
+	double sum = 0.0;
+	for (size_t i = 0; i < _samples.size(); ++i)
+		sum += _samples[i];
+	return sum / _samples.size();
+}
+
+double
+RobustStats::median() const {
+	return sortedPercentile(sorted(), 50.0);
+}
+
+double
+RobustStats::percentile(double p) const {
+	return sortedPercentile(sorted(), p);
+}
+
+double
+RobustStats::mad() const {
+	const double m = median();
+	std::vector<double> dev;
+	dev.reserve(_samples.size());
+	for (size_t i = 0; i < _samples.size(); ++i)
+		dev.push_back(std::fabs(_samples[i] - m));
+	std::sort(dev.begin(), dev.end());
+	return sortedPercentile(dev, 50.0);
+}
+
+int
+RobustStats::rejectOutliers(double k) {
+	const double m = median();
+	const double limit = k * 1.4826 * mad();
+	if (limit <= 0.0)
+		return 0;	// Too many identical samples to judge.
+
+	std::vector<double> kept;
+	kept.reserve(_samples.size());
+	for (size_t i = 0; i < _samples.size(); ++i)
+		if (std::fabs(_samples[i] - m) <= limit)
+			kept.push_back(_samples[i]);
+
+	const int rejected = static_cast<int>(_samples.size() - kept.size());
+	_samples.swap(kept);
+	_sortedValid = false;
+	return rejected;
+}
+
+void
+RobustStats::bootstrapCI(double level, double* low, double* high,
+    int resamples) const {
+	const size_t n = _samples.size();
+	if (n < 2 || resamples < 1) {
+		*low = *high = median();
+		return;
+	}
+
+	RandomDouble rand(271828);
+	std::vector<double> medians;
+	std::vector<double> r(n);
+	medians.reserve(resamples);
+	for (int i = 0; i < resamples; ++i) {
+		for (size_t j = 0; j < n; ++j)
+			r[j] = _samples[std::min(n - 1,
+				static_cast<size_t>(rand.next() * n))];
+		std::sort(r.begin(), r.end());
+		medians.push_back(sortedPercentile(r, 50.0));
+	}
+	std::sort(medians.begin(), medians.end());
+
+	const double tail = 50.0 * (1.0 - level);
+	*low  = sortedPercentile(medians, tail);
+	*high = sortedPercentile(medians, 100.0 - tail);
+}
+
+double
+RobustStats::relativeCI() const {
+	const double m = median();
+	if (m == 0.0)
+		return 0.0;
+	double low, high;
+	bootstrapCI(0.95, &low, &high);
+	return std::fabs(high - low) / 2.0 / std::fabs(m);
+}
+
+} // namespace GLEAN
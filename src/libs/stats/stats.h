@@ -31,8 +31,14 @@
 
 // stats.h: simple statistics-gathering utilities for glean
 
-// These are rather simplistic.  For more robust implementations, consider
-// using Numerical Recipes.
+// BasicStats is rather simplistic.  For more robust implementations,
+// consider using Numerical Recipes.
+
+// RobustStats keeps every sample, so it can report order statistics
+// (median, percentiles, median absolute deviation) that aren't thrown
+// off by the occasional outlier, plus bootstrap confidence intervals
+// for the median.  It's intended for benchmark timings, which are
+// rarely normally distributed.
 
 #ifndef __stats_h__
 #define __stats_h__
@@ -86,6 +92,56 @@ class BasicStats {
 	}
 }; // class BasicStats
 
+class RobustStats {
+	std::vector<double> _samples;
+	mutable std::vector<double> _sorted;
+	mutable bool _sortedValid;
+
+	const std::vector<double>& sorted() const;
+    public:
+	void init();
+	inline int n() const {return static_cast<int>(_samples.size());}
+	inline const std::vector<double>& samples() const {return _samples;}
+	inline void sample(double d) {
+		_samples.push_back(d);
+		_sortedValid = false;
+	}
+
+	double mean() const;
+	double median() const;
+	double percentile(double p) const;	// p in [0, 100]
+	double mad() const;	// Median absolute deviation from the median
+
+	// Discard samples more than k robust standard deviations
+	// (1.4826 * MAD) from the median.  Returns the number discarded.
+	int rejectOutliers(double k = 3.0);
+
+	// Percentile bootstrap confidence interval for the median, at
+	// the given confidence level (e.g. 0.95).  The resampling is
+	// seeded with a constant, so results are reproducible.
+	void bootstrapCI(double level, double* low, double* high,
+		int resamples = 1000) const;
+
+	// Half-width of the 95% confidence interval for the median,
+	// relative to the median itself:
+	double relativeCI() const;
+
+	RobustStats() {init();}
+	template<class T> RobustStats(std::vector<T>& v) {
+		init();
+		for (typename std::vector<T>::const_iterator p = v.begin(); p < v.end(); ++p)
+			sample(*p);
+	}
+}; // class RobustStats
+
+// Two measurements differ significantly if their confidence intervals
+// don't overlap.  (This is conservative; it errs toward calling a
+// difference noise.)
+inline bool
+significantlyDifferent(double low1, double high1, double low2, double high2) {
+	return high1 < low2 || high2 < low1;
+}
+
 } // namespace GLEAN
 
 #endif // __stats_h__
@@ -41,16 +41,184 @@
 #include "timer.h"
 #include <vector>
 #include <algorithm>
+#include <cstring>
 using namespace std;
 
 #if defined(__UNIX__)
 #    include <sys/time.h>	// for gettimeofday, used by getClock
+#    include <time.h>		// for clock_gettime, used by getClock
 #elif defined(__MS__)
 #    include <windows.h>
 #    include <sys/types.h>
 #    include <sys/timeb.h>	// for _ftime(), used by getClock
 #endif
 
+#if defined(__GNUC__) && (defined(__i386__) || defined(__x86_64__))
+#    include <cpuid.h>
+#    define HAVE_TSC 1
+#endif
+
+namespace {
+
+///////////////////////////////////////////////////////////////////////////////
+// Clock sources
+///////////////////////////////////////////////////////////////////////////////
+double
+systemClock() {
+#if defined(__MS__)
+	struct _timeb t;
+
+	_ftime(&t);
+
+	return (double) t.time + (double) t.millitm * 1E-3;
+#elif defined(__UNIX__)
+	struct timeval t;
+
+	// XXX gettimeofday is different on SysV, if I remember correctly
+	gettimeofday(&t, 0);
+
+	return (double) t.tv_sec + (double) t.tv_usec * 1E-6;
+#endif
+} // systemClock
+
+double
+monotonicClock() {
+#if defined(__MS__)
+	static int once = 1;
+	static double freq;
+
+	if (once) {
+	    LARGE_INTEGER fr;
+	    freq = (double) (QueryPerformanceFrequency(&fr) ?
+			     1.0 / fr.QuadPart : 0);
+	    once = 0;
+	}
+
+	// Use high-resolution counter, if available
+	if (freq) {
+	    LARGE_INTEGER pc;
+	    QueryPerformanceCounter(&pc);
+	    return freq * (double) pc.QuadPart;
+	} else
+	    return systemClock();
+#elif defined(__UNIX__)
+#   if defined(CLOCK_MONOTONIC_RAW) || defined(CLOCK_MONOTONIC)
+	struct timespec t;
+
+	// CLOCK_MONOTONIC_RAW isn't subject to NTP frequency adjustment,
+	// so intervals are measured in the hardware's own units.
+#	if defined(CLOCK_MONOTONIC_RAW)
+	clock_gettime(CLOCK_MONOTONIC_RAW, &t);
+#	else
+	clock_gettime(CLOCK_MONOTONIC, &t);
+#	endif
+
+	return (double) t.tv_sec + (double) t.tv_nsec * 1E-9;
+#   else
+	return systemClock();
+#   endif
+#endif
+} // monotonicClock
+
+#if defined(HAVE_TSC)
+
+bool haveRDTSCP;		// CPU supports the rdtscp instruction
+unsigned long long tscBase;	// Counter value at calibration...
+double tscBaseTime;		// ...and the monotonic time it matched
+double tscPeriod;		// Seconds per counter increment
+
+inline unsigned long long
+readTSC() {
+	unsigned int lo, hi;
+	if (haveRDTSCP) {
+		// rdtscp waits for earlier instructions to finish, so
+		// the measured work can't leak past the reading.
+		unsigned int aux;
+		__asm__ __volatile__("rdtscp" : "=a"(lo), "=d"(hi), "=c"(aux));
+	} else
+		__asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+	return (static_cast<unsigned long long>(hi) << 32) | lo;
+} // readTSC
+
+// The counter is only usable as a clock if it runs at a constant rate
+// regardless of frequency scaling and sleep states.
+bool
+initTSC() {
+	unsigned int eax, ebx, ecx, edx;
+	if (!__get_cpuid(0x80000007, &eax, &ebx, &ecx, &edx)
+	    || !(edx & (1 << 8)))		// invariant TSC
+		return false;
+	haveRDTSCP = __get_cpuid(0x80000001, &eax, &ebx, &ecx, &edx)
+		&& (edx & (1 << 27));
+
+	// Calibrate against the monotonic clock over 50 ms:
+	double t0 = monotonicClock();
+	unsigned long long c0 = readTSC();
+	double t1;
+	while ((t1 = monotonicClock()) < t0 + 0.05)
+		;
+	unsigned long long c1 = readTSC();
+	if (c1 <= c0)
+		return false;
+
+	tscPeriod = (t1 - t0) / static_cast<double>(c1 - c0);
+	tscBase = c1;
+	tscBaseTime = t1;
+	return true;
+} // initTSC
+
+inline double
+cycleClock() {
+	return tscBaseTime
+		+ static_cast<double>(readTSC() - tscBase) * tscPeriod;
+} // cycleClock
+
+#endif
+
+GLEAN::Timer::ClockSource currentSource = GLEAN::Timer::MonotonicClock;
+double resolution = 0.0;	// Measured properties of currentSource;
+double readOverhead = 0.0;	// zero until measured.
+
+double samplingPrecision = 0.02;	// Target CI half-width for measure()
+double samplingBudget = 3.0;		// ...and the most time it may spend
+
+const char* sourceNames[] = {
+	"system",
+	"monotonic",
+	"tsc"
+};
+
+// Measure the resolution of the current clock, as the smallest nonzero
+// step seen between consecutive readings, and its average cost per
+// reading.
+void
+measureClock() {
+	// Coarse clocks get fewer samples, so this stays quick.
+	const int samples = 1000;
+	double smallest = 0.0;
+	double first = GLEAN::Timer::getClock();
+	for (int i = 0; i < samples; ++i) {
+		double start = GLEAN::Timer::getClock();
+		double next;
+		while ((next = GLEAN::Timer::getClock()) == start)
+			;
+		double step = next - start;
+		if (smallest == 0.0 || step < smallest)
+			smallest = step;
+		if (i >= 2 && next - first > 0.05)
+			break;
+	}
+	resolution = smallest;
+
+	const int reads = 100000;
+	double start = GLEAN::Timer::getClock();
+	for (int i = 0; i < reads; ++i)
+		GLEAN::Timer::getClock();
+	readOverhead = (GLEAN::Timer::getClock() - start) / reads;
+} // measureClock
+
+} // anonymous namespace
+
 namespace GLEAN {
 
 ///////////////////////////////////////////////////////////////////////////////
@@ -86,15 +254,8 @@ Timer::calibrate() {
 ///////////////////////////////////////////////////////////////////////////////
 double
 Timer::chooseRunTime() {
-	double start = getClock();
-	double finish;
-
-	// Wait for next tick:
-	while ((finish = getClock()) == start)
-		;
-	
 	// Run for 10000 ticks, clamped to [0.1 sec, 5.0 sec]:
-	double runTime = 10000.0 * (finish - start);
+	double runTime = 10000.0 * clockResolution();
 	if (runTime < 0.1)
 		runTime = 0.1;
 	else if (runTime > 5.0)
@@ -104,42 +265,89 @@ Timer::chooseRunTime() {
 } // Timer::chooseRunTime
 
 ///////////////////////////////////////////////////////////////////////////////
-// getClock - get current wall-clock time (expressed in seconds)
+// getClock - get current time from the selected clock (expressed in seconds)
 ///////////////////////////////////////////////////////////////////////////////
 double
 Timer::getClock() {
-#if defined(__MS__)
-	static int once = 1;
-	static double freq;
+	switch (currentSource) {
+#if defined(HAVE_TSC)
+	case CycleCounter:
+		return cycleClock();
+#endif
+	case SystemClock:
+		return systemClock();
+	default:
+		return monotonicClock();
+	}
+} // Timer::getClock
 
-	if (once) {
-	    LARGE_INTEGER fr;
-	    freq = (double) (QueryPerformanceFrequency(&fr) ?
-			     1.0 / fr.QuadPart : 0);
-	    once = 0;
+///////////////////////////////////////////////////////////////////////////////
+// Clock selection and properties
+///////////////////////////////////////////////////////////////////////////////
+bool
+Timer::setClockSource(ClockSource s) {
+	if (s == CycleCounter) {
+#if defined(HAVE_TSC)
+		if (!initTSC())
+			return false;
+#else
+		return false;
+#endif
 	}
+	currentSource = s;
+	resolution = readOverhead = 0.0;
+	return true;
+} // Timer::setClockSource
+
+Timer::ClockSource
+Timer::getClockSource() {
+	return currentSource;
+} // Timer::getClockSource
+
+const char*
+Timer::clockSourceName(ClockSource s) {
+	return sourceNames[s];
+} // Timer::clockSourceName
+
+bool
+Timer::clockSourceFromName(const char* name, ClockSource* s) {
+	for (int i = SystemClock; i <= CycleCounter; ++i)
+		if (!strcmp(name, sourceNames[i])) {
+			*s = static_cast<ClockSource>(i);
+			return true;
+		}
+	return false;
+} // Timer::clockSourceFromName
 
-	// Use high-resolution counter, if available
-	if (freq) {
-	    LARGE_INTEGER pc;
-	    QueryPerformanceCounter(&pc);
-	    return freq * (double) pc.QuadPart;
-	} else {
-	    struct _timeb t;
+double
+Timer::clockResolution() {
+	if (resolution == 0.0)
+		measureClock();
+	return resolution;
+} // Timer::clockResolution
 
-	    _ftime(&t);
+double
+Timer::clockOverhead() {
+	if (resolution == 0.0)
+		measureClock();
+	return readOverhead;
+} // Timer::clockOverhead
 
-	    return (double) t.time + (double) t.millitm * 1E-3;
-	}
-#elif defined(__UNIX__)
-	struct timeval t;
+void
+Timer::setSampling(double precision, double budget) {
+	samplingPrecision = precision;
+	samplingBudget = budget;
+} // Timer::setSampling
 
-	// XXX gettimeofday is different on SysV, if I remember correctly
-	gettimeofday(&t, 0);
+double
+Timer::getPrecision() {
+	return samplingPrecision;
+} // Timer::getPrecision
 
-	return (double) t.tv_sec + (double) t.tv_usec * 1E-6;
-#endif
-} // Timer::getClock
+double
+Timer::getBudget() {
+	return samplingBudget;
+} // Timer::getBudget
 
 ///////////////////////////////////////////////////////////////////////////////
 // waitForTick:  wait for beginning of next system clock tick; return the time.
@@ -171,14 +379,18 @@ Timer::time() {
 	// one that's long enough to meet our runtime target:
 	long reps = 1;
 	double start;
+	double submitted;
 	double current;
 	for (;;) {
 		preop();
 
 		start = waitForTick();
+		startBatch();
 
 		for (long i = reps; i > 0; --i) op();
 
+		submitted = getClock();
+		finishBatch();
 
 		postop();
 
@@ -199,6 +411,9 @@ Timer::time() {
 			reps = newReps;
 		}
 
+	submitTime = (submitted - start) / reps;
+	gpuTime = batchTime() / reps;
+
 	// Subtract overhead to determine the final operation rate:
 	return (current - start - overhead) / reps;
 } // Timer::time
@@ -209,24 +424,41 @@ Timer::time() {
 void
 Timer::measure(int count, double* low, double* avg, double* high)
 {
-	vector<double> m;
-	double         sum = 0.0;
+	RobustStats submit;
+	RobustStats gpu;
+	bool        haveGPU = true;
 
 	if (!calibrated) calibrate();
 	if (count < 3) count = 3;
+	stats.init();
 	premeasure();
-	for (int i = 0; i < count; i++) {
+	double start = getClock();
+	for (;;) {
 		preop();
 		double t = time();
 		postop();
-		m.push_back(compute(t));
+		stats.sample(compute(t));
+		submit.sample(compute(submitTime));
+		if (gpuTime > 0.0)
+			gpu.sample(compute(gpuTime));
+		else
+			haveGPU = false;
+
+		if (stats.n() < count)
+			continue;
+		if (getClock() - start >= samplingBudget)
+			break;
+		if (stats.relativeCI() <= samplingPrecision)
+			break;
 	}
 	postmeasure();
-	sort(m.begin(), m.end());
-	for (int j = 1; j < count - 1; j++) sum += m[j];
-	*avg  = sum / (count - 2);
-	*low  = m[1];
-	*high = m[count - 2];
+
+	stats.rejectOutliers();
+	*avg = stats.median();
+	stats.bootstrapCI(0.95, low, high);
+
+	submitAvg = submit.median();
+	gpuAvg = haveGPU? gpu.median(): 0.0;
 } // Timer::measure
 
 } // namespace GLEAN
@@ -32,12 +32,35 @@
 // Timer objects provide a framework for measuring the rate at which an
 // operation can be performed.
 
+// All Timers read the same clock, which may be chosen at runtime with
+// setClockSource().  The default is the system's monotonic clock, which
+// isn't disturbed by changes to the time of day.
+
+// measure() samples repeatedly, until the 95% confidence interval of
+// the median is tight enough or a time budget runs out (see
+// setSampling()), so noisy systems get more samples than quiet ones.
+
 #ifndef __timer_h__
 #define __timer_h__
 
+#include "stats.h"
+
 namespace GLEAN {
 
 class Timer {
+public:
+	enum ClockSource {
+		SystemClock,	// Time of day (gettimeofday() or _ftime()).
+				// Microsecond resolution at best, and
+				// may jump when the clock is adjusted.
+		MonotonicClock,	// clock_gettime(CLOCK_MONOTONIC_RAW), or
+				// QueryPerformanceCounter() on Windows.
+		CycleCounter	// x86 time-stamp counter (rdtscp when
+				// available), calibrated against the
+				// monotonic clock.
+	};
+
+private:
 	double overhead;	// Overhead (in seconds) of initial op,
 				// final op, and timer access.
 
@@ -56,17 +79,62 @@ public:
 		// modify measure()'s result -- e.g., by computing a rate
 		return t;
 	}
+
+	// Hooks for timing the same batch of ops on a second clock (for
+	// example, GPU timer queries).  startBatch() and finishBatch()
+	// bracket the ops in each loop in time(); batchTime() returns the
+	// elapsed time (in seconds) of the most recent batch, or zero if
+	// no such clock is available.
+	virtual void   startBatch() {};
+	virtual void   finishBatch() {};
+	virtual double batchTime() { return 0.0; }
+
+	// Side-by-side results of the last time() call, per op:
+	double submitTime;	// CPU time to issue the ops, excluding postop()
+	double gpuTime;		// batchTime() share, or zero
+
+	// ...and of the last measure() call, passed through compute():
+	RobustStats stats;	// measure()'s samples, outliers removed
+	double submitAvg;	// median
+	double gpuAvg;		// median; zero if batchTime() isn't available
 	
 	void         calibrate();
 	double       time();
-	double       getClock();    // Get wall-clock time, in seconds
+	static double getClock();   // Get current time, in seconds
 	double       waitForTick(); // Wait for next clock tick; return time
 	void         measure(int count,
 			     double* low, double* avg, double* high);
+				// Takes at least count samples.  Returns
+				// the median of compute()'s results in
+				// *avg, and its 95% confidence interval in
+				// *low and *high.
 	
-	Timer() { overhead = 0.0; calibrated = false; }
+	Timer() {
+		overhead = 0.0; calibrated = false;
+		submitTime = gpuTime = submitAvg = gpuAvg = 0.0;
+	}
         virtual ~Timer() { /* just silence warning */ }
 
+	// Clock selection:
+	static bool        setClockSource(ClockSource s);
+				// Returns false, and keeps the current
+				// source, if s isn't usable here.
+	static ClockSource getClockSource();
+	static const char* clockSourceName(ClockSource s);
+	static bool        clockSourceFromName(const char* name,
+					       ClockSource* s);
+	static double      clockResolution(); // Smallest observed step
+					      // of the clock, in seconds.
+	static double      clockOverhead();   // Cost of one getClock(),
+					      // in seconds.
+
+	// Sampling limits for measure():  stop when the half-width of
+	// the confidence interval falls below precision (relative to the
+	// median), or after budget seconds, whichever comes first.
+	static void   setSampling(double precision, double budget);
+	static double getPrecision();
+	static double getBudget();
+
 }; // class Timer
 
 } // namespace GLEAN
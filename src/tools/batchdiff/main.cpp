@@ -0,0 +1,414 @@
+// BEGIN_COPYRIGHT
+// 
+// Copyright (C) 1999  Allen Akin   All Rights Reserved.
+// 
+// Permission is hereby granted, free of charge, to any person
+// obtaining a copy of this software and associated documentation
+// files (the "Software"), to deal in the Software without
+// restriction, including without limitation the rights to use,
+// copy, modify, merge, publish, distribute, sublicense, and/or
+// sell copies of the Software, and to permit persons to whom the
+// Software is furnished to do so, subject to the following
+// conditions:
+// 
+// The above copyright notice and this permission notice shall be
+// included in all copies or substantial portions of the
+// Software.
+// 
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY
+// KIND, EXPRESS OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE
+// WARRANTIES OF MERCHANTABILITY, FITNESS FOR A PARTICULAR
+// PURPOSE AND NONINFRINGEMENT.  IN NO EVENT SHALL ALLEN AKIN BE
+// LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN
+// AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF
+// OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER
+// DEALINGS IN THE SOFTWARE.
+// 
+// END_COPYRIGHT
+
+
+
+
+// batchdiff:  compare all the images in two glean results databases,
+// without a display.  Images are paired by name (test/iNNN.tif, as
+// Environment::imageFileName() writes them), compared several at a time,
+// and summarized for each image that differs:  how many pixels, by how
+// much, PSNR and SSIM, and where (see Image::compare()).  The exit status
+// is 0 if every image matches, 1 if any differ or are missing, and 2 if
+// the databases can't be read; so it's easy to use in automatic builds.
+
+#include <ctype.h>
+#include <stdlib.h>
+#include <string.h>
+#include <algorithm>
+#include <iostream>
+#include <set>
+#include <string>
+#include <vector>
+#include "image.h"
+
+#if defined(__UNIX__)
+#include <dirent.h>
+#include <errno.h>
+#include <pthread.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#elif defined(__MS__)
+#include <windows.h>
+#endif
+
+using namespace std;
+using namespace GLEAN;
+
+
+namespace {
+
+enum Outcome {
+	same,
+	different,
+	missingOld,
+	missingNew,
+	sizeMismatch,
+	unreadable
+};
+
+struct Comparison {
+	string name;		// test/iNNN.tif
+	Outcome outcome;
+	Image::Difference diff;
+	GLsizei pixels;		// total pixels in each image
+	Image::Comparison metrics;	// only for images that differ
+};
+
+struct Work {
+	string oldDB;
+	string newDB;
+	string maskDB;		// empty if no masks are wanted
+	double threshold;
+	vector<Comparison> comparisons;
+	size_t next;		// Next comparison to make
+#if defined(__UNIX__)
+	pthread_mutex_t lock;
+#endif
+};
+
+///////////////////////////////////////////////////////////////////////////////
+// listDirectory:  names of the entries in a directory, sorted; "." and ".."
+//	are left out.  Returns false if the directory can't be read.
+///////////////////////////////////////////////////////////////////////////////
+bool
+listDirectory(const string& dirName, vector<string>& names) {
+	names.clear();
+#if defined(__UNIX__)
+	DIR* dir = opendir(dirName.c_str());
+	if (!dir)
+		return false;
+	while (dirent* e = readdir(dir))
+		if (strcmp(e->d_name, ".") && strcmp(e->d_name, ".."))
+			names.push_back(e->d_name);
+	closedir(dir);
+#elif defined(__MS__)
+	WIN32_FIND_DATA data;
+	HANDLE h = FindFirstFile((dirName + "\\*").c_str(), &data);
+	if (h == INVALID_HANDLE_VALUE)
+		return false;
+	do {
+		if (strcmp(data.cFileName, ".") && strcmp(data.cFileName, ".."))
+			names.push_back(data.cFileName);
+	} while (FindNextFile(h, &data));
+	FindClose(h);
+#endif
+	sort(names.begin(), names.end());
+	return true;
+} // listDirectory
+
+///////////////////////////////////////////////////////////////////////////////
+// makeDirectory:  create a directory if it doesn't already exist
+///////////////////////////////////////////////////////////////////////////////
+bool
+makeDirectory(const string& dirName) {
+#if defined(__UNIX__)
+	return !mkdir(dirName.c_str(), 0755) || errno == EEXIST;
+#elif defined(__MS__)
+	return CreateDirectory(dirName.c_str(), 0)
+	    || GetLastError() == ERROR_ALREADY_EXISTS;
+#endif
+} // makeDirectory
+
+///////////////////////////////////////////////////////////////////////////////
+// isImageName:  true for names of the form iNNN.tif
+///////////////////////////////////////////////////////////////////////////////
+bool
+isImageName(const string& name) {
+	return name.size() == 8 && name[0] == 'i'
+	    && isdigit(name[1]) && isdigit(name[2]) && isdigit(name[3])
+	    && name.compare(4, 4, ".tif") == 0;
+} // isImageName
+
+///////////////////////////////////////////////////////////////////////////////
+// listImages:  add test/iNNN.tif for every image in a results database
+///////////////////////////////////////////////////////////////////////////////
+bool
+listImages(const string& dbName, set<string>& images) {
+	vector<string> tests;
+	if (!listDirectory(dbName, tests))
+		return false;
+	vector<string> files;
+	for (size_t i = 0; i < tests.size(); ++i)
+		if (listDirectory(dbName + '/' + tests[i], files))
+			for (size_t j = 0; j < files.size(); ++j)
+				if (isImageName(files[j]))
+					images.insert(tests[i] + '/'
+						+ files[j]);
+	return true;
+} // listImages
+
+///////////////////////////////////////////////////////////////////////////////
+// compare:  compare one pair of images, writing the mask if wanted
+///////////////////////////////////////////////////////////////////////////////
+void
+compare(Work& w, Comparison& c) {
+	Image oldImage;
+	Image newImage;
+	try {
+		oldImage.mapTIFF(w.oldDB + '/' + c.name);
+		newImage.mapTIFF(w.newDB + '/' + c.name);
+	}
+	catch (Image::Error) {
+		c.outcome = unreadable;
+		return;
+	}
+
+	Image mask;
+	try {
+		c.diff = oldImage.diff(newImage, w.threshold,
+			w.maskDB.empty()? 0: &mask);
+	}
+	catch (Image::SizeMismatch) {
+		c.outcome = sizeMismatch;
+		return;
+	}
+	c.pixels = oldImage.width() * oldImage.height();
+	c.outcome = c.diff.pixels? different: same;
+	if (c.outcome == different)
+		c.metrics = oldImage.compare(newImage, w.threshold);
+
+	if (c.outcome == different && !w.maskDB.empty()) {
+		string test(c.name, 0, c.name.find('/'));
+		makeDirectory(w.maskDB + '/' + test);
+		try {
+			mask.writeTIFF(w.maskDB + '/' + c.name);
+		}
+		catch (Image::Error) {
+			cerr << "can't write mask for " << c.name << '\n';
+		}
+	}
+} // compare
+
+bool
+takeComparison(Work& w, size_t& i) {
+#if defined(__UNIX__)
+	pthread_mutex_lock(&w.lock);
+#endif
+	i = w.next++;
+#if defined(__UNIX__)
+	pthread_mutex_unlock(&w.lock);
+#endif
+	return i < w.comparisons.size();
+} // takeComparison
+
+///////////////////////////////////////////////////////////////////////////////
+// compareImages:  body of a comparison thread
+///////////////////////////////////////////////////////////////////////////////
+void*
+compareImages(void* arg) {
+	Work& w = *static_cast<Work*>(arg);
+	size_t i;
+	while (takeComparison(w, i))
+		if (w.comparisons[i].outcome == same)
+			compare(w, w.comparisons[i]);
+	return 0;
+} // compareImages
+
+///////////////////////////////////////////////////////////////////////////////
+// report:  one line per image that differs (every image, if verbose), then
+//	the totals.  Returns the number of images that didn't match.
+///////////////////////////////////////////////////////////////////////////////
+int
+report(ostream& out, const Work& w, bool verbose) {
+	int counts[unreadable + 1] = {0};
+	for (size_t i = 0; i < w.comparisons.size(); ++i) {
+		const Comparison& c = w.comparisons[i];
+		++counts[c.outcome];
+		switch (c.outcome) {
+		case same:
+			if (verbose)
+				out << c.name << ": same\n";
+			break;
+		case different:
+			out << c.name << ": " << c.diff.pixels << " of "
+			    << c.pixels << " pixels differ; max error R "
+			    << c.diff.maxError[0] << " G "
+			    << c.diff.maxError[1] << " B "
+			    << c.diff.maxError[2] << " A "
+			    << c.diff.maxError[3] << '\n';
+			out << "\tPSNR " << c.metrics.psnr << " dB, SSIM "
+			    << c.metrics.ssim << ", "
+			    << c.metrics.regions.size() << " region(s)";
+			if (!c.metrics.regions.empty()) {
+				const Image::Region& r = c.metrics.regions[0];
+				out << ", largest " << r.pixels << " pixels in "
+				    << r.width << 'x' << r.height << " at ("
+				    << r.x << ", " << r.y << ')';
+			}
+			out << '\n';
+			break;
+		case missingOld:
+			out << c.name << ": missing from " << w.oldDB << '\n';
+			break;
+		case missingNew:
+			out << c.name << ": missing from " << w.newDB << '\n';
+			break;
+		case sizeMismatch:
+			out << c.name << ": sizes differ\n";
+			break;
+		case unreadable:
+			out << c.name << ": can't read\n";
+			break;
+		}
+	}
+
+	int failures = static_cast<int>(w.comparisons.size()) - counts[same];
+	out << w.comparisons.size() << " images compared: "
+	    << counts[same] << " same, "
+	    << counts[different] << " different, "
+	    << counts[missingOld] + counts[missingNew] << " missing, "
+	    << counts[sizeMismatch] + counts[unreadable] << " unusable\n";
+	return failures;
+} // report
+
+void
+usage(char* command) {
+	cerr << "Usage:  " << command
+	     << " [options] old-results-dir new-results-dir\n"
+"\n"
+"options:\n"
+"       (-v|--verbose)             # list matching images, too\n"
+"       --threshold T              # ignore differences of T or less in\n"
+"                                  # any component, on a 0-1 scale\n"
+"                                  # (default 0)\n"
+"       --masks dir                # for each image that differs, write\n"
+"                                  # dir/test/iNNN.tif, white where\n"
+"                                  # the pixels differ\n"
+#if defined(__UNIX__)
+"       (-j|--jobs) N              # compare N images at once (default:\n"
+"                                  # one per processor)\n"
+#endif
+"       --help                     # this message\n";
+	exit(2);
+} // usage
+
+char*
+mandatoryArg(int argc, char* argv[], int i) {
+	if (i < argc && argv[i][0] != '-')
+		return argv[i];
+	usage(argv[0]);
+	/*NOTREACHED*/
+	return 0;
+} // mandatoryArg
+
+} // anonymous namespace
+
+
+int
+main(int argc, char* argv[]) {
+	Work w;
+	w.threshold = 0.0;
+	w.next = 0;
+	bool verbose = false;
+	int jobs = 1;
+#if defined(__UNIX__)
+	jobs = static_cast<int>(sysconf(_SC_NPROCESSORS_ONLN));
+#endif
+	vector<string> dbs;
+
+	for (int i = 1; i < argc; ++i) {
+		if (!strcmp(argv[i], "--help")) {
+			usage(argv[0]);
+		} else if (!strcmp(argv[i], "-v")
+		    || !strcmp(argv[i], "--verbose")) {
+			verbose = true;
+		} else if (!strcmp(argv[i], "--threshold")) {
+			++i;
+			w.threshold = atof(mandatoryArg(argc, argv, i));
+			if (w.threshold < 0.0)
+				usage(argv[0]);
+		} else if (!strcmp(argv[i], "--masks")) {
+			++i;
+			w.maskDB = mandatoryArg(argc, argv, i);
+#if defined(__UNIX__)
+		} else if (!strcmp(argv[i], "-j")
+		    || !strcmp(argv[i], "--jobs")) {
+			++i;
+			jobs = atoi(mandatoryArg(argc, argv, i));
+			if (jobs < 1)
+				usage(argv[0]);
+#endif
+		} else if (argv[i][0] == '-') {
+			usage(argv[0]);
+		} else
+			dbs.push_back(argv[i]);
+	}
+	if (dbs.size() != 2)
+		usage(argv[0]);
+	w.oldDB = dbs[0];
+	w.newDB = dbs[1];
+
+	// Pair the images by name.  Those found on only one side are
+	// reported without being opened:
+	set<string> oldImages;
+	set<string> newImages;
+	if (!listImages(w.oldDB, oldImages)) {
+		cerr << "can't read " << w.oldDB << '\n';
+		return 2;
+	}
+	if (!listImages(w.newDB, newImages)) {
+		cerr << "can't read " << w.newDB << '\n';
+		return 2;
+	}
+	set<string> all(oldImages);
+	all.insert(newImages.begin(), newImages.end());
+	for (set<string>::iterator p = all.begin(); p != all.end(); ++p) {
+		Comparison c;
+		c.name = *p;
+		c.outcome = !oldImages.count(*p)? missingOld:
+			    !newImages.count(*p)? missingNew: same;
+		c.pixels = 0;
+		w.comparisons.push_back(c);
+	}
+
+	if (!w.maskDB.empty() && !makeDirectory(w.maskDB)) {
+		cerr << "can't create " << w.maskDB << '\n';
+		return 2;
+	}
+
+	// Compare them, several at a time:
+#if defined(__UNIX__)
+	pthread_mutex_init(&w.lock, 0);
+	size_t n = min(static_cast<size_t>(jobs), w.comparisons.size());
+	vector<pthread_t> ids(n);
+	vector<bool> started(n, false);
+	for (size_t i = 1; i < n; ++i)
+		started[i] = pthread_create(&ids[i], 0, compareImages, &w) == 0;
+	compareImages(&w);	// The main thread does its share, too.
+	for (size_t i = 1; i < n; ++i)
+		if (started[i])
+			pthread_join(ids[i], 0);
+	pthread_mutex_destroy(&w.lock);
+#else
+	compareImages(&w);
+#endif
+
+	return report(cout, w, verbose)? 1: 0;
+} // main
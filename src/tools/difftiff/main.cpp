@@ -38,6 +38,7 @@
 #endif
 #include <cassert>
 #include <cmath>		// for fabs
+#include <vector>
 #include "image.h"
 
 using namespace std;
@@ -96,18 +97,18 @@ unsigned char DiffColor[] = {255, 0, 255, 255};
 ///////////////////////////////////////////////////////////////////////////////
 void
 ComputeDifference() {
-	double* rgba1 = new double[4 * Image1.width()];
+	vector<double> rgba1(4 * Image1.width() + 4);
 	char* row1 = Image1.pixels();
-	double* rgba2 = new double[4 * Image2.width()];
+	vector<double> rgba2(4 * Image2.width() + 4);
 	char* row2 = Image2.pixels();
 	unsigned char* rowD = reinterpret_cast<unsigned char*>(Diff.pixels());
 
 	for (GLsizei i = 0; i < Diff.height(); ++i) {
-		Image1.unpack(Image1.width(), rgba1, row1);
-		Image2.unpack(Image2.width(), rgba2, row2);
+		Image1.unpack(Image1.width(), &rgba1[0], row1);
+		Image2.unpack(Image2.width(), &rgba2[0], row2);
 
-		double* p1 = rgba1;
-		double* p2 = rgba2;
+		double* p1 = &rgba1[0];
+		double* p2 = &rgba2[0];
 		unsigned char* pD = rowD;
 
 		for (GLsizei j = 0; j < Diff.width(); ++j) {
@@ -132,9 +133,6 @@ ComputeDifference() {
 		row2 += Image2.rowSizeInBytes();
 		rowD += Diff.rowSizeInBytes();
 	}
-
-	delete[] rgba1;
-	delete[] rgba2;
 }
 
 ///////////////////////////////////////////////////////////////////////////////